@@ -0,0 +1,235 @@
+#include "Stdafx.h"
+#include "BallisticDeposition.h"
+
+namespace {
+	// number of particles whose columns are drawn and fetched from memory ahead of their deposition
+	constexpr std::size_t lookahead = 32U;
+}
+
+template<std::size_t N>
+constexpr std::size_t BallisticDeposition<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t BallisticDeposition<N>::no_index;
+
+template<std::size_t N>
+BallisticDeposition<N>::BallisticDeposition(std::size_t _substrate_size, const double& _coeff_stick, std::uint64_t _seed)
+	: DLAContainer(lattice_type::SQUARE, (N == 2U) ? attractor_type::LINE : attractor_type::PLANE, _substrate_size, _coeff_stick, _seed) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	initialise_attractor_structure();
+}
+
+template<std::size_t N>
+std::size_t BallisticDeposition<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename BallisticDeposition<N>::aggregate_buffer_vector& BallisticDeposition<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+std::size_t BallisticDeposition<N>::column_count() const noexcept {
+	return columns;
+}
+
+template<std::size_t N>
+const std::vector<int>& BallisticDeposition<N>::column_heights(bool below) const noexcept {
+	return heights[below ? 1U : 0U];
+}
+
+template<std::size_t N>
+double BallisticDeposition<N>::surface_width(bool below) const noexcept {
+	const std::vector<int>& h = heights[below ? 1U : 0U];
+	if (h.empty()) return 0.0;
+	double mean = 0.0;
+	for (int x : h) mean += x;
+	mean /= h.size();
+	double variance = 0.0;
+	for (int x : h) variance += (x - mean)*(x - mean);
+	return std::sqrt(variance / h.size());
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::set_lattice_type(lattice_type ltt) {
+	if (ltt != lattice_type::SQUARE) throw std::invalid_argument("BallisticDeposition is defined on the square lattice only.");
+	DLAContainer::set_lattice_type(ltt);
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	if (attr != ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE))
+		throw std::invalid_argument("attractor type of BallisticDeposition must be LINE in 2D and PLANE in 3D.");
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::set_periodic_boundaries(bool _periodic) {
+	if (_periodic) throw std::invalid_argument("BallisticDeposition does not support periodic boundaries.");
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::initialise_attractor_structure() {
+	is_attractor_initialised = true;
+	// the substrate spans [-att_size/2, +att_size/2) along each of its axes as for DLA<N>
+	width = 2U*(attractor_size / 2U);
+	columns = (N == 2U) ? width : width*width;
+	for (std::size_t side = 0U; side < 2U; ++side) {
+		heights[side].clear();
+		heights[side].shrink_to_fit();
+		tops[side].clear();
+		tops[side].shrink_to_fit();
+	}
+	if (is_spawn_source_above) prepare_side(0U);
+	if (is_spawn_source_below) prepare_side(1U);
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	max_height = 0U;
+	if (!reuse_storage) buffer.shrink_to_fit();
+	// empty the columns, retaining their storage
+	for (std::size_t side = 0U; side < 2U; ++side) {
+		std::fill(heights[side].begin(), heights[side].end(), 0);
+		std::fill(tops[side].begin(), tops[side].end(), no_index);
+	}
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	if (is_spawn_source_above) prepare_side(0U);
+	if (is_spawn_source_below) prepare_side(1U);
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		buffer.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	if (recorder.active()) recorder.start_clock();
+	// a draw over the columns of the sides with spawn sources, the side above first
+	const std::size_t first_side = is_spawn_source_above ? 0U : 1U;
+	const std::size_t range = (is_spawn_source_above && is_spawn_source_below) ? 2U*columns : columns;
+	std::array<double, lookahead> draws;
+	while (columns > 0U && (size() < n || continuous.is_raised())) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		// draw no more numbers than particles required, such that staged growth equals growth at once
+		const std::size_t block = (size() < n) ? std::min(lookahead, n - size()) : lookahead;
+		for (std::size_t k = 0U; k < block; ++k) {
+			draws[k] = pr_gen();
+			std::size_t c = std::min(static_cast<std::size_t>(draws[k]*range), range - 1U);
+			std::size_t side = first_side;
+			if (c >= columns) {
+				c -= columns;
+				side = 1U;
+			}
+			utl::prefetch(heights[side].data() + c);
+			if (N == 3U) {
+				utl::prefetch(heights[side].data() + ((c >= width) ? c - width : c));
+				utl::prefetch(heights[side].data() + ((c + width < columns) ? c + width : c));
+			}
+			if (track_parents) utl::prefetch(tops[side].data() + c);
+		}
+		for (std::size_t k = 0U; k < block; ++k) deposit(draws[k], range, first_side);
+	}
+	if (recorder.active()) recorder.stop_clock();
+}
+
+template<std::size_t N>
+double BallisticDeposition<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	return utl::estimate_fractal_dimension(size(), static_cast<double>(max_height), attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& BallisticDeposition<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::prepare_side(std::size_t side) {
+	if (heights[side].size() == columns && (!track_parents || tops[side].size() == columns)) return;
+	heights[side].assign(columns, 0);
+	if (track_parents) tops[side].assign(columns, no_index);
+	const int half = static_cast<int>(width / 2U);
+	for (std::size_t i = 0U; i < buffer.size(); ++i) {
+		const std::array<int, N> s = utl::coordinates_of(buffer[i]);
+		const int level = (side == 0U) ? s[N - 1U] : -s[N - 1U];
+		if (level <= 0) continue;
+		// particles beyond a substrate resized since their deposition rest on no column
+		std::size_t c = 0U;
+		bool is_on_substrate = true;
+		for (std::size_t j = N - 1U; j-- > 0U;) {
+			is_on_substrate = is_on_substrate && s[j] >= -half && s[j] < half;
+			c = c*width + static_cast<std::size_t>(s[j] + half);
+		}
+		if (!is_on_substrate || level <= heights[side][c]) continue;
+		heights[side][c] = level;
+		if (track_parents) tops[side][c] = static_cast<std::uint32_t>(i);
+	}
+}
+
+template<std::size_t N>
+void BallisticDeposition<N>::deposit(double draw, std::size_t range, std::size_t first_side) {
+	// the integer part of the scaled draw is the column, its fraction the sticking of the particle
+	const double scaled = draw*range;
+	std::size_t c = std::min(static_cast<std::size_t>(scaled), range - 1U);
+	const double stick = scaled - static_cast<double>(c);
+	std::size_t side = first_side;
+	if (c >= columns) {
+		c -= columns;
+		side = 1U;
+	}
+	int* h = heights[side].data();
+	// the particle sticks beside the highest neighbouring column above its own, else on top of its own
+	int level = h[c] + 1;
+	std::size_t contact = c;
+	std::array<int, N> site;
+	std::size_t axis_stride = 1U;
+	std::size_t rest = c;
+	for (std::size_t i = 0U; i + 1U < N; ++i) {
+		const std::size_t x = rest % width;
+		rest /= width;
+		site[i] = static_cast<int>(x) - static_cast<int>(width / 2U);
+		if (x > 0U && h[c - axis_stride] > level) {
+			level = h[c - axis_stride];
+			contact = c - axis_stride;
+		}
+		if (x + 1U < width && h[c + axis_stride] > level) {
+			level = h[c + axis_stride];
+			contact = c + axis_stride;
+		}
+		axis_stride *= width;
+	}
+	// particle did not stick beside a neighbouring column, falling onto its own column
+	if (contact != c && stick > coeff_stick) {
+		++aggregate_misses_;
+		level = h[c] + 1;
+		contact = c;
+	}
+	site[N - 1U] = (side == 0U) ? level : -level;
+	h[c] = level;
+	if (track_parents) {
+		const std::uint32_t parent = tops[side][contact];
+		parents.push_back((parent == no_index) ? utl::no_parent : parent);
+		tops[side][c] = static_cast<std::uint32_t>(buffer.size());
+	}
+	const particle_type p = utl::make_lattice_point<N>(site);
+	buffer.push_back(p);
+	++occupied_sites;
+	max_height = std::max(max_height, static_cast<std::size_t>(level));
+	aggregate_span = max_height;
+	if (recorder.active()) {
+		recorder.accumulate(p);
+		if (recorder.due(buffer.size())) recorder.record(buffer.size(), static_cast<double>(max_height), aggregate_misses_, walk_steps);
+	}
+}
+
+template class BallisticDeposition<2U>;
+template class BallisticDeposition<3U>;
@@ -0,0 +1,174 @@
+#pragma once
+#include "DLAContainer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * \class BallisticDeposition
+ *
+ * \brief Defines a deposit grown by ballistic deposition onto the substrate of an `N`-dimensional square
+ *        lattice, i.e. a LINE attractor in 2D or a PLANE attractor in 3D.
+ *
+ * Each new particle falls straight along the last axis onto a column of the substrate chosen uniformly at
+ * random, from above or below for the respective spawn sources, and sticks at the first site at which it
+ * neighbours the deposit: on top of its own column, or beside the top of a higher neighbouring column.
+ * A particle passing a higher neighbouring column fails to stick there with probability 1 - `coeff_stick`,
+ * counting a miss, and falls onto its own column instead, interpolating between ballistic (`coeff_stick` = 1)
+ * and random deposition. Columns at the ends of the substrate have no neighbours beyond it.
+ *
+ * The deposit is held as the height of each column on either side of the substrate, and the generation
+ * index of the particle on top of each column if parent tracking is enabled, such that every particle costs
+ * O(1) and a single random number, its integer part drawing the column and its fraction the sticking. The
+ * columns of a block of particles are drawn ahead and their heights fetched from memory before the
+ * particles fall, such that the memory latency of substrates far exceeding the processor caches, e.g. of
+ * 10^8 columns, is overlapped with the deposition. The heights of a side are allocated only once it has a
+ * spawn source.
+ *
+ * Parent tracking, growth recording and output behave as for the lattice aggregates, the spanning distance
+ * being the largest height of the deposit. The aggregate cache is not consulted and no random walk steps
+ * are taken.
+ *
+ * Instantiated for N = 2 and 3 in BallisticDeposition.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class BallisticDeposition : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of BallisticDeposition must be 2 or 3.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::vector<particle_type> aggregate_buffer_vector;
+public:
+	/**
+	 * \brief Initialises empty deposit on a substrate of given size, a LINE attractor in 2D or a PLANE
+	 *        attractor in 3D.
+	 *
+	 * \param _substrate_size Number of columns along each axis of the substrate.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
+	 */
+	explicit BallisticDeposition(std::size_t _substrate_size, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~BallisticDeposition() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the deposit, storing the
+	 *        particles of the deposit in the order in which they were added.
+	 *
+	 * \return const reference to buffer of deposit.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the number of columns of the substrate.
+	 */
+	std::size_t column_count() const noexcept;
+	/**
+	 * \brief Gets the height of each column of one side of the substrate, the column of co-ordinates
+	 *        (x, y) of a PLANE being at index (x + L/2) + (y + L/2)*L for a substrate of L columns along
+	 *        each axis.
+	 *
+	 * \param below [= false] Flag to get the depths of the columns below rather than the heights above.
+	 * \return const reference to heights, empty if the side has never had a spawn source.
+	 */
+	const std::vector<int>& column_heights(bool below = false) const noexcept;
+	/**
+	 * \brief Computes the interface width of one side of the deposit, the standard deviation of the
+	 *        heights of its columns.
+	 *
+	 * \param below [= false] Flag to measure the side below rather than above.
+	 */
+	double surface_width(bool below = false) const noexcept;
+	/**
+	 * \brief Deposition is defined on the square lattice only.
+	 *
+	 * \throw Throws std::invalid_argument exception if ltt is not lattice_type::SQUARE.
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is not LINE in 2D or PLANE in 3D.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \brief Deposition is defined on a substrate with open ends only, the columns at its ends having
+	 *        no neighbours beyond them.
+	 *
+	 * \throw Throws std::invalid_argument exception if _periodic is true.
+	 */
+	void set_periodic_boundaries(bool _periodic) override;
+	/**
+	 * \copydoc DLAContainer::initialise_attractor_structure()
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Deposits particles until the deposit consists of the parameterised number of particles,
+	 *        continuing from any existing deposit.
+	 *
+	 * \param n Total number of particles in the deposit after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the deposit particles to an output stream. Without sorting each line is
+	 *        prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// generation index of the top of an empty column
+	static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+	// particles of the deposit in order of generation
+	aggregate_buffer_vector buffer;
+	// number of columns along each axis of the substrate, and in total
+	std::size_t width = 0U;
+	std::size_t columns = 0U;
+	// height of each column above and below the substrate, and the generation index of the particle on top of it
+	std::array<std::vector<int>, 2U> heights;
+	std::array<std::vector<std::uint32_t>, 2U> tops;
+	// largest height of any column
+	std::size_t max_height = 0U;
+	/**
+	 * \brief Allocates the heights of a side of the substrate, and its tops if parent tracking is enabled,
+	 *        placing the particles of the deposit on that side.
+	 *
+	 * \param side Side of the substrate, 0 above and 1 below.
+	 */
+	void prepare_side(std::size_t side);
+	/**
+	 * \brief Deposits a particle.
+	 *
+	 * \param draw Random number in [0,1] drawing the column, side and sticking of the particle.
+	 * \param range Number of columns of the sides with spawn sources.
+	 * \param first_side Side of the first column of the range.
+	 */
+	void deposit(double draw, std::size_t range, std::size_t first_side);
+};
+
+typedef BallisticDeposition<2U> BallisticDeposition_2d;
+typedef BallisticDeposition<3U> BallisticDeposition_3d;
+
+extern template class BallisticDeposition<2U>;
+extern template class BallisticDeposition<3U>;
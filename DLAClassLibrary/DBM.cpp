@@ -0,0 +1,757 @@
+#include "Stdafx.h"
+#include "DBM.h"
+#include "worker_pool.h"
+#include <thread>
+
+namespace {
+	// smallest side of the box, and distance kept between the aggregate and the faces of the box
+	constexpr std::size_t min_box_side = 32U;
+	constexpr int box_margin = 8;
+	// largest side of the coarsest level of the multigrid hierarchy
+	constexpr std::size_t max_coarsest_side = 15U;
+	// Gauss-Seidel sweeps before and after the coarse grid correction of a V-cycle
+	constexpr std::size_t pre_sweeps = 2U;
+	constexpr std::size_t post_sweeps = 2U;
+	// V-cycles of a solve over the whole box, which stop once the residual falls below the tolerance: few
+	// for a solve warm-started from the last field, many after the box is built anew
+	constexpr std::size_t warm_cycles = 2U;
+	constexpr std::size_t max_cycles = 30U;
+	constexpr double residual_tolerance = 1e-7;
+	// the whole field is solved again once the aggregate has grown by this fraction of its size
+	constexpr std::size_t min_solve_interval = 8U;
+	constexpr std::size_t solve_fraction = 16U;
+	// half-width of the window relaxed after each attachment, and number of its sweeps
+	constexpr int local_radius(std::size_t n) { return (n == 2U) ? 8 : 4; }
+	constexpr std::size_t local_sweeps = 4U;
+	// number of node updates below which a sweep is not split across threads
+	constexpr std::size_t min_parallel_work = 1U << 15;
+
+	// number of ranges into which work over `count` items is split
+	std::size_t chunk_count(std::size_t count, std::size_t work, std::size_t threads) noexcept {
+		return std::max<std::size_t>(1U, std::min(std::min(threads, count), work / min_parallel_work));
+	}
+	// sum of the first i weights of a Fenwick tree, node j (from one) being stored at tree[j - 1]
+	double prefix_weight(const std::vector<double>& tree, std::size_t i) noexcept {
+		double sum = 0.0;
+		for (; i > 0U; i &= i - 1U) sum += tree[i - 1U];
+		return sum;
+	}
+}
+
+template<std::size_t N>
+constexpr std::size_t DBM<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t DBM<N>::no_index;
+
+template<std::size_t N>
+DBM<N>::DBM(double _eta, const double& _coeff_stick, std::uint64_t _seed) : DLAContainer(_coeff_stick, _seed) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	set_eta(_eta);
+	set_thread_count(0U);
+}
+
+template<std::size_t N>
+DBM<N>::DBM(attractor_type att, std::size_t att_size, double _eta, const double& _coeff_stick, std::uint64_t _seed)
+	: DLAContainer(lattice_type::SQUARE, att, att_size, _coeff_stick, _seed) {
+	if (N == 2U && att == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DBM to PLANE.");
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	set_eta(_eta);
+	set_thread_count(0U);
+	initialise_attractor_structure();
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename DBM<N>::aggregate_buffer_vector& DBM<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+double DBM<N>::get_eta() const noexcept {
+	return eta;
+}
+
+template<std::size_t N>
+void DBM<N>::set_eta(double _eta) {
+	if (!(_eta >= 0.0)) throw std::invalid_argument("eta must be non-negative.");
+	eta = _eta;
+	// weights of the old exponent are recomputed by the next solve
+	is_field_solved = false;
+}
+
+template<std::size_t N>
+void DBM<N>::set_thread_count(std::size_t _threads) {
+	threads = _threads ? _threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::thread_count() const noexcept {
+	return threads;
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::box_length() const noexcept {
+	return levels.empty() ? 0U : levels.front().side;
+}
+
+template<std::size_t N>
+double DBM<N>::potential(const particle_type& p) const noexcept {
+	if (levels.empty()) return 1.0;
+	const site_type s = utl::coordinates_of(p);
+	const int half = static_cast<int>(levels.front().side / 2U);
+	for (std::size_t i = 0U; i < N; ++i) if (std::abs(s[i]) > half) return 1.0;
+	return levels.front().u[node_of(s)];
+}
+
+template<std::size_t N>
+void DBM<N>::set_lattice_type(lattice_type ltt) {
+	if (ltt != lattice_type::SQUARE) throw std::invalid_argument("DBM is defined on the square lattice only.");
+	DLAContainer::set_lattice_type(ltt);
+}
+
+template<std::size_t N>
+void DBM<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	if (N == 2U && attr == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DBM to PLANE.");
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void DBM<N>::initialise_attractor_structure() {
+	is_attractor_initialised = true;
+	attractor_sites = utl::attractor_sites<N>(attractor, attractor_size, *lattice_geometry);
+	extent = 0;
+	for (const auto& s : attractor_sites)
+		for (int x : s) extent = std::max(extent, std::abs(x));
+	for (const auto& q : buffer)
+		for (int x : utl::coordinates_of(q)) extent = std::max(extent, std::abs(x));
+	build_box(box_side_for(extent));
+}
+
+template<std::size_t N>
+void DBM<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	max_distance = 0U;
+	if (!reuse_storage) buffer.shrink_to_fit();
+	// the box is rebuilt about the bare attractor upon the next growth
+	levels.clear();
+	node_index.clear();
+	perimeter.clear();
+	weights.clear();
+	weight_tree.clear();
+	if (!reuse_storage) {
+		levels.shrink_to_fit();
+		node_index.shrink_to_fit();
+		perimeter.shrink_to_fit();
+		weights.shrink_to_fit();
+		weight_tree.shrink_to_fit();
+	}
+	is_attractor_initialised = false;
+}
+
+template<std::size_t N>
+void DBM<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	// boundary conditions follow the spawn sources
+	else if (box_sources != std::make_pair(is_spawn_source_above, is_spawn_source_below)) build_box(levels.front().side);
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		buffer.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	if (recorder.active()) recorder.start_clock();
+	while (size() < n || continuous.is_raised()) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		if (!is_field_solved || since_solve >= std::max(min_solve_interval, size() / solve_fraction)) solve_field();
+		if (perimeter.empty()) break;
+		const std::size_t slot = draw_perimeter_slot();
+		// particle did not stick to aggregate, the site is drawn anew
+		if (pr_gen() > coeff_stick) {
+			++aggregate_misses_;
+			continue;
+		}
+		occupy(perimeter[slot]);
+		// enlarge the box once the aggregate approaches its faces
+		if (extent + extent / 4 + box_margin > static_cast<int>(levels.front().side / 2U)) build_box(box_side_for(extent));
+	}
+	if (recorder.active()) recorder.stop_clock();
+}
+
+template<std::size_t N>
+double DBM<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	return utl::estimate_fractal_dimension(size(), static_cast<double>(max_distance), attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& DBM<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::node_of(const site_type& s) const noexcept {
+	const grid_level& level = levels.front();
+	const int offset = static_cast<int>(level.side / 2U) + 1;
+	std::size_t node = 0U;
+	for (std::size_t i = 0U; i < N; ++i) node += static_cast<std::size_t>(s[i] + offset)*level.stride[i];
+	return node;
+}
+
+template<std::size_t N>
+typename DBM<N>::site_type DBM<N>::site_of(std::size_t node) const noexcept {
+	const grid_level& level = levels.front();
+	const int offset = static_cast<int>(level.side / 2U) + 1;
+	const std::size_t nodes = level.side + 3U;
+	site_type s;
+	for (std::size_t i = 0U; i < N; ++i) s[i] = static_cast<int>((node / level.stride[i]) % nodes) - offset;
+	return s;
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::box_side_for(int ext) noexcept {
+	// a side of m*2^k, m from 8 to 15, such that the coarsest level is relaxed in few sweeps
+	std::size_t side = std::max(min_box_side, 2U*static_cast<std::size_t>(ext + ext / 2 + 2 * box_margin));
+	std::size_t scale = 1U;
+	while (side > max_coarsest_side*scale) scale *= 2U;
+	return (side + scale - 1U) / scale*scale;
+}
+
+template<std::size_t N>
+void DBM<N>::build_box(std::size_t side) {
+	std::vector<grid_level> old_levels;
+	old_levels.swap(levels);
+	for (std::size_t s = side;; s /= 2U) {
+		grid_level level;
+		level.side = s;
+		std::size_t count = 1U;
+		for (std::size_t i = 0U; i < N; ++i) {
+			level.stride[i] = count;
+			count *= s + 3U;
+		}
+		level.u.assign(count, 0.0);
+		level.residual.assign(count, 0.0);
+		level.fixed.assign(count, HALO);
+		if (!levels.empty()) level.f.assign(count, 0.0);
+		levels.push_back(std::move(level));
+		if (s % 2U != 0U || s <= max_coarsest_side) break;
+	}
+	// every face is a source for two spawn sources, else only the face on the side of the source along the
+	// last axis, the faces of a circle being sources if spawning above (outside)
+	const bool is_one_sided = !(is_spawn_source_above && is_spawn_source_below);
+	is_insulating.fill((attractor == attractor_type::CIRCLE) ? !is_spawn_source_above : is_one_sided);
+	if (attractor != attractor_type::CIRCLE && is_one_sided) is_insulating[2U*(N - 1U) + (is_spawn_source_above ? 1U : 0U)] = false;
+	box_sources = std::make_pair(is_spawn_source_above, is_spawn_source_below);
+	// classify the nodes of the finest level, carrying over the potential of the old box
+	grid_level& fine = levels.front();
+	const std::size_t nodes = side + 3U;
+	const int old_half = old_levels.empty() ? -1 : static_cast<int>(old_levels.front().side / 2U);
+	for (std::size_t node = 0U; node < fine.u.size(); ++node) {
+		bool is_halo = false;
+		bool is_source = false;
+		for (std::size_t i = 0U; i < N; ++i) {
+			const std::size_t j = (node / fine.stride[i]) % nodes;
+			if (j == 0U || j == nodes - 1U) is_halo = true;
+			else if ((j == 1U && !is_insulating[2U*i]) || (j == nodes - 2U && !is_insulating[2U*i + 1U])) is_source = true;
+		}
+		fine.fixed[node] = is_halo ? HALO : (is_source ? SOURCE : FREE);
+		fine.u[node] = 1.0;
+		if (!is_halo && !is_source && old_half >= 0) {
+			const site_type s = site_of(node);
+			bool is_inside = true;
+			for (std::size_t i = 0U; i < N; ++i) is_inside = is_inside && std::abs(s[i]) <= old_half;
+			if (is_inside) {
+				const grid_level& old = old_levels.front();
+				std::size_t old_node = 0U;
+				for (std::size_t i = 0U; i < N; ++i) old_node += static_cast<std::size_t>(s[i] + old_half + 1)*old.stride[i];
+				fine.u[node] = old.u[old_node];
+			}
+		}
+	}
+	old_levels.clear();
+	node_index.assign(fine.u.size(), no_index);
+	if (attractor == attractor_type::CIRCLE && is_spawn_source_below && attractor_size > 0U) {
+		const std::size_t centre = node_of(site_type{});
+		fine.fixed[centre] = SOURCE;
+		fine.u[centre] = 1.0;
+	}
+	// attractor and aggregate nodes, fixed at zero
+	std::vector<std::size_t> fixed_nodes;
+	fixed_nodes.reserve(attractor_sites.size() + buffer.size());
+	for (const auto& s : attractor_sites) fixed_nodes.push_back(node_of(s));
+	for (const auto& q : buffer) {
+		fixed_nodes.push_back(node_of(utl::coordinates_of(q)));
+		node_index[fixed_nodes.back()] = static_cast<std::uint32_t>(fixed_nodes.size() - attractor_sites.size() - 1U);
+	}
+	for (std::size_t node : fixed_nodes) {
+		fine.fixed[node] = AGGREGATE;
+		fine.u[node] = 0.0;
+	}
+	// coarse nodes coincident with fixed sources, and those about the attractor and aggregate
+	for (std::size_t k = 1U; k < levels.size(); ++k) {
+		grid_level& coarse = levels[k];
+		const grid_level& finer = levels[k - 1U];
+		const std::size_t coarse_nodes = coarse.side + 3U;
+		for (std::size_t node = 0U; node < coarse.u.size(); ++node) {
+			std::size_t finer_node = 0U;
+			bool is_halo = false;
+			for (std::size_t i = 0U; i < N; ++i) {
+				const std::size_t j = (node / coarse.stride[i]) % coarse_nodes;
+				is_halo = is_halo || j == 0U || j == coarse_nodes - 1U;
+				finer_node += (2U*j - 1U)*finer.stride[i];
+			}
+			if (!is_halo) coarse.fixed[node] = (finer.fixed[finer_node] == SOURCE) ? SOURCE : FREE;
+		}
+	}
+	for (std::size_t node : fixed_nodes) fix_coarse_nodes(node);
+	// perimeter of the attractor and aggregate
+	perimeter.clear();
+	weights.clear();
+	weight_tree.clear();
+	for (std::size_t node : fixed_nodes) {
+		for (std::size_t i = 0U; i < N; ++i) {
+			for (std::size_t next : { node - fine.stride[i], node + fine.stride[i] })
+				if (fine.fixed[next] == FREE && node_index[next] == no_index) push_perimeter(next);
+		}
+	}
+	is_field_solved = false;
+}
+
+template<std::size_t N>
+void DBM<N>::mirror_halo(const grid_level& level, std::vector<double>& values) const noexcept {
+	const std::size_t nodes = level.side + 3U;
+	const std::size_t face_nodes = values.size() / nodes;
+	for (std::size_t i = 0U; i < N; ++i) {
+		for (std::size_t high = 0U; high < 2U; ++high) {
+			if (!is_insulating[2U*i + high]) continue;
+			const std::size_t face = high ? (nodes - 1U)*level.stride[i] : 0U;
+			for (std::size_t j = 0U; j < face_nodes; ++j) {
+				std::size_t node = face;
+				std::size_t rem = j;
+				for (std::size_t a = 0U; a < N; ++a) {
+					if (a == i) continue;
+					node += (rem % nodes)*level.stride[a];
+					rem /= nodes;
+				}
+				values[node] = high ? values[node - 2U*level.stride[i]] : values[node + 2U*level.stride[i]];
+			}
+		}
+	}
+}
+
+template<std::size_t N>
+void DBM<N>::sweep(std::size_t k, std::size_t colour, const site_type& lo, const site_type& hi) {
+	grid_level& level = levels[k];
+	double* const u = level.u.data();
+	const double* const f = level.f.empty() ? nullptr : level.f.data();
+	const std::uint8_t* const fixed = level.fixed.data();
+	const auto& stride = level.stride;
+	// rows along the first axis, over the window of the other axes
+	std::size_t rows = 1U;
+	for (std::size_t i = 1U; i < N; ++i) rows *= static_cast<std::size_t>(hi[i] - lo[i] + 1);
+	const std::size_t row_length = static_cast<std::size_t>(hi[0] - lo[0] + 1);
+	utl::parallel_for_chunks(rows, chunk_count(rows, rows*row_length / 2U, threads), [=, &lo, &hi](std::size_t, std::size_t first, std::size_t last) {
+		for (std::size_t row = first; row < last; ++row) {
+			std::size_t base = 0U;
+			std::size_t rem = row;
+			int sum = 0;
+			for (std::size_t i = 1U; i < N; ++i) {
+				const std::size_t width = static_cast<std::size_t>(hi[i] - lo[i] + 1);
+				const int j = lo[i] + static_cast<int>(rem % width);
+				rem /= width;
+				base += static_cast<std::size_t>(j)*stride[i];
+				sum += j;
+			}
+			// nodes of the row whose co-ordinate sum has the parity of the colour
+			for (int j = lo[0] + ((lo[0] + sum + static_cast<int>(colour)) & 1); j <= hi[0]; j += 2) {
+				const std::size_t node = base + static_cast<std::size_t>(j);
+				if (fixed[node]) continue;
+				double s = f ? f[node] : 0.0;
+				for (std::size_t i = 0U; i < N; ++i) s += u[node - stride[i]] + u[node + stride[i]];
+				u[node] = s / (2.0*N);
+			}
+		}
+	});
+}
+
+template<std::size_t N>
+void DBM<N>::smooth(std::size_t k) {
+	grid_level& level = levels[k];
+	site_type lo;
+	site_type hi;
+	lo.fill(1);
+	hi.fill(static_cast<int>(level.side) + 1);
+	for (std::size_t colour = 0U; colour < 2U; ++colour) {
+		mirror_halo(level, level.u);
+		sweep(k, colour, lo, hi);
+	}
+}
+
+template<std::size_t N>
+double DBM<N>::compute_residual(std::size_t k) {
+	grid_level& level = levels[k];
+	mirror_halo(level, level.u);
+	const double* const u = level.u.data();
+	const double* const f = level.f.empty() ? nullptr : level.f.data();
+	const std::uint8_t* const fixed = level.fixed.data();
+	double* const r = level.residual.data();
+	const auto& stride = level.stride;
+	const std::size_t nodes = level.side + 3U;
+	const std::size_t rows = level.u.size() / nodes;
+	std::vector<double> largest(chunk_count(rows, level.u.size(), threads), 0.0);
+	utl::parallel_for_chunks(rows, chunk_count(rows, level.u.size(), threads), [=, &largest](std::size_t chunk, std::size_t first, std::size_t last) {
+		double largest_here = 0.0;
+		for (std::size_t row = first; row < last; ++row) {
+			// skip rows in the halo of the other axes
+			bool is_halo = false;
+			for (std::size_t i = 1U; i < N; ++i) {
+				const std::size_t j = (row*nodes / stride[i]) % nodes;
+				is_halo = is_halo || j == 0U || j == nodes - 1U;
+			}
+			if (is_halo) continue;
+			for (std::size_t node = row*nodes + 1U; node < (row + 1U)*nodes - 1U; ++node) {
+				if (fixed[node]) {
+					r[node] = 0.0;
+					continue;
+				}
+				double s = (f ? f[node] : 0.0) - 2.0*N*u[node];
+				for (std::size_t i = 0U; i < N; ++i) s += u[node - stride[i]] + u[node + stride[i]];
+				r[node] = s;
+				largest_here = std::max(largest_here, std::abs(s));
+			}
+		}
+		largest[chunk] = largest_here;
+	});
+	mirror_halo(level, level.residual);
+	return *std::max_element(largest.begin(), largest.end());
+}
+
+template<std::size_t N>
+void DBM<N>::restrict_residual(std::size_t k) {
+	const grid_level& fine = levels[k];
+	grid_level& coarse = levels[k + 1U];
+	// full weighting over the 3^N fine nodes about each coarse node, scaled by the squared ratio of spacings
+	constexpr std::size_t stencil = (N == 2U) ? 9U : 27U;
+	std::array<std::ptrdiff_t, stencil> offsets;
+	std::array<double, stencil> stencil_weights;
+	for (std::size_t d = 0U; d < stencil; ++d) {
+		std::size_t digits = d;
+		offsets[d] = 0;
+		stencil_weights[d] = 4.0;
+		for (std::size_t i = 0U; i < N; ++i, digits /= 3U) {
+			const int step = static_cast<int>(digits % 3U) - 1;
+			offsets[d] += step*static_cast<std::ptrdiff_t>(fine.stride[i]);
+			stencil_weights[d] *= (step == 0) ? 0.5 : 0.25;
+		}
+	}
+	std::fill(coarse.u.begin(), coarse.u.end(), 0.0);
+	const double* const r = fine.residual.data();
+	double* const f = coarse.f.data();
+	const std::uint8_t* const fixed = coarse.fixed.data();
+	const std::size_t nodes = coarse.side + 3U;
+	const std::size_t rows = coarse.u.size() / nodes;
+	utl::parallel_for_chunks(rows, chunk_count(rows, coarse.u.size()*stencil, threads), [&, r, f, fixed](std::size_t, std::size_t first, std::size_t last) {
+		for (std::size_t row = first; row < last; ++row) {
+			// finest node coincident with the first node of the row, skipping rows in the halo
+			bool is_halo = false;
+			std::size_t fine_base = 0U;
+			for (std::size_t i = 1U; i < N; ++i) {
+				const std::size_t j = (row*nodes / coarse.stride[i]) % nodes;
+				is_halo = is_halo || j == 0U || j == nodes - 1U;
+				fine_base += (2U*j - 1U)*fine.stride[i];
+			}
+			if (is_halo) continue;
+			for (std::size_t j = 1U; j < nodes - 1U; ++j) {
+				const std::size_t node = row*nodes + j;
+				if (fixed[node]) {
+					f[node] = 0.0;
+					continue;
+				}
+				const std::size_t centre = fine_base + 2U*j - 1U;
+				double s = 0.0;
+				for (std::size_t d = 0U; d < stencil; ++d) s += stencil_weights[d]*r[centre + offsets[d]];
+				f[node] = s;
+			}
+		}
+	});
+}
+
+template<std::size_t N>
+void DBM<N>::prolong_correction(std::size_t k) {
+	grid_level& fine = levels[k];
+	const grid_level& coarse = levels[k + 1U];
+	double* const u = fine.u.data();
+	const double* const e = coarse.u.data();
+	const std::uint8_t* const fixed = fine.fixed.data();
+	const std::size_t nodes = fine.side + 3U;
+	const std::size_t rows = fine.u.size() / nodes;
+	utl::parallel_for_chunks(rows, chunk_count(rows, fine.u.size(), threads), [&, u, e, fixed](std::size_t, std::size_t first, std::size_t last) {
+		// coarse nodes interpolated along the other axes, and their weights
+		constexpr std::size_t corners = 1U << (N - 1U);
+		std::array<std::size_t, corners> bases;
+		std::array<double, corners> corner_weights;
+		for (std::size_t row = first; row < last; ++row) {
+			bool is_halo = false;
+			std::size_t count = 1U;
+			bases[0] = 0U;
+			corner_weights[0] = 1.0;
+			for (std::size_t i = 1U; i < N; ++i) {
+				const std::size_t j = (row*nodes / fine.stride[i]) % nodes;
+				if (j == 0U || j == nodes - 1U) {
+					is_halo = true;
+					break;
+				}
+				// fine node x = j - 1 lies on coarse node x/2, or midway between two
+				const std::size_t x = j - 1U;
+				const std::size_t lower = x / 2U + 1U;
+				if (x % 2U == 0U) {
+					for (std::size_t c = 0U; c < count; ++c) bases[c] += lower*coarse.stride[i];
+				}
+				else {
+					for (std::size_t c = 0U; c < count; ++c) {
+						bases[c + count] = bases[c] + (lower + 1U)*coarse.stride[i];
+						bases[c] += lower*coarse.stride[i];
+						corner_weights[c] *= 0.5;
+						corner_weights[c + count] = corner_weights[c];
+					}
+					count *= 2U;
+				}
+			}
+			if (is_halo) continue;
+			for (std::size_t j = 1U; j < nodes - 1U; ++j) {
+				const std::size_t node = row*nodes + j;
+				if (fixed[node]) continue;
+				const std::size_t x = j - 1U;
+				const std::size_t lower = x / 2U + 1U;
+				double s = 0.0;
+				for (std::size_t c = 0U; c < count; ++c) {
+					s += corner_weights[c]*((x % 2U == 0U) ? e[bases[c] + lower] : 0.5*(e[bases[c] + lower] + e[bases[c] + lower + 1U]));
+				}
+				u[node] += s;
+			}
+		}
+	});
+}
+
+template<std::size_t N>
+double DBM<N>::v_cycle(std::size_t k) {
+	if (k + 1U == levels.size()) {
+		// relax the few nodes of the coarsest level to convergence
+		const std::size_t sweeps = 2U*levels[k].side*levels[k].side;
+		for (std::size_t s = 0U; s < sweeps; ++s) smooth(k);
+		return (k == 0U) ? compute_residual(k) : 0.0;
+	}
+	for (std::size_t s = 0U; s < pre_sweeps; ++s) smooth(k);
+	const double residual = compute_residual(k);
+	restrict_residual(k);
+	v_cycle(k + 1U);
+	prolong_correction(k);
+	for (std::size_t s = 0U; s < post_sweeps; ++s) smooth(k);
+	return residual;
+}
+
+template<std::size_t N>
+void DBM<N>::solve_field() {
+	const std::size_t cycles = is_field_solved ? warm_cycles : max_cycles;
+	for (std::size_t cycle = 0U; cycle < cycles; ++cycle) {
+		if (v_cycle(0U) < residual_tolerance) break;
+	}
+	for (std::size_t slot = 0U; slot < perimeter.size(); ++slot) weights[slot] = growth_weight(perimeter[slot]);
+	rebuild_weight_tree();
+	is_field_solved = true;
+	since_solve = 0U;
+}
+
+template<std::size_t N>
+void DBM<N>::relax_locally(std::size_t node) {
+	const grid_level& fine = levels.front();
+	const int nodes = static_cast<int>(fine.side) + 3;
+	site_type lo;
+	site_type hi;
+	for (std::size_t i = 0U; i < N; ++i) {
+		const int j = static_cast<int>((node / fine.stride[i]) % static_cast<std::size_t>(nodes));
+		lo[i] = std::max(1, j - local_radius(N));
+		hi[i] = std::min(nodes - 2, j + local_radius(N));
+	}
+	for (std::size_t s = 0U; s < local_sweeps; ++s) {
+		sweep(0U, 0U, lo, hi);
+		sweep(0U, 1U, lo, hi);
+	}
+	// update the weights of the perimeter nodes of the window
+	site_type j = lo;
+	for (;;) {
+		std::size_t window_node = 0U;
+		for (std::size_t i = 0U; i < N; ++i) window_node += static_cast<std::size_t>(j[i])*fine.stride[i];
+		const std::uint32_t slot = node_index[window_node];
+		if (fine.fixed[window_node] == FREE && slot != no_index) {
+			const double w = growth_weight(window_node);
+			add_weight(slot, w - weights[slot]);
+			weights[slot] = w;
+		}
+		std::size_t i = 0U;
+		while (i < N && j[i] == hi[i]) {
+			j[i] = lo[i];
+			++i;
+		}
+		if (i == N) break;
+		++j[i];
+	}
+}
+
+template<std::size_t N>
+double DBM<N>::growth_weight(std::size_t node) const noexcept {
+	const double phi = std::max(0.0, levels.front().u[node]);
+	if (eta == 1.0) return phi;
+	return (eta == 0.0) ? 1.0 : std::pow(phi, eta);
+}
+
+template<std::size_t N>
+void DBM<N>::push_perimeter(std::size_t node) {
+	node_index[node] = static_cast<std::uint32_t>(perimeter.size());
+	perimeter.push_back(node);
+	const double w = growth_weight(node);
+	weights.push_back(w);
+	// tree node i covers the weights (i - lowbit(i), i]
+	const std::size_t i = weights.size();
+	weight_tree.push_back(w + prefix_weight(weight_tree, i - 1U) - prefix_weight(weight_tree, i - (i & (~i + 1U))));
+}
+
+template<std::size_t N>
+void DBM<N>::erase_perimeter(std::size_t node) noexcept {
+	const std::size_t slot = node_index[node];
+	const std::size_t last = perimeter.size() - 1U;
+	// move the last node into the slot, the last tree node alone covering the last weight
+	if (slot != last) {
+		add_weight(slot, weights[last] - weights[slot]);
+		weights[slot] = weights[last];
+		perimeter[slot] = perimeter[last];
+		node_index[perimeter[slot]] = static_cast<std::uint32_t>(slot);
+	}
+	perimeter.pop_back();
+	weights.pop_back();
+	weight_tree.pop_back();
+	node_index[node] = no_index;
+}
+
+template<std::size_t N>
+void DBM<N>::add_weight(std::size_t slot, double delta) noexcept {
+	for (std::size_t i = slot + 1U; i <= weight_tree.size(); i += i & (~i + 1U)) weight_tree[i - 1U] += delta;
+}
+
+template<std::size_t N>
+void DBM<N>::rebuild_weight_tree() noexcept {
+	weight_tree = weights;
+	for (std::size_t i = 1U; i <= weight_tree.size(); ++i) {
+		const std::size_t parent = i + (i & (~i + 1U));
+		if (parent <= weight_tree.size()) weight_tree[parent - 1U] += weight_tree[i - 1U];
+	}
+}
+
+template<std::size_t N>
+std::size_t DBM<N>::draw_perimeter_slot() noexcept {
+	const std::size_t count = weight_tree.size();
+	const double total = prefix_weight(weight_tree, count);
+	if (!(total > 0.0)) return utl::step_index(pr_gen(), count);
+	// descend the tree to the first slot whose cumulative weight exceeds the target
+	double target = pr_gen()*total;
+	std::size_t slot = 0U;
+	std::size_t bit = 1U;
+	while (2U*bit <= count) bit *= 2U;
+	for (; bit > 0U; bit /= 2U) {
+		if (slot + bit <= count && weight_tree[slot + bit - 1U] <= target) {
+			slot += bit;
+			target -= weight_tree[slot - 1U];
+		}
+	}
+	return std::min(slot, count - 1U);
+}
+
+template<std::size_t N>
+void DBM<N>::fix_coarse_nodes(std::size_t node) {
+	// array indices of the nodes fixed on the current level, starting from the finest
+	std::vector<std::array<std::size_t, N>> current(1U);
+	std::vector<std::array<std::size_t, N>> next;
+	for (std::size_t i = 0U; i < N; ++i) current[0][i] = (node / levels.front().stride[i]) % (levels.front().side + 3U);
+	for (std::size_t k = 1U; k < levels.size() && !current.empty(); ++k) {
+		grid_level& coarse = levels[k];
+		next.clear();
+		for (const auto& j : current) {
+			// coarse nodes whose 3^N fine nodes of full weighting include node j: J = (j + 1)/2 for odd j,
+			// coincident with it, else J = j/2 and j/2 + 1
+			for (std::size_t corner = 0U; corner < (1U << N); ++corner) {
+				std::array<std::size_t, N> c;
+				std::size_t coarse_node = 0U;
+				bool is_valid = true;
+				for (std::size_t i = 0U; i < N; ++i) {
+					const bool is_upper = ((corner >> i) & 1U) != 0U;
+					if (j[i] % 2U == 1U) {
+						is_valid = is_valid && !is_upper;
+						c[i] = (j[i] + 1U) / 2U;
+					}
+					else c[i] = j[i] / 2U + (is_upper ? 1U : 0U);
+					coarse_node += c[i]*coarse.stride[i];
+				}
+				if (!is_valid || coarse.fixed[coarse_node] == AGGREGATE || coarse.fixed[coarse_node] == HALO) continue;
+				coarse.fixed[coarse_node] = AGGREGATE;
+				next.push_back(c);
+			}
+		}
+		current.swap(next);
+	}
+}
+
+template<std::size_t N>
+void DBM<N>::occupy(std::size_t node) {
+	grid_level& fine = levels.front();
+	// the parent is the first occupied neighbour in order of the axes
+	std::size_t parent = utl::no_parent;
+	for (std::size_t i = 0U; i < N && parent == utl::no_parent; ++i) {
+		for (std::size_t next : { node - fine.stride[i], node + fine.stride[i] }) {
+			if (fine.fixed[next] == AGGREGATE && node_index[next] != no_index) {
+				parent = node_index[next];
+				break;
+			}
+		}
+	}
+	erase_perimeter(node);
+	fine.fixed[node] = AGGREGATE;
+	fine.u[node] = 0.0;
+	node_index[node] = static_cast<std::uint32_t>(buffer.size());
+	fix_coarse_nodes(node);
+	for (std::size_t i = 0U; i < N; ++i) {
+		for (std::size_t next : { node - fine.stride[i], node + fine.stride[i] })
+			if (fine.fixed[next] == FREE && node_index[next] == no_index) push_perimeter(next);
+	}
+	const site_type s = site_of(node);
+	const particle_type p = utl::make_lattice_point<N>(s);
+	if (track_parents) parents.push_back(parent);
+	buffer.push_back(p);
+	++occupied_sites;
+	for (int x : s) extent = std::max(extent, std::abs(x));
+	max_distance = std::max(max_distance, static_cast<std::size_t>(std::abs(utl::attractor_distance(p, attractor, attractor_size))));
+	const std::size_t circle_offset = (N == 2U && attractor == attractor_type::CIRCLE) ? attractor_size : 0U;
+	aggregate_span = (max_distance > circle_offset) ? max_distance - circle_offset : 0U;
+	if (recorder.active()) {
+		recorder.accumulate(p);
+		if (recorder.due(buffer.size())) {
+			// linear distance from a 2D line or a plane, squared distance otherwise
+			const bool is_linear = attractor == ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE);
+			recorder.record(buffer.size(), is_linear ? max_distance : std::sqrt(max_distance), aggregate_misses_, walk_steps);
+		}
+	}
+	relax_locally(node);
+	++since_solve;
+}
+
+template class DBM<2U>;
+template class DBM<3U>;
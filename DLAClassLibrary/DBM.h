@@ -0,0 +1,317 @@
+#pragma once
+#include "DLAContainer.h"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * \class DBM
+ *
+ * \brief Defines an aggregate grown by the dielectric breakdown model on an `N`-dimensional square lattice.
+ *
+ * The aggregate and attractor are held at potential zero within a box held at potential one, and each new
+ * particle occupies an empty site neighbouring the aggregate with probability proportional to the potential
+ * at that site, i.e. the local field |grad phi| of the aggregate, raised to the power `eta`. For eta = 1 the
+ * growth is statistically that of DLA and for eta = 0 that of the Eden model, larger eta giving sparser
+ * aggregates.
+ *
+ * Laplace's equation is solved on the nodes of the box by multigrid V-cycles of red-black Gauss-Seidel
+ * sweeps, warm-started from the previous field. After each attachment only a window about the new particle
+ * is relaxed, the whole field being solved again once the aggregate has grown by a fixed fraction of its
+ * size. The sweeps and grid transfers of large grids are split into slabs across worker threads, every
+ * node of one colour being independent such that the field does not depend on the number of threads. The
+ * growth probabilities of the perimeter sites are held in a Fenwick tree, such that a site is drawn and its
+ * probability updated in O(log P) for a perimeter of P sites.
+ *
+ * The attractor types are boundary conditions of the same geometry as for DLA<N>. Every face of the box is
+ * held at potential one for spawn sources above and below, and for a single source only the face on its
+ * side along the last axis, the other faces being insulating. The faces of the box about a CIRCLE attractor
+ * are instead held at potential one if spawning above, and its centre if spawning below.
+ * The box is enlarged as the aggregate approaches its faces. Parent tracking, growth recording and
+ * output behave as for the lattice aggregates, the aggregate cache is not consulted and no random walk
+ * steps are taken.
+ *
+ * Instantiated for N = 2 and 3 in DBM.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class DBM : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of DBM must be 2 or 3.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::array<int, N> site_type;
+	typedef std::vector<particle_type> aggregate_buffer_vector;
+	/**
+	 * \struct grid_level
+	 *
+	 * \brief Level of the multigrid hierarchy, of nodes 0 to `side` along each axis surrounded by a layer
+	 *        of halo nodes mirroring the nodes next to insulating faces.
+	 */
+	struct grid_level {
+		std::size_t side;
+		std::array<std::size_t, N> stride;
+		// potential on the finest level, correction of the level above on coarser levels
+		std::vector<double> u;
+		// right hand side, empty on the finest level where it is zero
+		std::vector<double> f;
+		std::vector<double> residual;
+		// node_state of each node, coarser levels holding FREE, AGGREGATE or SOURCE at nodes other than the halo
+		std::vector<std::uint8_t> fixed;
+	};
+public:
+	/**
+	 * \brief Default constructor, initialises empty aggregate with a point attractor.
+	 *
+	 * \param _eta [= 1.0] Exponent of the local field in the growth probability.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _eta is negative or _coeff_stick not in (0,1].
+	 */
+	explicit DBM(double _eta = 1.0, const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \brief Initialises empty aggregate with specified attractor type.
+	 *
+	 * \param att Type of attractor of initial aggregate.
+	 * \param att_size Size of attractor.
+	 * \param _eta [= 1.0] Exponent of the local field in the growth probability.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _eta is negative or the attractor type is PLANE in 2D.
+	 */
+	DBM(attractor_type att, std::size_t att_size, double _eta = 1.0, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~DBM() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing the
+	 *        particles of the aggregate in the order in which they were added.
+	 *
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the exponent of the local field in the growth probability.
+	 */
+	double get_eta() const noexcept;
+	/**
+	 * \brief Sets the exponent of the local field in the growth probability, applying to all
+	 *        subsequent growth.
+	 *
+	 * \param _eta Exponent to set.
+	 * \throw Throws std::invalid_argument exception if _eta is negative.
+	 */
+	void set_eta(double _eta);
+	/**
+	 * \brief Sets the number of threads relaxing the field.
+	 *
+	 * \param _threads Number of threads, zero for the hardware concurrency.
+	 */
+	void set_thread_count(std::size_t _threads);
+	/**
+	 * \brief Gets the number of threads relaxing the field.
+	 */
+	std::size_t thread_count() const noexcept;
+	/**
+	 * \brief Gets the side of the box on which the field is solved, in lattice units.
+	 */
+	std::size_t box_length() const noexcept;
+	/**
+	 * \brief Gets the potential at a site, zero on the aggregate and attractor and one outside the box,
+	 *        as of the last relaxation.
+	 *
+	 * \param p Co-ordinates of site.
+	 */
+	double potential(const particle_type& p) const noexcept;
+	/**
+	 * \brief The field is solved on the square lattice only.
+	 *
+	 * \throw Throws std::invalid_argument exception if ltt is not lattice_type::SQUARE.
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is PLANE in 2D.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \copydoc DLAContainer::initialise_attractor_structure()
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the aggregate until it consists of the parameterised number of particles,
+	 *        continuing from any existing aggregate.
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the aggregate particles to an output stream. Without sorting each line is
+	 *        prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// state of a node
+	enum node_state : std::uint8_t { FREE, AGGREGATE, SOURCE, HALO };
+	// perimeter slot of a free node, generation index of an aggregate node, none for the attractor
+	static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+	double eta;
+	std::size_t threads;
+	// sites of attractor
+	std::vector<site_type> attractor_sites;
+	// particles of the aggregate in order of generation
+	aggregate_buffer_vector buffer;
+	// largest co-ordinate magnitude of any particle or attractor site, bounding the aggregate within the box
+	int extent = 0;
+	// largest distance of any particle from the attractor, as ordered by utl::distance_comparator
+	std::size_t max_distance = 0U;
+	// multigrid hierarchy, the finest level first
+	std::vector<grid_level> levels;
+	// perimeter slot or generation index of each node of the finest level
+	std::vector<std::uint32_t> node_index;
+	// whether each face of the box, low then high along each axis, is insulating rather than held at one
+	std::array<bool, 2U * N> is_insulating = {};
+	// spawn sources for which the boundary conditions of the box were set
+	std::pair<bool, bool> box_sources;
+	// nodes of the perimeter, the weight of each and the Fenwick tree of the weights
+	std::vector<std::size_t> perimeter;
+	std::vector<double> weights;
+	std::vector<double> weight_tree;
+	// number of attachments since the field was last solved over the whole box, or none if it must be solved
+	std::size_t since_solve = 0U;
+	bool is_field_solved = false;
+	/**
+	 * \brief Computes the index of the finest level node of a site.
+	 */
+	std::size_t node_of(const site_type& s) const noexcept;
+	/**
+	 * \brief Computes the site of a node of the finest level.
+	 */
+	site_type site_of(std::size_t node) const noexcept;
+	/**
+	 * \brief Builds the multigrid hierarchy for a box of the given side, sets the boundary conditions
+	 *        and the attractor and aggregate nodes and collects the perimeter, carrying over the
+	 *        potential of the current box.
+	 *
+	 * \param side Side of the box.
+	 */
+	void build_box(std::size_t side);
+	/**
+	 * \brief Computes the side of the box for an aggregate of given extent.
+	 */
+	static std::size_t box_side_for(int ext) noexcept;
+	/**
+	 * \brief Copies the nodes next to each insulating face of a level into its halo.
+	 *
+	 * \param level Level of hierarchy.
+	 * \param values Values of the nodes of the level.
+	 */
+	void mirror_halo(const grid_level& level, std::vector<double>& values) const noexcept;
+	/**
+	 * \brief Relaxes the nodes of one colour of a level within a window by a Gauss-Seidel sweep.
+	 *
+	 * \param k Index of level.
+	 * \param colour Parity of the co-ordinate sum of the nodes relaxed.
+	 * \param lo Lowest co-ordinates of the window, in array indices.
+	 * \param hi Highest co-ordinates of the window, in array indices.
+	 */
+	void sweep(std::size_t k, std::size_t colour, const site_type& lo, const site_type& hi);
+	/**
+	 * \brief Relaxes all nodes of a level by a red-black Gauss-Seidel sweep.
+	 */
+	void smooth(std::size_t k);
+	/**
+	 * \brief Computes the residual of a level.
+	 *
+	 * \return Largest magnitude of the residual.
+	 */
+	double compute_residual(std::size_t k);
+	/**
+	 * \brief Restricts the residual of a level by full weighting to the right hand side of the next
+	 *        coarser level, zeroing its correction.
+	 */
+	void restrict_residual(std::size_t k);
+	/**
+	 * \brief Interpolates the correction of the next coarser level linearly and adds it to a level.
+	 */
+	void prolong_correction(std::size_t k);
+	/**
+	 * \brief Performs a multigrid V-cycle from a level down.
+	 *
+	 * \return Largest magnitude of the residual of the level after pre-smoothing.
+	 */
+	double v_cycle(std::size_t k);
+	/**
+	 * \brief Solves the field over the whole box and recomputes every perimeter weight.
+	 */
+	void solve_field();
+	/**
+	 * \brief Relaxes the field within a window about a node and updates the perimeter weights therein.
+	 */
+	void relax_locally(std::size_t node);
+	/**
+	 * \brief Computes the growth weight of a node from its potential.
+	 */
+	double growth_weight(std::size_t node) const noexcept;
+	/**
+	 * \brief Adds a free node to the perimeter.
+	 */
+	void push_perimeter(std::size_t node);
+	/**
+	 * \brief Removes a node from the perimeter.
+	 */
+	void erase_perimeter(std::size_t node) noexcept;
+	/**
+	 * \brief Adds `delta` to the weight of a perimeter slot in the Fenwick tree.
+	 */
+	void add_weight(std::size_t slot, double delta) noexcept;
+	/**
+	 * \brief Rebuilds the Fenwick tree from the perimeter weights.
+	 */
+	void rebuild_weight_tree() noexcept;
+	/**
+	 * \brief Draws a perimeter slot with probability proportional to its weight.
+	 */
+	std::size_t draw_perimeter_slot() noexcept;
+	/**
+	 * \brief Fixes the nodes of the coarser levels to which the residual at a newly fixed node of the
+	 *        finest level is restricted, such that no coarse grid correction crosses the aggregate.
+	 *
+	 * \param node Node of the finest level.
+	 */
+	void fix_coarse_nodes(std::size_t node);
+	/**
+	 * \brief Occupies a perimeter node by a new particle of the aggregate.
+	 *
+	 * \param node Node of the finest level.
+	 */
+	void occupy(std::size_t node);
+};
+
+typedef DBM<2U> DBM_2d;
+typedef DBM<3U> DBM_3d;
+
+extern template class DBM<2U>;
+extern template class DBM<3U>;
@@ -0,0 +1,610 @@
+#include "Stdafx.h"
+#include "DLA.h"
+
+namespace {
+	template<class Point, std::size_t... I>
+	void translate(Point& p, const utl::lattice_step& step, std::index_sequence<I...>) noexcept {
+		int expand[] = { 0, (std::get<I>(p) += step.offset[I])... };
+		(void)expand;
+	}
+	// whether any co-ordinate lies beyond its bound, axes 0 and 1 having bounds of their own
+	template<class Point, std::size_t... I>
+	bool is_outside(const Point& p, int bound_0, int bound_1, int bound_rest, std::index_sequence<I...>) noexcept {
+		bool outside = false;
+		bool expand[] = { false, (outside = outside || std::abs(std::get<I>(p)) > (I == 0U ? bound_0 : I == 1U ? bound_1 : bound_rest))... };
+		(void)expand;
+		return outside;
+	}
+	// wraps the first `count` co-ordinates into [-half, half), a lattice step crossing at most one end
+	template<class Point, std::size_t... I>
+	void wrap(Point& p, std::size_t count, int half, std::index_sequence<I...>) noexcept {
+		int expand[] = { 0, (std::get<I>(p) += (I >= count) ? 0 : (std::get<I>(p) >= half) ? -2*half : (std::get<I>(p) < -half) ? 2*half : 0)... };
+		(void)expand;
+	}
+}
+
+template<std::size_t N>
+constexpr std::size_t DLA<N>::dimension;
+
+template<std::size_t N>
+DLA<N>::DLA(const double& _coeff_stick, std::uint64_t _seed, utl::memory_resource* _resource) : DLAContainer(_coeff_stick, _seed),
+	aggregate_map(_resource), attractor_set(_resource),
+	aggregate_pq(utl::distance_comparator(attractor_type::POINT, 1U), _resource), buffer(_resource) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+}
+
+template<std::size_t N>
+DLA<N>::DLA(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick, std::uint64_t _seed,
+	utl::memory_resource* _resource) : DLAContainer(ltt, att, att_size, _coeff_stick, _seed),
+	aggregate_map(_resource), attractor_set(_resource),
+	aggregate_pq(utl::distance_comparator(att, att_size), _resource), buffer(_resource) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	if (N > 3U && att != attractor_type::POINT)
+		throw std::invalid_argument("attractor type of DLA above 3D must be POINT.");
+	initialise_attractor_structure();
+}
+
+template<std::size_t N>
+DLA<N>::DLA(const DLA& other) : DLAContainer(other),
+	aggregate_map(other.aggregate_map), attractor_set(other.attractor_set), aggregate_pq(other.aggregate_pq),
+	buffer(other.buffer), attractor_radius(other.attractor_radius), max_distance(other.max_distance) {}
+
+template<std::size_t N>
+DLA<N>::DLA(DLA&& other) noexcept : DLAContainer(std::move(other)),
+	aggregate_map(std::move(other.aggregate_map)), attractor_set(std::move(other.attractor_set)),
+	aggregate_pq(std::move(other.aggregate_pq)), buffer(std::move(other.buffer)),
+	notifier(std::move(other.notifier)), attractor_radius(other.attractor_radius), max_distance(other.max_distance) {}
+
+template<std::size_t N>
+utl::memory_resource* DLA<N>::get_memory_resource() const noexcept {
+	return buffer.get_allocator().resource();
+}
+
+template<std::size_t N>
+std::size_t DLA<N>::size() const noexcept {
+	return occupied_sites;
+}
+
+template<std::size_t N>
+const typename DLA<N>::aggregate_buffer_vector& DLA<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+void DLA<N>::add_observer(std::shared_ptr<utl::attachment_observer<particle_type>> observer, std::size_t batch_size,
+	std::chrono::microseconds interval, utl::dispatch_mode mode) {
+	notifier.add(std::move(observer), batch_size, interval, mode, buffer.size());
+}
+
+template<std::size_t N>
+void DLA<N>::remove_observer(const std::shared_ptr<utl::attachment_observer<particle_type>>& observer) {
+	notifier.remove(observer);
+}
+
+template<std::size_t N>
+void DLA<N>::set_lattice_type(lattice_type ltt) {
+	// look up first such that an invalid lattice type leaves the aggregate unchanged
+	lattice_geometry = &utl::describe_lattice(ltt, static_cast<unsigned>(N));
+	// a CIRCLE attractor is drawn anew in the Cartesian plane of the new lattice upon the next growth
+	if (ltt != lattice) is_attractor_initialised = false;
+	DLAContainer::set_lattice_type(ltt);
+	measure_aggregate();
+}
+
+template<std::size_t N>
+void DLA<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	// invalid attractor types for dimension of lattice
+	if (N == 2U && attr == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DLA to PLANE.");
+	if (N > 3U && attr != attractor_type::POINT)
+		throw std::invalid_argument("attractor type of DLA above 3D must be POINT.");
+	DLAContainer::set_attractor_type(attr, att_size);
+	aggregate_pq.comparator().att = attr;	// get handle to comparator of pq and alter its attractor_type field
+	aggregate_pq.comparator().att_size = attractor_size;
+	if (!aggregate_pq.empty()) aggregate_pq.reheapify(); // perform reordering of pq based on new attractor_type
+	measure_aggregate();
+}
+
+template<std::size_t N>
+void DLA<N>::initialise_attractor_structure() {
+	attractor_set.clear();	// clear any current attractor
+	attractor_set.reserve(attractor_size);	// pre-allocate memory buckets
+	is_attractor_initialised = true;
+	attractor_radius = 0;
+	// every attractor lies in the plane of the first two axes
+	for (const auto& site : utl::attractor_sites<N>(attractor, attractor_size, *lattice_geometry)) {
+		const particle_type p = utl::make_lattice_point<N>(site);
+		attractor_set.insert(p);
+		attractor_radius = std::max(attractor_radius, static_cast<int>(std::sqrt(utl::attractor_distance(p, attractor_type::POINT, 0U))));
+	}
+}
+
+template<std::size_t N>
+void DLA<N>::clear() {
+	DLAContainer::clear();
+	// vacate all sites at once retaining their nodes, unless stale sites have accumulated
+	if (!reuse_storage || advance_epoch(aggregate_map.size(), buffer.capacity())) aggregate_map.clear();
+	aggregate_pq.clear();
+	buffer.clear();
+	max_distance = 0.0;
+	// return memory to the system only from the global heap, an arena reclaims nothing on
+	// deallocation such that shrinking would merely allocate smaller copies from it
+	if (!reuse_storage && *get_memory_resource() == *utl::new_delete_resource()) {
+		aggregate_pq.shrink_to_fit();
+		buffer.shrink_to_fit();
+	}
+	notifier.reset(0U);
+}
+
+template<std::size_t N>
+void DLA<N>::grow_to(std::size_t n) {
+	// compute attractor geometry inserting points to attractor_set, only if changed since last growth
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	// grow capacity geometrically such that staged continuations avoid repeated rehashing
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		aggregate_map.reserve(new_cap);	// pre-allocate memory slots in agg map
+		aggregate_pq.reserve(new_cap); // pre-allocate capacity to underlying container of priority_queue
+		buffer.reserve(new_cap);	// pre-allocate storage for buffer vector to avoid expensive reallocations
+		if (track_parents) parents.reserve(new_cap);
+	}
+	// serve generation from empty with a freshly seeded generator out of the aggregate cache
+	const bool cacheable = is_cacheable(n);
+	if (cacheable && load_cached(n)) return;
+	is_seed_fresh = false;
+	// continue generation indices from current aggregate
+	std::size_t count = buffer.size();
+	// initialise current and previous co-ordinate containers
+	particle_type current = utl::make_lattice_point<N>(std::array<int, N>{});
+	particle_type prev = current;
+	bool has_next_spawned = false;
+	// variable to store current allowed size of bounding
+	// box spawning zone
+	int spawn_diameter = 0;
+	// axes along which the substrate is periodic, excluded from the radius of gyration
+	const std::size_t wrapped = periodic_axes();
+	recorder.set_periodic_axes(wrapped);
+	if (recorder.active()) recorder.start_clock();
+	// aggregate generation loop
+	while (size() < n || continuous.is_raised()) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		// spawn the next particle if previous particle
+		// successfully stuck to aggregate structure
+		if (!has_next_spawned) {
+			spawn_particle(current, spawn_diameter);
+			utl::snap_to_lattice(current, lattice_geometry->sites);
+			// snapping may carry a spawn across the end of a periodic substrate
+			if (wrapped) wrap(current, wrapped, static_cast<int>(attractor_size) / 2, std::make_index_sequence<N>());
+			has_next_spawned = true;
+		}
+		prev = current;
+		// update position of particle via unbiased random walk
+		update_particle_position(current, pr_gen());
+		++walk_steps;
+		// check for collision with bounding walls and reflect if true
+		lattice_boundary_collision(current, prev, spawn_diameter);
+		// check for collision with aggregate structure and add particle to
+		// the aggregate (both to map and pq) if true, set flag ready for
+		// next particle spawn
+		if (aggregate_collision(current, prev, pr_gen(), count)) has_next_spawned = false;
+	}
+	if (recorder.active()) recorder.stop_clock();
+	if (cacheable && size() == n) store_cached(n);
+	// deliver any partial batches such that observers see every particle of this generation
+	if (notifier.active()) notifier.flush(buffer);
+}
+
+template<std::size_t N>
+double DLA<N>::estimate_fractal_dimension() const {
+	if (aggregate_pq.empty()) return 0.0;
+	// radius which minimally bounds the aggregate in real space
+	return utl::estimate_fractal_dimension(size(), max_distance, attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& DLA<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	using utl::operator<<;
+	// sort by order particles were added to the aggregate
+	if (sort_by_gen_order) {
+		// std::vector container to store aggregate_map values
+		std::vector<std::pair<std::size_t, particle_type>> agg_vec;
+		agg_vec.reserve(size());	// pre-reserve space for performance
+		for (const auto& el : aggregate_map) {
+			if (el.second.epoch == epoch) agg_vec.push_back(std::make_pair(el.second.generation, el.first));
+		}
+		// sort agg_vec using a lambda based on order of particle generation
+		std::sort(agg_vec.begin(), agg_vec.end(), [](auto& lhs, auto& rhs) {return lhs.first < rhs.first; });
+		// write sorted data to stream
+		for (const auto& el : agg_vec) os << el.second << '\n';
+	}
+	// output aggregate data "as-is" without sorting
+	else {
+		for (const auto& el : aggregate_map) {
+			if (el.second.epoch == epoch) os << el.second.generation << '\t' << el.first << '\n';
+		}
+	}
+	return os;
+}
+
+template<std::size_t N>
+void DLA<N>::spawn_particle(particle_type& spawn_pos, int& spawn_diam) noexcept {
+	const int boundary_offset = 8;
+	// the attractor is a point above 3D: spawn on a random face of the bounding hypercube,
+	// set to double the distance of the furthest particle plus an offset as in 2D and 3D
+	spawn_diam = (aggregate_pq.empty() ? 0 : 2 * static_cast<int>(std::sqrt(utl::attractor_distance(aggregate_pq.top(),
+		attractor, attractor_size)))) + boundary_offset;
+	const std::size_t face = utl::step_index(pr_gen(), 2U*N);
+	std::array<int, N> site;
+	for (std::size_t i = 0U; i < N; ++i) site[i] = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+	site[face / 2U] = (face & 1U) ? -spawn_diam / 2 : spawn_diam / 2;
+	// confine spawns to the upper : lower half-space along the last axis for a single source
+	if (is_spawn_source_above != is_spawn_source_below)
+		site[N - 1U] = ((is_spawn_source_above) ? 1 : -1) * std::abs(site[N - 1U]);
+	spawn_pos = utl::make_lattice_point<N>(site);
+}
+
+template<>
+void DLA<2U>::spawn_particle(particle_type& spawn_pos, int& spawn_diam) noexcept {
+	const int boundary_offset = 8;
+	// generate random double in [0,1]
+	double placement_pr = pr_gen();
+	// set diameter of spawn zone to double the maximum of the largest distance co-ordinate
+	// pair currently in the aggregate structure plus an offset to avoid direct sticking spawns
+	switch (attractor) {
+	case attractor_type::POINT:
+		spawn_diam = (aggregate_pq.empty() ? 0 : 2 * static_cast<int>(std::hypot(aggregate_pq.top().first, aggregate_pq.top().second)))
+			+ boundary_offset;
+		if (is_spawn_source_above && is_spawn_source_below) {
+			if (placement_pr < 0.5) {	// spawn on upper or lower line of lattice boundary
+				spawn_pos.first = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				spawn_pos.second = (placement_pr < 0.25) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else {	// spawn on left/right line of lattice boundary
+				spawn_pos.first = (placement_pr < 0.75) ? spawn_diam / 2 : -spawn_diam / 2;
+				spawn_pos.second = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+		}
+		else {
+			if (placement_pr < 0.5) {	// spawn on upper : lower line of lattice boundary
+				spawn_pos.first = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				spawn_pos.second = (is_spawn_source_above) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else {	// spawn on left/right line of lattice boundary in upper : lower region
+				spawn_pos.first = (placement_pr < 0.75) ? spawn_diam / 2 : -spawn_diam / 2;
+				spawn_pos.second = ((is_spawn_source_above) ? 1 : -1) * static_cast<int>(spawn_diam*(pr_gen()*0.5));
+			}
+		}
+		break;
+	case attractor_type::LINE:
+		spawn_diam = (aggregate_pq.empty() ? 0 : std::abs(aggregate_pq.top().second)) + boundary_offset;
+		spawn_pos.first = periodic_axes() ? substrate_coordinate() : static_cast<int>(attractor_size*(pr_gen() - 0.5));
+		if (is_spawn_source_above && is_spawn_source_below)
+			spawn_pos.second = (placement_pr < 0.5) ? spawn_diam : -spawn_diam; // upper : lower
+		else
+			spawn_pos.second = (is_spawn_source_above) ? spawn_diam : -spawn_diam; // upper : lower
+		break;
+	case attractor_type::CIRCLE:
+		// bound the whole circle, which reaches beyond its radius in co-ordinates on a sheared or scaled lattice
+		spawn_diam = 2*std::max(attractor_radius, aggregate_pq.empty() ? 0 : static_cast<int>(std::sqrt(
+			utl::attractor_distance(aggregate_pq.top(), attractor, attractor_size)))) + boundary_offset;
+		if (is_spawn_source_above && is_spawn_source_below) {
+			if (placement_pr < 0.5) { // spawn at origin
+				spawn_pos.first = 0;
+				spawn_pos.second = 0;
+			}
+			else {	// spawn on bounding box boundary
+				if (placement_pr < 0.75) { // upper/lower
+					spawn_pos.first = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+					spawn_pos.second = (placement_pr < 0.625) ? spawn_diam / 2 : -spawn_diam / 2;
+				}
+				else { // left/right
+					spawn_pos.first = (placement_pr < 0.875) ? spawn_diam / 2 : -spawn_diam / 2;
+					spawn_pos.second = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				}
+			}
+		}
+		else if (is_spawn_source_above) { // spawn on bounding box boundary
+			if (placement_pr < 0.5) {	// spawn on upper or lower line of lattice boundary
+				spawn_pos.first = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				spawn_pos.second = (placement_pr < 0.25) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else {	// spawn on left/right line of lattice boundary
+				spawn_pos.first = (placement_pr < 0.75) ? spawn_diam / 2 : -spawn_diam / 2;
+				spawn_pos.second = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+		}
+		else if (is_spawn_source_below) { // spawn at origin
+			spawn_pos.first = 0;
+			spawn_pos.second = 0;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+template<>
+void DLA<3U>::spawn_particle(particle_type& current, int& spawn_diam) noexcept {
+	const int boundary_offset = 8;
+	// generate random double in [0,1]
+	double placement_pr = pr_gen();
+	// set diameter of spawn zone to double the maximum of the largest distance co-ordinate
+	// triple currently in the aggregate structure plus an offset to avoid direct sticking spawns
+	switch (attractor) {
+	case attractor_type::POINT:
+		spawn_diam = (aggregate_pq.empty() ? 0 : 2 * static_cast<int>(std::sqrt(
+			utl::attractor_distance(aggregate_pq.top(), attractor, attractor_size)))) + boundary_offset;
+		if (is_spawn_source_above && is_spawn_source_below) {
+			if (placement_pr < 1.0 / 3.0) {	// positive/negative z-plane of boundary
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = (placement_pr < 1.0 / 6.0) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else if (placement_pr >= 1.0 / 3.0 && placement_pr < 2.0 / 3.0) { // positive/negative x-plane of boundary
+				std::get<0>(current) = (placement_pr < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+			else {	// positive/negative y-plane of boundary
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = (placement_pr < 5.0 / 6.0) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+		}
+		else {
+			if (placement_pr < 1.0 / 3.0) { // positive/negative z-plane
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = (is_spawn_source_above) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else if (placement_pr >= 1.0 / 3.0 && placement_pr < 2.0 / 3.0) { // positive/negative x-plane of boundary
+				std::get<0>(current) = (placement_pr < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = ((is_spawn_source_above) ? 1 : -1) * static_cast<int>(spawn_diam*(pr_gen()*0.5));
+			}
+			else {	// positive/negative y-plane of boundary
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = (placement_pr < 5.0 / 6.0) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = ((is_spawn_source_above) ? 1 : -1) * static_cast<int>(spawn_diam*(pr_gen()*0.5));
+			}
+		}
+		break;
+	case attractor_type::LINE:
+		spawn_diam = (aggregate_pq.empty() ? 0 : 2*static_cast<int>(std::sqrt(
+			utl::attractor_distance(aggregate_pq.top(), attractor, attractor_size)))) + boundary_offset;
+		std::get<0>(current) = periodic_axes() ? substrate_coordinate() : static_cast<int>(attractor_size*(pr_gen() - 0.5));
+		if (is_spawn_source_above && is_spawn_source_below) {
+			if (placement_pr < 0.5) {	// positive/negative z-plane of boundary
+				std::get<1>(current) = (pr_gen() < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = (placement_pr < 0.25) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else {	// positive/negative y-plane of boundary
+				std::get<1>(current) = (placement_pr < 0.75) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = (pr_gen() < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+		}
+		else {
+			if (placement_pr < 0.5) { // positive/negative z-plane of boundary
+				std::get<1>(current) = (pr_gen() < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = (is_spawn_source_above) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else { // postive/negative y-plane of boundary
+				std::get<1>(current) = (placement_pr < 0.75) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = (is_spawn_source_above) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+		}
+		break;
+	case attractor_type::PLANE:
+		spawn_diam = (aggregate_pq.empty() ? 0 : std::abs(std::get<2>(aggregate_pq.top()))) + boundary_offset;
+		if (periodic_axes()) {	// uniformly over the sites of the substrate, which has no ends
+			std::get<0>(current) = substrate_coordinate();
+			std::get<1>(current) = substrate_coordinate();
+		}
+		else {
+			std::get<0>(current) = static_cast<int>(attractor_size*(pr_gen() - 0.5));
+			std::get<1>(current) = static_cast<int>(attractor_size*(pr_gen() - 0.5));
+		}
+		if (is_spawn_source_above && is_spawn_source_below)
+			std::get<2>(current) = (placement_pr < 0.5) ? spawn_diam : -spawn_diam; // positive : negative z-plane
+		else
+			std::get<2>(current) = (is_spawn_source_above) ? spawn_diam : -spawn_diam; // positive : negative z-plane
+		break;
+	case attractor_type::CIRCLE:
+		// bound the whole circle, which reaches beyond its radius in co-ordinates on a scaled lattice
+		spawn_diam = 2 * std::max(attractor_radius, aggregate_pq.empty() ? 0 : static_cast<int>(std::sqrt(
+			utl::attractor_distance(aggregate_pq.top(), attractor, attractor_size)))) + boundary_offset;
+		if (is_spawn_source_above && is_spawn_source_below) {
+			if (placement_pr < 0.5) {
+				std::get<0>(current) = 0;
+				std::get<1>(current) = 0;
+				std::get<2>(current) = 0;
+			}
+			else {
+				if (placement_pr < 2.0 / 3.0) {	// positive/negative z-plane of boundary
+					std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+					std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+					std::get<2>(current) = (placement_pr < 7.0 / 12.0) ? spawn_diam / 2 : -spawn_diam / 2;
+				}
+				else if (placement_pr >= 2.0 / 3.0 && placement_pr < 5.0 / 6.0) { // positive/negative x-plane of boundary
+					std::get<0>(current) = (placement_pr < 9.0/12.0) ? spawn_diam / 2 : -spawn_diam / 2;
+					std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+					std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				}
+				else {	// positive/negative y-plane of boundary
+					std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+					std::get<1>(current) = (placement_pr < 11.0 / 12.0) ? spawn_diam / 2 : -spawn_diam / 2;
+					std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				}
+			}
+		}
+		else if (is_spawn_source_above) {
+			if (placement_pr < 1.0 / 3.0) {	// positive/negative z-plane of boundary
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = (placement_pr < 1.0 / 6.0) ? spawn_diam / 2 : -spawn_diam / 2;
+			}
+			else if (placement_pr >= 1.0 / 3.0 && placement_pr < 2.0 / 3.0) { // positive/negative x-plane of boundary
+				std::get<0>(current) = (placement_pr < 0.5) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<1>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+			else {	// positive/negative y-plane of boundary
+				std::get<0>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+				std::get<1>(current) = (placement_pr < 5.0 / 6.0) ? spawn_diam / 2 : -spawn_diam / 2;
+				std::get<2>(current) = static_cast<int>(spawn_diam*(pr_gen() - 0.5));
+			}
+		}
+		break;
+	}
+}
+
+template<std::size_t N>
+void DLA<N>::update_particle_position(particle_type& current, const double& movement_choice) const noexcept {
+	// translate by the lattice step selected by movement_choice
+	translate(current, lattice_geometry->steps[utl::step_index(movement_choice, lattice_geometry->step_count)],
+		std::make_index_sequence<N>());
+}
+
+template<std::size_t N>
+bool DLA<N>::lattice_boundary_collision(particle_type& current, const particle_type& previous, const int& spawn_diam) const noexcept {
+	// small offset for correction on boundaries
+	const int epsilon = 2;
+	const int half_spawn = (spawn_diam / 2) + epsilon;
+	const int half_attractor = (static_cast<int>(attractor_size) / 2) + epsilon;
+	// a periodic substrate wraps walkers about its ends rather than bounding them
+	const std::size_t wrapped = periodic_axes();
+	if (wrapped) wrap(current, wrapped, static_cast<int>(attractor_size) / 2, std::make_index_sequence<N>());
+	const int bound_0 = (wrapped > 0U) ? std::numeric_limits<int>::max() : half_attractor;
+	const int bound_1 = (wrapped > 1U) ? std::numeric_limits<int>::max() : half_attractor;
+	bool outside = false;
+	// choose correct boundary collision detection based on type of attractor
+	switch (attractor) {
+	case attractor_type::POINT:
+		outside = is_outside(current, half_spawn, half_spawn, half_spawn, std::make_index_sequence<N>());
+		break;
+	case attractor_type::LINE:	// bounded by the attractor along it, by the spawn distance across it
+		outside = is_outside(current, bound_0, spawn_diam + epsilon, spawn_diam + epsilon, std::make_index_sequence<N>());
+		break;
+	case attractor_type::PLANE:
+		outside = is_outside(current, bound_0, bound_1, spawn_diam + epsilon, std::make_index_sequence<N>());
+		break;
+	case attractor_type::CIRCLE:
+		// cannot get outside circle attractor when spawned within it
+		if (is_spawn_source_above) outside = is_outside(current, half_spawn, half_spawn, half_spawn, std::make_index_sequence<N>());
+		break;
+	}
+	// reflect particle from boundary
+	if (outside) current = previous;
+	return outside;
+}
+
+template<std::size_t N>
+std::size_t DLA<N>::periodic_axes() const noexcept {
+	// a substrate of fewer than two sites has no period
+	if (!periodic_boundaries || attractor_size < 2U) return 0U;
+	return (attractor == attractor_type::LINE) ? 1U : (attractor == attractor_type::PLANE) ? 2U : 0U;
+}
+
+template<std::size_t N>
+int DLA<N>::substrate_coordinate() noexcept {
+	const int half = static_cast<int>(attractor_size) / 2;
+	return static_cast<int>(utl::step_index(pr_gen(), 2U*static_cast<std::size_t>(half))) - half;
+}
+
+template<std::size_t N>
+void DLA<N>::push_particle(const particle_type& p, std::size_t count) {
+	const auto site = aggregate_map.insert(std::make_pair(p, occupancy{ count, epoch }));
+	if (site.second) ++occupied_sites;
+	else if (site.first->second.epoch != epoch) {	// re-occupy site vacated by an earlier epoch
+		site.first->second = occupancy{ count, epoch };
+		++occupied_sites;
+	}
+	aggregate_pq.push(p);
+	buffer.push_back(p);
+	max_distance = std::max(max_distance, utl::real_space_distance(p, attractor, attractor_size, *lattice_geometry));
+	if (recorder.active()) recorder.accumulate(utl::cartesian_position(p, *lattice_geometry));
+	if (notifier.active()) notifier.on_push(buffer);
+}
+
+template<std::size_t N>
+bool DLA<N>::aggregate_collision(const particle_type& current, const particle_type& previous, const double& sticky_pr, std::size_t& count) {
+	// particle did not stick to aggregate, increment aggregate_misses counter
+	if (sticky_pr > coeff_stick) ++aggregate_misses_;
+	// else, if current co-ordinates of particle exist in aggregate
+	// or attractor then collision and successful sticking occurred
+	else {
+		auto agg_it = aggregate_map.find(current);
+		if (agg_it != aggregate_map.end() && agg_it->second.epoch != epoch) agg_it = aggregate_map.end();	// vacated site
+		if (agg_it == aggregate_map.end() && attractor_set.find(current) == attractor_set.end()) return false;
+		// record the particle stuck to (by buffer index), or none if stuck to the attractor
+		if (track_parents) parents.push_back((agg_it != aggregate_map.end()) ? agg_it->second.generation - 1U : utl::no_parent);
+		// insert previous position of particle to aggregrate_map and aggregrate priority queue
+		push_particle(previous, ++count);
+		update_aggregate_span();
+		if (recorder.due(count)) {
+			// linear distance from a 2D line or a plane, squared distance otherwise
+			const bool is_linear = attractor == ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE);
+			recorder.record(count, is_linear ? max_distance : std::sqrt(max_distance), aggregate_misses_, walk_steps);
+		}
+		return true;
+	}
+	return false;
+}
+
+template<std::size_t N>
+void DLA<N>::update_aggregate_span() noexcept {
+	const double circle_offset = (N == 2U && attractor == attractor_type::CIRCLE) ? static_cast<double>(attractor_size) : 0.0;
+	aggregate_span = (max_distance > circle_offset) ? static_cast<std::size_t>(max_distance - circle_offset) : 0U;
+}
+
+template<std::size_t N>
+void DLA<N>::measure_aggregate() noexcept {
+	max_distance = 0.0;
+	for (const auto& p : buffer) max_distance = std::max(max_distance, utl::real_space_distance(p, attractor, attractor_size, *lattice_geometry));
+	update_aggregate_span();
+}
+
+template<std::size_t N>
+bool DLA<N>::load_cached(std::size_t n) {
+	utl::aggregate_cache::entry e;
+	if (!cache->lookup(cache_key(static_cast<unsigned>(N), n), e)) return false;
+	std::size_t count = 0U;
+	std::array<int, N> site;
+	for (std::size_t i = 0U; i < e.count; ++i) {
+		std::copy(e.coordinates + N*i, e.coordinates + N*(i + 1U), site.begin());
+		push_particle(utl::make_lattice_point<N>(site), ++count);
+	}
+	update_aggregate_span();
+	aggregate_misses_ = static_cast<std::size_t>(e.misses);
+	walk_steps = e.steps;
+	// leave the generator as the original generation did, such that continued growth is identical
+	restore_generator_state(e.generator_state);
+	is_seed_fresh = false;
+	if (notifier.active()) notifier.flush(buffer);
+	return true;
+}
+
+namespace {
+	template<class Point, std::size_t... I>
+	void append_coordinates(std::vector<std::int32_t>& coordinates, const Point& p, std::index_sequence<I...>) {
+		int expand[] = { 0, (coordinates.push_back(std::get<I>(p)), 0)... };
+		(void)expand;
+	}
+}
+
+template<std::size_t N>
+void DLA<N>::store_cached(std::size_t n) const {
+	std::vector<std::int32_t> coordinates;
+	coordinates.reserve(N*buffer.size());
+	for (const auto& p : buffer) append_coordinates(coordinates, p, std::make_index_sequence<N>());
+	cache->store(cache_key(static_cast<unsigned>(N), n), coordinates.data(), buffer.size(), aggregate_misses_, walk_steps, generator_state());
+}
+
+template class DLA<2U>;
+template class DLA<3U>;
+template class DLA<4U>;
+template class DLA<5U>;
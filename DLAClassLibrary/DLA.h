@@ -0,0 +1,272 @@
+#pragma once
+#include "DLAContainer.h"
+#include "attachment_observer.h"
+#include "memory_resource.h"
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \class DLA
+ *
+ * \brief Defines a diffusion limited aggregate on an `N`-dimensional lattice.
+ *
+ * Provides a class which allows for the generation, manipulation and statistical processing
+ * of a Diffusion Limited Aggregate (DLA) on a lattice of any dimension from 2 to 5. The
+ * co-ordinates of a particle are of type `utl::lattice_point<N>::type`, i.e. `std::pair<int,int>`
+ * in 2D, `std::tuple<int,int,int>` in 3D and `std::array<std::int32_t,N>` above, and every
+ * loop over the dimensions of a particle is unrolled at compile time. The aggregate can be
+ * produced on a variety of lattice types, given by lattice_type enumerated constants, with a
+ * choice of different attractor geometries, given by attractor_type enumerated constants. Above
+ * 3D only the hypercubic lattice and point attractor are defined. With periodic boundaries a LINE
+ * or PLANE attractor has no ends, walkers being spawned uniformly over it and wrapped about it such
+ * that particles attach across the wrap, and the radius of gyration of growth samples is taken
+ * across the substrate only.
+ *
+ * Instantiated for N = 2 to 5 in DLA.cpp, `DLA_2d` and `DLA_3d` being aliases of `DLA<2>` and `DLA<3>`.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class DLA : public DLAContainer {
+	static_assert(N >= 2U && N <= utl::max_lattice_dimension, "dimension of DLA must be from 2 to 5.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::unordered_map<particle_type,
+		occupancy,
+		utl::tuple_hash,
+		std::equal_to<particle_type>,
+		utl::polymorphic_allocator<std::pair<const particle_type, occupancy>>> aggregate_unordered_map;
+	typedef std::unordered_set<particle_type,
+		utl::tuple_hash,
+		std::equal_to<particle_type>,
+		utl::polymorphic_allocator<particle_type>> attractor_unordered_set;
+	typedef std::vector<particle_type,
+		utl::polymorphic_allocator<particle_type>> aggregate_buffer_vector;
+	typedef utl::mutable_comp_priority_queue<particle_type,
+		aggregate_buffer_vector,
+		utl::distance_comparator> aggregate_priority_queue;
+public:
+	/**
+	 * \brief Default constructor, initialises empty aggregate with given stickiness coefficient.
+	 *
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \param _resource [= utl::new_delete_resource()] Memory resource of all internal containers, which
+	 *        must outlive this aggregate.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
+	 */
+	DLA(const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed(),
+		utl::memory_resource* _resource = utl::new_delete_resource());
+	/**
+	 * \brief Initialises empty aggregate with specified lattice and attractor types.
+	 *
+	 * \param _lattice_type Type of lattice for construction.
+	 * \param _attractor_type Type of attractor of initial aggregate.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \param _resource [= utl::new_delete_resource()] Memory resource of all internal containers, which
+	 *        must outlive this aggregate.
+	 * \throw Throws std::invalid_argument exception if the lattice or attractor type is not defined
+	 *        in `N` dimensions.
+	 */
+	DLA(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed(), utl::memory_resource* _resource = utl::new_delete_resource());
+	/**
+	 * \brief Copy constructor, copies contents of parameterised DLA to this. The copy
+	 *        allocates from `utl::new_delete_resource()`, not the memory resource of `other`.
+	 *
+	 * \param _other const reference to DLA instance.
+	 */
+	DLA(const DLA& other);
+	/**
+	 * \brief Move constructor, uses move-semantics for constructing a DLA
+	 *        from an rvalue reference of a DLA - leaving that container
+	 *        in a valid but unspecified state.
+	 *
+	 * \param _other rvalue reference to DLA instance
+	 */
+	DLA(DLA&& other) noexcept;
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~DLA() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing
+	 *        the particles of the aggregate structure in the order in which they were
+	 *        added.
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the memory resource from which the internal containers allocate.
+	 */
+	utl::memory_resource* get_memory_resource() const noexcept;
+	/**
+	 * \brief Registers an observer notified of particles as they attach to the aggregate, in
+	 *        batches of `batch_size` particles or once `interval` has elapsed since the last batch.
+	 *
+	 * The interval is checked only as particles attach, so a batch it holds back waits for the next
+	 * attachment or, failing that, for the remainder delivered when the generation ends. An exception
+	 * thrown by an observer on the dispatch thread is rethrown by the end of the generation or by
+	 * `remove_observer`.
+	 *
+	 * \param observer Observer to register.
+	 * \param batch_size [= 1] Number of particles per notification, zero to batch by time only.
+	 * \param interval [= 0] Maximum time between notifications, zero to batch by count only.
+	 * \param mode [= INLINE] Deliver on the generating thread or on a dispatch thread.
+	 */
+	void add_observer(std::shared_ptr<utl::attachment_observer<particle_type>> observer, std::size_t batch_size = 1U,
+		std::chrono::microseconds interval = std::chrono::microseconds::zero(), utl::dispatch_mode mode = utl::dispatch_mode::INLINE);
+	/**
+	 * \brief Unregisters an observer, waiting for any notifications already dispatched to it.
+	 *
+	 * \param observer Observer to unregister.
+	 * \throw Rethrows the first exception thrown by an observer on the dispatch thread since last rethrown.
+	 */
+	void remove_observer(const std::shared_ptr<utl::attachment_observer<particle_type>>& observer);
+	/**
+	 * \copydoc DLAContainer::set_lattice_type(lattice_type)
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is invalid in `N` dimensions,
+	 *        i.e. PLANE in 2D or anything but POINT above 3D.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \copydoc DLAContainer::initialise_attractor_structure()
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the diffusion limited aggregate until it consists of the parameterised
+	 *        number of particles, continuing from any existing aggregate.
+	 *
+	 * \param n Total number of particles in the DLA after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \copydoc DLAContainer::write(std::ostream&,bool)
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// map to store aggregate point co-ordinates as Keys and order of adding to the
+	// container as Values, stamped with the epoch in which the site was occupied
+	aggregate_unordered_map aggregate_map;
+	// set storing point co-ordinates of attractor
+	attractor_unordered_set attractor_set;
+	// priority queue for retrieving co-ordinates of aggregate
+	// particle furthest from origin in constant time
+	aggregate_priority_queue aggregate_pq;
+	// buffer vector holding co-ordinates of aggregate structure in
+	// order in which they were added
+	aggregate_buffer_vector buffer;
+	// batches attachment events to registered observers
+	utl::attachment_notifier<particle_type> notifier;
+	// largest co-ordinate distance of any attractor site from the origin, bounding the spawn zone about a CIRCLE
+	int attractor_radius = 0;
+	// largest distance of any particle from the attractor in real space, as given by utl::real_space_distance
+	double max_distance = 0.0;
+	/**
+	 * \brief Spawns a particle at a random position on the lattice boundary. Specialised for
+	 *        2D and 3D, which retain their original spawn geometries for every attractor.
+	 *
+	 * \param spawn_pos Position of spawn.
+	 * \param spawn_diam Diameter of spawn zone.
+	 */
+	void spawn_particle(particle_type& spawn_pos, int& spawn_diam) noexcept;
+	/**
+	 * \brief Updates position of random walking particle.
+	 *
+	 * \param current Current position, to be updated.
+	 * \param movement_choice Double in [0,1] for direction choice.
+	 */
+	void update_particle_position(particle_type& current, const double& movement_choice) const noexcept;
+	/**
+	 * \brief Checks for collision with boundary of lattice and reflects, wrapping the particle about the
+	 *        ends of a periodic substrate instead.
+	 *
+	 * \param current Current position, updated if collision occurred.
+	 * \param previous Previous position.
+	 * \param spawn_diam Current diameter of spawning box.
+	 */
+	bool lattice_boundary_collision(particle_type& current, const particle_type& previous, const int& spawn_diam) const noexcept;
+	/**
+	 * \brief Checks for collision of random-walking particle with aggregate structure
+	 *        and adds this particles' previous position to aggregate if collision occurred.
+	 *
+	 * \param current Current co-ordinates of particle.
+	 * \param previous Previous co-ordinates of particle.
+	 * \param sticky_pr |coeff_stick - _sticky_pr| = |1 - probability of sticking to aggregate|.
+	 * \param count Current number of particles generated in aggregate.
+	 */
+	bool aggregate_collision(const particle_type& current, const particle_type& previous, const double& sticky_pr, std::size_t& count);
+	/**
+	 * \brief Gets the number of leading axes along which the substrate is periodic, one for a LINE and two
+	 *        for a PLANE attractor with periodic boundaries, none otherwise.
+	 */
+	std::size_t periodic_axes() const noexcept;
+	/**
+	 * \brief Draws a co-ordinate along a periodic substrate uniformly from -att_size/2 to att_size/2 - 1.
+	 */
+	int substrate_coordinate() noexcept;
+	/**
+	 * \brief Pushes a particle into the aggregate, inserting the co-ordinates `p` into
+	 *        all necessary data structures used to contain the aggregate particles.
+	 *
+	 * \param p Co-ordinates of particle to insert.
+	 * \param count Index number of particle in aggregate.
+	 */
+	void push_particle(const particle_type& p, std::size_t count);
+	/**
+	 * \brief Updates the spanning distance of the aggregate from the real-space distance of its furthest particle.
+	 */
+	void update_aggregate_span() noexcept;
+	/**
+	 * \brief Measures the real-space distance of the furthest particle anew, e.g. upon changing the attractor
+	 *        or lattice, and updates the spanning distance.
+	 */
+	void measure_aggregate() noexcept;
+	/**
+	 * \brief Fills the empty aggregate with the cached aggregate of `n` particles, if present.
+	 *
+	 * \param n Number of particles.
+	 * \return true on a cache hit, false otherwise.
+	 */
+	bool load_cached(std::size_t n);
+	/**
+	 * \brief Stores the aggregate of `n` particles in the aggregate cache.
+	 *
+	 * \param n Number of particles.
+	 */
+	void store_cached(std::size_t n) const;
+};
+
+// the original spawn geometries of the 2D and 3D aggregates
+template<> void DLA<2U>::spawn_particle(particle_type& spawn_pos, int& spawn_diam) noexcept;
+template<> void DLA<3U>::spawn_particle(particle_type& spawn_pos, int& spawn_diam) noexcept;
+
+extern template class DLA<2U>;
+extern template class DLA<3U>;
+extern template class DLA<4U>;
+extern template class DLA<5U>;
@@ -3,6 +3,8 @@
 #include "DLAContainer.h"
 #include "DLA_2d.h"
 #include "DLA_3d.h"
+#include "octree_lod.h"
+#include "particle_mesh.h"
 #include <fstream>
 
 namespace DLAClassLibrary {
@@ -14,6 +16,9 @@ namespace DLAClassLibrary {
 	public enum class ManagedLatticeType {
 		Square,
 		Triangle,
+		Hexagonal, // 2D only
+		Fcc, // 3D only
+		Bcc, // 3D only
 	};
 	/**
 	 * \enum ManagedAttractorType
@@ -26,6 +31,20 @@ namespace DLAClassLibrary {
 		Plane,
 		Circle
 	};
+	/**
+	 * \struct ManagedLodNode
+	 *
+	 * \brief Aggregated contents of an octree cell of a 3D aggregate, to be drawn in place of the
+	 *        particles it contains.
+	 */
+	public value struct ManagedLodNode {
+		System::Int64 CornerX, CornerY, CornerZ;	// minimum lattice point covered by cell
+		System::Int64 Size;	// edge length of cell
+		System::UInt64 Count;	// number of particles within cell
+		double CentroidX, CentroidY, CentroidZ;	// mean position of particles within cell
+		double MeanGeneration;	// mean generation index of particles within cell
+		double Occupancy;	// fraction of lattice points of cell occupied
+	};
 	/**
 	 * \class ManagedDLA2DContainer
 	 *
@@ -40,6 +59,20 @@ namespace DLAClassLibrary {
 		DLA_2d* native_dla_2d_ptr;
 		// lock object used for critical section locking on ProcessBatchQueue()
 		System::Object^ lock_obj = gcnew System::Object();
+		// sphere template of rendering geometry, created upon first use
+		utl::instanced_mesh_builder* mesh_builder = nullptr;
+		// gets the sphere template shared by all rendering calls, tessellated upon first use
+		const utl::instanced_mesh_builder& MeshBuilder() {
+			System::Threading::Monitor::Enter(lock_obj);
+			try {
+				if (!mesh_builder) mesh_builder = new utl::instanced_mesh_builder();
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); }
+			return *mesh_builder;
+		}
+		static bool IsTooShort(array<float>^ values, std::size_t required) {
+			return values == nullptr || static_cast<std::size_t>(values->Length) < required;
+		}
 	public:
 		// CONSTRUCTION/ASSIGNMENT
 		/**
@@ -70,6 +103,17 @@ namespace DLAClassLibrary {
 		 */
 		ManagedDLA2DContainer(ManagedLatticeType ltt, ManagedAttractorType att, std::size_t att_size, double coeff_stick) : 
 			native_dla_2d_ptr(new DLA_2d(static_cast<lattice_type>(ltt), static_cast<attractor_type>(att), att_size, coeff_stick)) {}
+		/**
+		 * \brief Initialises a ManagedDLA2DContainer with given lattice and attractor types, a given stickiness
+		 *        coefficient and a given seed of its random number generator, and is initially empty.
+		 *
+		 * \param lattice_type Type of lattice aggregrate is to be built upon.
+		 * \param attractor_type Type of attractor for initial system seed.
+		 * \param coeff_stick Coefficient of stickiness of aggregrate, in interval (0,1].
+		 * \param seed Seed of random number generator, making generation reproducible.
+		 */
+		ManagedDLA2DContainer(ManagedLatticeType ltt, ManagedAttractorType att, std::size_t att_size, double coeff_stick, System::UInt64 seed) :
+			native_dla_2d_ptr(new DLA_2d(static_cast<lattice_type>(ltt), static_cast<attractor_type>(att), att_size, coeff_stick, seed)) {}
 		/**
 		 * \brief Copy constructor. Initialises a ManagedDLA2DContainer with a copy of the contents of `other`.
 		 *
@@ -79,7 +123,10 @@ namespace DLAClassLibrary {
 		/**
 		 * \brief Destructor, deletes native DLA class handle.
 		 */
-		~ManagedDLA2DContainer() { delete native_dla_2d_ptr; }
+		~ManagedDLA2DContainer() {
+			delete native_dla_2d_ptr;
+			delete mesh_builder;
+		}
 		// AGGREGATE PROPERTIES
 		/**
 		 * \brief Gets the coefficient of stickiness of the aggregate.
@@ -106,8 +153,17 @@ namespace DLAClassLibrary {
 		 * \brief Sets the type of lattice.
 		 *
 		 * \param lattice_type LatticeType to update to.
+		 * \throw Throws ArgumentException if the lattice type is not defined for 2D aggregates.
 		 */
-		void SetLatticeType(ManagedLatticeType ltt) { native_dla_2d_ptr->set_lattice_type(static_cast<lattice_type>(ltt)); }
+		void SetLatticeType(ManagedLatticeType ltt) {
+			try {
+				native_dla_2d_ptr->set_lattice_type(static_cast<lattice_type>(ltt));
+			}
+			catch (const std::invalid_argument& ex) {
+				System::String^ err_msg = gcnew System::String(ex.what());
+				throw gcnew System::ArgumentException(err_msg);
+			}
+		}
 		/**
 		 * \brief Sets the type of attractor.
 		 *
@@ -138,6 +194,18 @@ namespace DLAClassLibrary {
 		 * \return An estimate of fractal dimension of the DLA structure.
 		 */
 		double EstimateFractalDimension() { return native_dla_2d_ptr->estimate_fractal_dimension(); }
+		/**
+		 * \brief Gets the seed of the random number generator.
+		 *
+		 * \return Seed of generator.
+		 */
+		System::UInt64 GetSeed() { return native_dla_2d_ptr->get_seed(); }
+		/**
+		 * \brief Gets the stream of the random number generator.
+		 *
+		 * \return Stream of generator.
+		 */
+		System::UInt64 GetStream() { return native_dla_2d_ptr->get_stream(); }
 		// SIGNAL/EVENT FIRING
 		/**
 		 * \brief Raises an abort signal stopping any current execution of aggregate generation.
@@ -158,6 +226,13 @@ namespace DLAClassLibrary {
 		void SetRandomWalkParticleSpawnSource(System::Collections::Generic::KeyValuePair<bool, bool> above_below) {
 			native_dla_2d_ptr->set_random_walk_particle_spawn_source(std::make_pair(above_below.Key, above_below.Value));
 		}
+		/**
+		 * \brief Re-seeds the random number generator such that subsequent generation is reproducible.
+		 *
+		 * \param seed Seed of generator.
+		 * \param stream Stream of seed, distinct streams being independent.
+		 */
+		void SeedGenerator(System::UInt64 seed, System::UInt64 stream) { native_dla_2d_ptr->seed_generator(seed, stream); }
 		/**
 		 * \brief Clears the aggregrate of all particles.
 		 */
@@ -168,6 +243,18 @@ namespace DLAClassLibrary {
 		 * \param n Size of aggregrate to produce.
 		 */
 		void Generate(std::size_t n) { native_dla_2d_ptr->generate(n); }
+		/**
+		 * \brief Continues growth of the aggregrate until it has `n` particles, reusing existing state.
+		 *
+		 * \param n Total size of aggregrate after growth.
+		 */
+		void GrowTo(std::size_t n) { native_dla_2d_ptr->grow_to(n); }
+		/**
+		 * \brief Continues growth of the aggregrate by `k` further particles, reusing existing state.
+		 *
+		 * \param k Number of particles to add to the aggregrate.
+		 */
+		void GrowBy(std::size_t k) { native_dla_2d_ptr->grow_by(k); }
 		/**
 		 * \brief Fetches the buffer from the DLA_3d pointer and consumes the buffer data in-order, adding
 		 *        each particle from the buffer into a List of KVPs to be used by .NET code for rendering.
@@ -193,6 +280,87 @@ namespace DLAClassLibrary {
 			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
 			return buffer;
 		}
+		// RENDERING
+		/**
+		 * \brief Gets the number of floats required of each vertex array passed to `WriteBatchedMesh`
+		 *        for `count` particles.
+		 */
+		std::size_t BatchedMeshVertexFloats(std::size_t count) { return MeshBuilder().vertex_floats_required(count); }
+		/**
+		 * \brief Gets the number of indices required of the index array passed to `WriteBatchedMesh`
+		 *        for `count` particles.
+		 */
+		std::size_t BatchedMeshIndices(std::size_t count) { return MeshBuilder().indices_required(count); }
+		/**
+		 * \brief Writes particles [start, start + count) of the aggregate buffer as the per-instance data
+		 *        of a shared sphere, coloured by generation across the whole aggregate.
+		 *
+		 * \param offsets Destination of 3*count translation floats.
+		 * \param colours Destination of 3*count colour floats, or nullptr to skip colouring.
+		 * \param start Buffer index of first particle.
+		 * \param count Number of particles.
+		 * \throw Throws ArgumentOutOfRangeException if the range exceeds the aggregate buffer and
+		 *        ArgumentException if an array is too short.
+		 */
+		void WriteInstances(array<float>^ offsets, array<float>^ colours, std::size_t start, std::size_t count) {
+			if (IsTooShort(offsets, 3U*count) || (colours != nullptr && IsTooShort(colours, 3U*count)))
+				throw gcnew System::ArgumentException("array too short for particle range.");
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				const auto& buffer = native_dla_2d_ptr->aggregate_buffer();
+				if (start > buffer.size() || count > buffer.size() - start)
+					throw gcnew System::ArgumentOutOfRangeException("count", "particle range exceeds the aggregate buffer.");
+				if (!count) return;
+				pin_ptr<float> offsets_ptr = &offsets[0];
+				pin_ptr<float> colours_ptr;
+				if (colours != nullptr) colours_ptr = &colours[0];
+				MeshBuilder().write_instances(buffer.data() + start, buffer.data() + start + count, offsets_ptr, colours_ptr,
+					start + 1U, buffer.size());
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+		}
+		/**
+		 * \brief Writes particles [start, start + count) of the aggregate buffer as one batched mesh with a
+		 *        translated sphere per particle, coloured by generation across the whole aggregate.
+		 *
+		 * \param positions Destination of `BatchedMeshVertexFloats(count)` position floats.
+		 * \param normals Destination of `BatchedMeshVertexFloats(count)` normal floats, or nullptr to skip.
+		 * \param colours Destination of `BatchedMeshVertexFloats(count)` colour floats, or nullptr to skip.
+		 * \param indices Destination of `BatchedMeshIndices(count)` triangle indices.
+		 * \param start Buffer index of first particle.
+		 * \param count Number of particles.
+		 * \throw Throws ArgumentOutOfRangeException if the range exceeds the aggregate buffer and
+		 *        ArgumentException if an array is too short or the indices would not fit in 32 bits.
+		 */
+		void WriteBatchedMesh(array<float>^ positions, array<float>^ normals, array<float>^ colours,
+			array<System::UInt32>^ indices, std::size_t start, std::size_t count) {
+			const utl::instanced_mesh_builder& builder = MeshBuilder();
+			const std::size_t nfloats = builder.vertex_floats_required(count);
+			if (IsTooShort(positions, nfloats) || (normals != nullptr && IsTooShort(normals, nfloats))
+				|| (colours != nullptr && IsTooShort(colours, nfloats)) || indices == nullptr
+				|| static_cast<std::size_t>(indices->Length) < builder.indices_required(count))
+				throw gcnew System::ArgumentException("array too short for particle range.");
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				const auto& buffer = native_dla_2d_ptr->aggregate_buffer();
+				if (start > buffer.size() || count > buffer.size() - start)
+					throw gcnew System::ArgumentOutOfRangeException("count", "particle range exceeds the aggregate buffer.");
+				if (!count) return;
+				pin_ptr<float> positions_ptr = &positions[0];
+				pin_ptr<float> normals_ptr;
+				if (normals != nullptr) normals_ptr = &normals[0];
+				pin_ptr<float> colours_ptr;
+				if (colours != nullptr) colours_ptr = &colours[0];
+				pin_ptr<System::UInt32> indices_ptr = &indices[0];
+				builder.write_batched(buffer.data() + start, buffer.data() + start + count, positions_ptr, normals_ptr,
+					colours_ptr, indices_ptr, 0U, start + 1U, buffer.size());
+			}
+			catch (const std::length_error& ex) {
+				System::String^ err_msg = gcnew System::String(ex.what());
+				throw gcnew System::ArgumentException(err_msg);
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+		}
 	};
 
 	/**
@@ -208,6 +376,48 @@ namespace DLAClassLibrary {
 		// handle to DLAContainer abstract class
 		DLA_3d* native_dla_3d_ptr;
 		System::Object^ lock_obj = gcnew System::Object();
+		// sphere template of rendering geometry, created upon first use
+		utl::instanced_mesh_builder* mesh_builder = nullptr;
+		// level-of-detail index over the aggregate buffer, created upon first query
+		utl::octree_lod* lod_index = nullptr;
+		// gets the sphere template shared by all rendering calls, tessellated upon first use
+		const utl::instanced_mesh_builder& MeshBuilder() {
+			System::Threading::Monitor::Enter(lock_obj);
+			try {
+				if (!mesh_builder) mesh_builder = new utl::instanced_mesh_builder();
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); }
+			return *mesh_builder;
+		}
+		static bool IsTooShort(array<float>^ values, std::size_t required) {
+			return values == nullptr || static_cast<std::size_t>(values->Length) < required;
+		}
+		// brings the level-of-detail index up to date with the aggregate buffer, whilst holding lock_obj
+		void UpdateLevelOfDetail() {
+			const auto& buffer = native_dla_3d_ptr->aggregate_buffer();
+			if (!lod_index) lod_index = new utl::octree_lod();
+			// aggregate cleared since last query
+			if (buffer.size() < lod_index->size()) lod_index->clear();
+			for (std::size_t i = lod_index->size(); i < buffer.size(); ++i) lod_index->insert(buffer[i], i + 1U);
+		}
+		static System::Collections::Generic::List<ManagedLodNode>^ ToManagedNodes(const std::vector<utl::lod_node>& nodes) {
+			System::Collections::Generic::List<ManagedLodNode>^ out = gcnew System::Collections::Generic::List<ManagedLodNode>(static_cast<int>(nodes.size()));
+			for (const auto& n : nodes) {
+				ManagedLodNode node;
+				node.CornerX = n.corner[0];
+				node.CornerY = n.corner[1];
+				node.CornerZ = n.corner[2];
+				node.Size = n.size;
+				node.Count = n.count;
+				node.CentroidX = n.centroid[0];
+				node.CentroidY = n.centroid[1];
+				node.CentroidZ = n.centroid[2];
+				node.MeanGeneration = n.mean_generation;
+				node.Occupancy = n.occupancy;
+				out->Add(node);
+			}
+			return out;
+		}
 	public:
 		// CONSTRUCTION/ASSIGNMENT
 		/**
@@ -238,6 +448,17 @@ namespace DLAClassLibrary {
 		 */
 		ManagedDLA3DContainer(ManagedLatticeType ltt, ManagedAttractorType att, std::size_t att_size, double coeff_stick) : 
 			native_dla_3d_ptr(new DLA_3d(static_cast<lattice_type>(ltt), static_cast<attractor_type>(att), att_size, coeff_stick)) {}
+		/**
+		 * \brief Initialises a ManagedDLA3DContainer with given lattice and attractor types, a given stickiness
+		 *        coefficient and a given seed of its random number generator, and is initially empty.
+		 *
+		 * \param lattice_type Type of lattice aggregrate is to be built upon.
+		 * \param attractor_type Type of attractor for initial system seed.
+		 * \param coeff_stick Coefficient of stickiness of aggregrate, in interval (0,1].
+		 * \param seed Seed of random number generator, making generation reproducible.
+		 */
+		ManagedDLA3DContainer(ManagedLatticeType ltt, ManagedAttractorType att, std::size_t att_size, double coeff_stick, System::UInt64 seed) :
+			native_dla_3d_ptr(new DLA_3d(static_cast<lattice_type>(ltt), static_cast<attractor_type>(att), att_size, coeff_stick, seed)) {}
 		/**
 		 * \brief Copy constructor. Initialises a `ManagedDLA3DContainer` with a copy of the contents of `other`.
 		 *
@@ -247,7 +468,11 @@ namespace DLAClassLibrary {
 		/**
 		 * \brief Destructor, deletes native DLA class handle.
 		 */
-		~ManagedDLA3DContainer() { delete native_dla_3d_ptr; }
+		~ManagedDLA3DContainer() {
+			delete native_dla_3d_ptr;
+			delete mesh_builder;
+			delete lod_index;
+		}
 		// AGGREGATE PROPERTIES
 		/**
 		 * \brief Gets the coefficient of stickiness of the aggregate.
@@ -274,8 +499,17 @@ namespace DLAClassLibrary {
 		 * \brief Sets the type of lattice.
 		 *
 		 * \param lattice_type LatticeType to update to.
+		 * \throw Throws ArgumentException if the lattice type is not defined for 3D aggregates.
 		 */
-		void SetLatticeType(ManagedLatticeType ltt) { native_dla_3d_ptr->set_lattice_type(static_cast<lattice_type>(ltt)); }
+		void SetLatticeType(ManagedLatticeType ltt) {
+			try {
+				native_dla_3d_ptr->set_lattice_type(static_cast<lattice_type>(ltt));
+			}
+			catch (const std::invalid_argument& ex) {
+				System::String^ err_msg = gcnew System::String(ex.what());
+				throw gcnew System::ArgumentException(err_msg);
+			}
+		}
 		/**
 		 * \brief Sets the type of attractor.
 		 *
@@ -306,6 +540,18 @@ namespace DLAClassLibrary {
 		 * \return An estimate of fractal dimension of the DLA structure.
 		 */
 		double EstimateFractalDimension() { return native_dla_3d_ptr->estimate_fractal_dimension(); }
+		/**
+		 * \brief Gets the seed of the random number generator.
+		 *
+		 * \return Seed of generator.
+		 */
+		System::UInt64 GetSeed() { return native_dla_3d_ptr->get_seed(); }
+		/**
+		 * \brief Gets the stream of the random number generator.
+		 *
+		 * \return Stream of generator.
+		 */
+		System::UInt64 GetStream() { return native_dla_3d_ptr->get_stream(); }
 		// SIGNAL/EVENT FIRING
 		/**
 		 * \brief Raises an abort signal stopping any current execution of aggregate generation.
@@ -326,6 +572,13 @@ namespace DLAClassLibrary {
 		void SetRandomWalkParticleSpawnSource(System::Collections::Generic::KeyValuePair<bool, bool> above_below) {
 			native_dla_3d_ptr->set_random_walk_particle_spawn_source(std::make_pair(above_below.Key, above_below.Value));
 		}
+		/**
+		 * \brief Re-seeds the random number generator such that subsequent generation is reproducible.
+		 *
+		 * \param seed Seed of generator.
+		 * \param stream Stream of seed, distinct streams being independent.
+		 */
+		void SeedGenerator(System::UInt64 seed, System::UInt64 stream) { native_dla_3d_ptr->seed_generator(seed, stream); }
 		/**
 		 * \brief Clears the aggregrate of all particles.
 		 */
@@ -336,6 +589,18 @@ namespace DLAClassLibrary {
 		 * \param n Size of aggregrate to produce.
 		 */
 		void Generate(std::size_t n) { native_dla_3d_ptr->generate(n); }
+		/**
+		 * \brief Continues growth of the aggregrate until it has `n` particles, reusing existing state.
+		 *
+		 * \param n Total size of aggregrate after growth.
+		 */
+		void GrowTo(std::size_t n) { native_dla_3d_ptr->grow_to(n); }
+		/**
+		 * \brief Continues growth of the aggregrate by `k` further particles, reusing existing state.
+		 *
+		 * \param k Number of particles to add to the aggregrate.
+		 */
+		void GrowBy(std::size_t k) { native_dla_3d_ptr->grow_by(k); }
 		/**
 		 * \brief Fetches the buffer from the DLA_3d pointer and consumes the buffer data in-order, adding
 		 *        each particle from the buffer into a List of Tuples to be used by .NET code for rendering.
@@ -361,6 +626,136 @@ namespace DLAClassLibrary {
 			}
 			finally { System::Threading::Monitor::Exit(lock_obj); }	// exit critical section by releasing exclusive lock
 			return buffer;
+		}		// RENDERING
+		/**
+		 * \brief Gets the number of floats required of each vertex array passed to `WriteBatchedMesh`
+		 *        for `count` particles.
+		 */
+		std::size_t BatchedMeshVertexFloats(std::size_t count) { return MeshBuilder().vertex_floats_required(count); }
+		/**
+		 * \brief Gets the number of indices required of the index array passed to `WriteBatchedMesh`
+		 *        for `count` particles.
+		 */
+		std::size_t BatchedMeshIndices(std::size_t count) { return MeshBuilder().indices_required(count); }
+		/**
+		 * \brief Writes particles [start, start + count) of the aggregate buffer as the per-instance data
+		 *        of a shared sphere, coloured by generation across the whole aggregate.
+		 *
+		 * \param offsets Destination of 3*count translation floats.
+		 * \param colours Destination of 3*count colour floats, or nullptr to skip colouring.
+		 * \param start Buffer index of first particle.
+		 * \param count Number of particles.
+		 * \throw Throws ArgumentOutOfRangeException if the range exceeds the aggregate buffer and
+		 *        ArgumentException if an array is too short.
+		 */
+		void WriteInstances(array<float>^ offsets, array<float>^ colours, std::size_t start, std::size_t count) {
+			if (IsTooShort(offsets, 3U*count) || (colours != nullptr && IsTooShort(colours, 3U*count)))
+				throw gcnew System::ArgumentException("array too short for particle range.");
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				const auto& buffer = native_dla_3d_ptr->aggregate_buffer();
+				if (start > buffer.size() || count > buffer.size() - start)
+					throw gcnew System::ArgumentOutOfRangeException("count", "particle range exceeds the aggregate buffer.");
+				if (!count) return;
+				pin_ptr<float> offsets_ptr = &offsets[0];
+				pin_ptr<float> colours_ptr;
+				if (colours != nullptr) colours_ptr = &colours[0];
+				MeshBuilder().write_instances(buffer.data() + start, buffer.data() + start + count, offsets_ptr, colours_ptr,
+					start + 1U, buffer.size());
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+		}
+		/**
+		 * \brief Writes particles [start, start + count) of the aggregate buffer as one batched mesh with a
+		 *        translated sphere per particle, coloured by generation across the whole aggregate.
+		 *
+		 * \param positions Destination of `BatchedMeshVertexFloats(count)` position floats.
+		 * \param normals Destination of `BatchedMeshVertexFloats(count)` normal floats, or nullptr to skip.
+		 * \param colours Destination of `BatchedMeshVertexFloats(count)` colour floats, or nullptr to skip.
+		 * \param indices Destination of `BatchedMeshIndices(count)` triangle indices.
+		 * \param start Buffer index of first particle.
+		 * \param count Number of particles.
+		 * \throw Throws ArgumentOutOfRangeException if the range exceeds the aggregate buffer and
+		 *        ArgumentException if an array is too short or the indices would not fit in 32 bits.
+		 */
+		void WriteBatchedMesh(array<float>^ positions, array<float>^ normals, array<float>^ colours,
+			array<System::UInt32>^ indices, std::size_t start, std::size_t count) {
+			const utl::instanced_mesh_builder& builder = MeshBuilder();
+			const std::size_t nfloats = builder.vertex_floats_required(count);
+			if (IsTooShort(positions, nfloats) || (normals != nullptr && IsTooShort(normals, nfloats))
+				|| (colours != nullptr && IsTooShort(colours, nfloats)) || indices == nullptr
+				|| static_cast<std::size_t>(indices->Length) < builder.indices_required(count))
+				throw gcnew System::ArgumentException("array too short for particle range.");
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				const auto& buffer = native_dla_3d_ptr->aggregate_buffer();
+				if (start > buffer.size() || count > buffer.size() - start)
+					throw gcnew System::ArgumentOutOfRangeException("count", "particle range exceeds the aggregate buffer.");
+				if (!count) return;
+				pin_ptr<float> positions_ptr = &positions[0];
+				pin_ptr<float> normals_ptr;
+				if (normals != nullptr) normals_ptr = &normals[0];
+				pin_ptr<float> colours_ptr;
+				if (colours != nullptr) colours_ptr = &colours[0];
+				pin_ptr<System::UInt32> indices_ptr = &indices[0];
+				builder.write_batched(buffer.data() + start, buffer.data() + start + count, positions_ptr, normals_ptr,
+					colours_ptr, indices_ptr, 0U, start + 1U, buffer.size());
+			}
+			catch (const std::length_error& ex) {
+				System::String^ err_msg = gcnew System::String(ex.what());
+				throw gcnew System::ArgumentException(err_msg);
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+		}
+		/**
+		 * \brief Selects the octree nodes to draw for a view of the aggregate, such that each drawn node spans at
+		 *        most `pixel_error` pixels on screen (or is a leaf) and intersects the view frustum. The index is
+		 *        brought up to date with the aggregate buffer first.
+		 *
+		 * \param planes Six frustum planes (a,b,c,d) with inward facing normals as 24 doubles, a point being
+		 *        inside when ax+by+cz+d >= 0, planes with zero normal being ignored.
+		 * \param eye Position of camera as 3 doubles.
+		 * \param pixels_per_unit Pixels spanned by a unit length at unit distance, or at any distance if orthographic.
+		 * \param orthographic Whether the projection is orthographic.
+		 * \param pixel_error Maximum projected edge length, in pixels, of a drawn node.
+		 * \return List of nodes to draw.
+		 * \throw Throws ArgumentException if planes or eye are too short.
+		 */
+		System::Collections::Generic::List<ManagedLodNode>^ QueryLevelOfDetail(array<double>^ planes, array<double>^ eye,
+			double pixels_per_unit, bool orthographic, double pixel_error) {
+			if (planes == nullptr || planes->Length < 24 || eye == nullptr || eye->Length < 3)
+				throw gcnew System::ArgumentException("view frustum requires 24 plane and 3 eye co-ordinates.");
+			utl::view_frustum frustum;
+			for (std::size_t i = 0U; i < 6U; ++i)
+				for (std::size_t j = 0U; j < 4U; ++j) frustum.planes[i][j] = planes[static_cast<int>(4U*i + j)];
+			for (std::size_t k = 0U; k < 3U; ++k) frustum.eye[k] = eye[static_cast<int>(k)];
+			frustum.pixels_per_unit = pixels_per_unit;
+			frustum.orthographic = orthographic;
+			std::vector<utl::lod_node> nodes;
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				UpdateLevelOfDetail();
+				lod_index->query(frustum, pixel_error, nodes);
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+			return ToManagedNodes(nodes);
+		}
+		/**
+		 * \brief Collects all non-empty octree nodes of edge length `size`, independent of any view. The index is
+		 *        brought up to date with the aggregate buffer first.
+		 *
+		 * \param size Edge length of nodes to collect, clamped to [leaf size, root size].
+		 * \return List of nodes.
+		 */
+		System::Collections::Generic::List<ManagedLodNode>^ LevelOfDetailNodesOfSize(System::Int64 size) {
+			std::vector<utl::lod_node> nodes;
+			System::Threading::Monitor::Enter(lock_obj);	// define critical section start
+			try {	// execute critical section
+				UpdateLevelOfDetail();
+				lod_index->nodes_of_size(size, nodes);
+			}
+			finally { System::Threading::Monitor::Exit(lock_obj); } // exit critical section by releasing exclusive lock
+			return ToManagedNodes(nodes);
 		}
 	};
 }
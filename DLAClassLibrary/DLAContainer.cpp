@@ -1,19 +1,30 @@
 #include "Stdafx.h"
 #include "DLAContainer.h"
+#include <sstream>
 
-DLAContainer::DLAContainer(const double& _coeff_stick) 
-	: lattice(lattice_type::SQUARE), attractor(attractor_type::POINT), pr_gen(), attractor_size(1U) { set_coeff_stick(_coeff_stick); }
+DLAContainer::DLAContainer(const double& _coeff_stick, std::uint64_t _seed) 
+	: lattice(lattice_type::SQUARE), attractor(attractor_type::POINT), pr_gen(utl::philox4x32(_seed)), seed(_seed),
+	attractor_size(1U) { set_coeff_stick(_coeff_stick); }
 
-DLAContainer::DLAContainer(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick) 
-	: lattice(ltt), attractor(att), pr_gen(), attractor_size(att_size) { set_coeff_stick(_coeff_stick); }
+DLAContainer::DLAContainer(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick, std::uint64_t _seed) 
+	: lattice(ltt), attractor(att), pr_gen(utl::philox4x32(_seed)), seed(_seed), attractor_size(att_size) { set_coeff_stick(_coeff_stick); }
 
-DLAContainer::DLAContainer(const DLAContainer& other) noexcept
-	: lattice(other.lattice), attractor(other.attractor),
-		coeff_stick(other.coeff_stick), pr_gen(other.pr_gen), attractor_size(other.attractor_size) {}
+DLAContainer::DLAContainer(const DLAContainer& other)
+	: lattice(other.lattice), lattice_geometry(other.lattice_geometry), attractor(other.attractor),
+		coeff_stick(other.coeff_stick), pr_gen(other.pr_gen), track_parents(other.track_parents), parents(other.parents),
+		recorder(other.recorder), walk_steps(other.walk_steps), cache(other.cache), seed(other.seed), stream(other.stream),
+		is_seed_fresh(other.is_seed_fresh), reuse_storage(other.reuse_storage), epoch(other.epoch), occupied_sites(other.occupied_sites),
+		attractor_size(other.attractor_size), periodic_boundaries(other.periodic_boundaries),
+		is_attractor_initialised(other.is_attractor_initialised) {}
 
 DLAContainer::DLAContainer(DLAContainer&& other) noexcept
-	: lattice(std::move(other.lattice)), attractor(std::move(other.attractor)),
-	coeff_stick(std::move(other.coeff_stick)), pr_gen(std::move(other.pr_gen)), attractor_size(std::move(other.attractor_size)) {}
+	: lattice(std::move(other.lattice)), lattice_geometry(other.lattice_geometry), attractor(std::move(other.attractor)),
+	coeff_stick(std::move(other.coeff_stick)), pr_gen(std::move(other.pr_gen)), abort_signal(std::move(other.abort_signal)),
+	continuous(std::move(other.continuous)), track_parents(other.track_parents),
+	parents(std::move(other.parents)), recorder(std::move(other.recorder)), walk_steps(other.walk_steps),
+	cache(std::move(other.cache)), seed(other.seed), stream(other.stream), is_seed_fresh(other.is_seed_fresh), reuse_storage(other.reuse_storage),
+	epoch(other.epoch), occupied_sites(other.occupied_sites), attractor_size(std::move(other.attractor_size)),
+	periodic_boundaries(other.periodic_boundaries), is_attractor_initialised(other.is_attractor_initialised) {}
 
 double DLAContainer::get_coeff_stick() const noexcept {
 	return coeff_stick;
@@ -30,7 +41,7 @@ lattice_type DLAContainer::get_lattice_type() const noexcept {
 	return lattice;
 }
 
-void DLAContainer::set_lattice_type(lattice_type ltt) noexcept {
+void DLAContainer::set_lattice_type(lattice_type ltt) {
 	lattice = ltt;
 }
 
@@ -39,6 +50,7 @@ std::pair<attractor_type, std::size_t> DLAContainer::get_attractor_type() const
 }
 
 void DLAContainer::set_attractor_type(attractor_type att, std::size_t att_size) {
+	if (att != attractor || att_size != attractor_size) is_attractor_initialised = false;
 	attractor = att;
 	attractor_size = att_size;
 }
@@ -51,12 +63,103 @@ std::size_t DLAContainer::aggregate_misses() const noexcept {
 	return aggregate_misses_;
 }
 
+void DLAContainer::set_parent_tracking(bool _track) {
+	if (_track && !track_parents && size()) throw std::logic_error("cannot enable parent tracking on a non-empty aggregate.");
+	track_parents = _track;
+	if (!track_parents) {
+		parents.clear();
+		parents.shrink_to_fit();
+	}
+}
+
+bool DLAContainer::is_parent_tracking() const noexcept {
+	return track_parents;
+}
+
+const std::vector<std::size_t>& DLAContainer::parent_indices() const noexcept {
+	return parents;
+}
+
+utl::tree_topology DLAContainer::analyse_tree_topology() const {
+	if (!track_parents || parents.size() != size()) throw std::logic_error("parent tracking not enabled for whole aggregate.");
+	return utl::analyse_tree_topology(parents);
+}
+
+void DLAContainer::set_growth_recording(bool _record, std::size_t samples_per_decade) {
+	if (_record && !recorder.active() && size()) throw std::logic_error("cannot enable growth recording on a non-empty aggregate.");
+	if (_record) recorder.enable(samples_per_decade);
+	else recorder.disable();
+}
+
+bool DLAContainer::is_growth_recording() const noexcept {
+	return recorder.active();
+}
+
+const std::vector<utl::growth_sample>& DLAContainer::growth_series() const noexcept {
+	return recorder.samples();
+}
+
+std::ostream& DLAContainer::write_growth_series(std::ostream& os) const {
+	return recorder.write(os);
+}
+
+std::uint64_t DLAContainer::random_walk_steps() const noexcept {
+	return walk_steps;
+}
+
+void DLAContainer::set_aggregate_cache(std::shared_ptr<utl::aggregate_cache> _cache) noexcept {
+	cache = std::move(_cache);
+}
+
+const std::shared_ptr<utl::aggregate_cache>& DLAContainer::get_aggregate_cache() const noexcept {
+	return cache;
+}
+
+void DLAContainer::set_storage_reuse(bool _reuse) noexcept {
+	reuse_storage = _reuse;
+}
+
+bool DLAContainer::is_storage_reused() const noexcept {
+	return reuse_storage;
+}
+
+bool DLAContainer::advance_epoch(std::size_t site_count, std::size_t capacity) noexcept {
+	// purge on wrap-around as sites stamped long ago would otherwise become occupied again
+	return ++epoch == 0U || site_count > max_stale_sites_ratio*capacity;
+}
+
+void DLAContainer::seed_generator(std::uint64_t _seed, std::uint64_t _stream, std::uint64_t _offset) {
+	utl::philox4x32 engine(_seed, _stream);
+	engine.discard(_offset);
+	pr_gen = utl::uniform_random_probability_generator<double, utl::philox4x32>(std::move(engine));
+	seed = _seed;
+	stream = _stream;
+	// the aggregate cache holds generations from the start of a stream only
+	is_seed_fresh = !_offset;
+}
+
+std::uint64_t DLAContainer::get_seed() const noexcept {
+	return seed;
+}
+
+std::uint64_t DLAContainer::get_stream() const noexcept {
+	return stream;
+}
+
+std::uint64_t DLAContainer::get_generator_offset() const noexcept {
+	return pr_gen.get_generator().offset();
+}
+
 void DLAContainer::raise_abort_signal() noexcept {
-	abort_signal = true;
+	abort_signal.raise();
+}
+
+void DLAContainer::reset_abort_signal() noexcept {
+	abort_signal.lower();
 }
 
 void DLAContainer::change_continuous_flag(bool _continuous) noexcept {
-	continuous = _continuous;
+	continuous.set(_continuous);
 }
 
 void DLAContainer::set_random_walk_particle_spawn_source(const std::pair<bool, bool>& above_below) {
@@ -65,164 +168,60 @@ void DLAContainer::set_random_walk_particle_spawn_source(const std::pair<bool, b
 	is_spawn_source_below = above_below.second;
 }
 
+void DLAContainer::set_periodic_boundaries(bool _periodic) {
+	// particles placed beyond the ends of the substrate under reflecting walls have no periodic image
+	if (_periodic != periodic_boundaries && size()) throw std::logic_error("cannot change boundaries of a non-empty aggregate.");
+	periodic_boundaries = _periodic;
+}
+
+bool DLAContainer::has_periodic_boundaries() const noexcept {
+	return periodic_boundaries;
+}
+
 void DLAContainer::clear() {
 	aggregate_misses_ = 0U;
 	aggregate_span = 0U;
+	parents.clear();
+	if (!reuse_storage) parents.shrink_to_fit();
+	recorder.reset();
+	occupied_sites = 0U;
+	walk_steps = 0U;
 	pr_gen.reset_distribution_state();	// reset prng distribution state such that next generated values independent
 }
 
-void DLAContainer::update_particle_position(std::pair<int,int>& current, const double& movement_choice) noexcept {
-	// perform different translations dependent upon type of lattice
-	switch (lattice) {
-	case lattice_type::SQUARE:
-		// translate (+1,0) or (-1,0)
-		if (movement_choice < 0.5) (movement_choice < 0.25) ? ++current.first : --current.first;
-		// translate (0,+1) or (0,-1)
-		else (movement_choice < 0.75) ? ++current.second : --current.second;
-		break;
-	case lattice_type::TRIANGLE:
-		// translate (+1,0) or (-1,0)
-		if (movement_choice < 1.0 / 5.0) (movement_choice < 1.0 / 10.0) ? ++current.first : --current.first;
-		// translate (+1,+1)
-		else if (movement_choice >= 1.0 / 5.0 && movement_choice < 2.0 / 5.0) {
-			++current.first;
-			++current.second;
-		}
-		// translate (+1,-1)
-		else if (movement_choice >= 2.0 / 5.0 && movement_choice < 3.0 / 5.0) {
-			++current.first;
-			--current.second;
-		}
-		// translate (-1,+1)
-		else if (movement_choice >= 3.0 / 5.0 && movement_choice < 4.0 / 5.0) {
-			--current.first;
-			++current.second;
-		}
-		// translate (-1,-1)
-		else {
-			--current.first;
-			--current.second;
-		}
-		break;
-	}
+void DLAContainer::generate(std::size_t n) {
+	grow_to(n);
 }
 
-void DLAContainer::update_particle_position(std::tuple<int,int,int>& current, const double& movement_choice) noexcept {
-	// perform different translations dependent upon type of lattice
-	switch (lattice) {
-	case lattice_type::SQUARE:
-		// translate (+1,0,0) or (-1,0,0)
-		if (movement_choice < 1.0 / 3.0) (movement_choice < 1.0/6.0) ? ++std::get<0>(current) : --std::get<0>(current);
-		// translate (0,+1,0) or (0,-1,0)
-		else if (movement_choice >= 1.0 / 3.0 && movement_choice < 2.0 / 3.0) (movement_choice < 0.5) ? ++std::get<1>(current) : --std::get<1>(current);
-		// translate (0,0,+1) or (0,0,-1)
-		else (movement_choice < 5.0/6.0) ? ++std::get<2>(current) : --std::get<2>(current);
-		break;
-	case lattice_type::TRIANGLE:
-		// translate (+1,0,0) or (-1,0,0)
-		if (movement_choice < 1.0 / 6.0) (movement_choice < 1.0/12.0) ? ++std::get<0>(current) : --std::get<0>(current);
-		// translate (+1,+1,0)
-		else if (movement_choice >= 1.0 / 6.0 && movement_choice < 2.0 / 6.0) {
-			++std::get<0>(current);
-			++std::get<1>(current);
-		}
-		// translate (+1,-1,0)
-		else if (movement_choice >= 2.0 / 6.0 && movement_choice < 3.0 / 6.0) {
-			++std::get<0>(current);
-			--std::get<1>(current);
-		}
-		// translate (-1,+1,0)
-		else if (movement_choice >= 3.0 / 6.0 && movement_choice < 4.0 / 6.0) {
-			--std::get<0>(current);
-			++std::get<1>(current);
-		}
-		// translate (-1,-1,0)
-		else if (movement_choice >= 4.0 / 6.0 && movement_choice < 5.0 / 6.0) {
-			--std::get<0>(current);
-			--std::get<1>(current);
-		}
-		// translate (0,0,+1) or (0,0,-1)
-		else (movement_choice < 11.0/12.0) ? ++std::get<2>(current) : --std::get<2>(current);
-		break;
-	}
+void DLAContainer::grow_by(std::size_t k) {
+	grow_to(size() + k);
 }
 
-bool DLAContainer::lattice_boundary_collision(std::pair<int,int>& current, const std::pair<int,int>& previous, const int& spawn_diam) const noexcept {
-	// small offset for correction on boundaries
-	const int epsilon = 2;
-	// choose correct boundary collision detection based on type of attractor
-	switch (attractor) {
-	case attractor_type::POINT:
-		// reflect particle from boundary
-		if (std::abs(current.first) > ((spawn_diam / 2) + epsilon) || std::abs(current.second) > ((spawn_diam / 2) + epsilon)) {
-			current = previous;
-			return true;
-		}
-		break;
-	case attractor_type::LINE:
-		if (std::abs(current.first) > ((static_cast<int>(attractor_size) / 2) + epsilon) || std::abs(current.second) > (spawn_diam + epsilon)) {
-			current = previous;
-			return true;
-		}
-		break;
-	case attractor_type::CIRCLE:
-		if (is_spawn_source_above) {
-			if (std::abs(current.first) > ((spawn_diam / 2) + epsilon) || std::abs(current.second) > ((spawn_diam / 2) + epsilon)) {
-				current = previous;
-				return true;
-			}
-		}
-		else {
-			// do nothing, cannot get outside circle attractor
-		}
-		break;
-	}
-	return false;
-}
-
-bool DLAContainer::lattice_boundary_collision(std::tuple<int,int,int>& current, const std::tuple<int,int,int>& previous, const int& spawn_diam) const noexcept {
-	// small offset for correction on boundaries
-	const int epsilon = 2;
-	// choose correct boundary collision detection based on type of attractor
-	switch (attractor) {
-	case attractor_type::POINT:
-		// reflect particle from boundary
-		if (std::abs(std::get<0>(current)) > ((spawn_diam / 2) + epsilon) 
-			|| std::abs(std::get<1>(current)) > ((spawn_diam / 2) + epsilon) 
-			|| std::abs(std::get<2>(current)) > ((spawn_diam / 2) + epsilon)) {
-			current = previous;
-			return true;
-		}
-		break;
-	case attractor_type::LINE:
-		if (std::abs(std::get<0>(current)) > (static_cast<int>(attractor_size) / 2 + epsilon)
-			|| std::abs(std::get<1>(current)) > (spawn_diam + epsilon)
-			|| std::abs(std::get<2>(current)) > (spawn_diam + epsilon)) {
-			current = previous;
-			return true;
-		}
-		break;
-	case attractor_type::PLANE:
-		if (std::abs(std::get<0>(current)) > (static_cast<int>(attractor_size) / 2 + epsilon)
-			|| std::abs(std::get<1>(current)) > ((static_cast<int>(attractor_size) / 2 + epsilon))
-			|| std::abs(std::get<2>(current)) > (spawn_diam + epsilon)) {
-			current = previous;
-			return true;
-		}
-		break;
-	case attractor_type::CIRCLE:
-		if (is_spawn_source_above) {
-			if (std::abs(std::get<0>(current)) > ((spawn_diam / 2) + epsilon)
-				|| std::abs(std::get<1>(current)) > ((spawn_diam / 2) + epsilon)
-				|| std::abs(std::get<2>(current)) > ((spawn_diam / 2) + epsilon)) {
-				current = previous;
-				return true;
-			}
-		}
-		else {
-
-		}
-		break;
-	}
-	return false;
+std::size_t DLAContainer::grown_capacity(std::size_t n, std::size_t current_cap) noexcept {
+	if (n <= current_cap) return current_cap;
+	return std::max(n, 2U * current_cap);
+}
+
+bool DLAContainer::is_cacheable(std::size_t n) const noexcept {
+	return cache && is_seed_fresh && n && !size() && !continuous.is_raised()
+		&& !track_parents && !recorder.active();
+}
+
+utl::aggregate_cache::key DLAContainer::cache_key(unsigned dimension, std::size_t n) const noexcept {
+	return utl::aggregate_cache::key{ dimension, lattice, attractor, attractor_size, n, coeff_stick,
+		is_spawn_source_above, is_spawn_source_below, periodic_boundaries && (attractor == attractor_type::LINE
+		|| attractor == attractor_type::PLANE), seed, stream };
+}
+
+std::string DLAContainer::generator_state() const {
+	std::ostringstream oss;
+	oss << pr_gen.get_generator();
+	return oss.str();
+}
+
+void DLAContainer::restore_generator_state(const std::string& state) {
+	std::istringstream iss(state);
+	utl::philox4x32 engine;
+	iss >> engine;
+	pr_gen = utl::uniform_random_probability_generator<double, utl::philox4x32>(std::move(engine));
 }
@@ -1,19 +1,29 @@
 #pragma once
+#include "aggregate_cache.h"
+#include "aggregate_tree.h"
+#include "growth_recorder.h"
+#include "lattice.h"
 #include "mutable_comp_priority_queue.h"
+#include "signal_flag.h"
 #include "utilities.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
+class DLAGenerationHandle;
+
 /**
  * \class DLAContainer
  *
  * \brief Abstract class containing data about a diffusion limited aggregate with virtual methods for generating an aggregate, finding
- *        its properties and writing to a stream. This class is overridden by DLA_2d and DLA_3d for generating 2D and 3D aggregates.
+ *        its properties and writing to a stream. This class is overridden by DLA<N> for generating aggregates in N dimensions.
  *
  * \author Samuel Rowlinson
  * \date April, 2016
@@ -26,23 +36,26 @@ public:
 	 *        of LatticeType::SQUARE and attractor type of AttractorType::POINT.
 	 *
 	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
 	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
 	 */
-	DLAContainer(const double& _coeff_stick = 1.0);
+	DLAContainer(const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed());
 	/**
 	 * \brief Constructor with parameters for type of lattice and type of attractor.
 	 *
 	 * \param ltt Type of lattice for DLA construction.
 	 * \param att Type of attractor for DLA construction.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
 	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
 	 */
-	DLAContainer(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick = 1.0);
+	DLAContainer(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed());
 	/**
 	 * \brief Copy constructor, copies contents of parameterised DLAContainer to this.
 	 *
 	 * \param other const reference to DLAContainer instance.
 	 */
-	DLAContainer(const DLAContainer& other) noexcept;
+	DLAContainer(const DLAContainer& other);
 	/**
 	 * \brief Move constructor, uses move-semantics for constructing a DLAContainer 
 	 *        from an rvalue reference of a DLAContainer - leaving that container
@@ -91,8 +104,10 @@ public:
 	 * \brief Sets the type of lattice.
 	 *
 	 * \param _lattice_type LatticeType to update to.
+	 * \throw Throws std::invalid_argument exception if the lattice is not defined in the dimension
+	 *        of the aggregate.
 	 */
-	void set_lattice_type(lattice_type ltt) noexcept;
+	virtual void set_lattice_type(lattice_type ltt);
 	/**
 	 * \brief Sets the type of attractor.
 	 *
@@ -112,6 +127,9 @@ public:
 	 * - the distance of the furthest point from the attractor line if the attractor
 	 * type is `attractor_type::LINE`.
 	 *
+	 * Distances are measured between Cartesian positions of sites, in units of the nearest
+	 * neighbour distance of the lattice, as are the fractal dimension and growth samples.
+	 *
 	 * \return Distance of further point in the aggregate.
 	 */
 	std::size_t aggregate_spanning_distance() const noexcept;
@@ -123,11 +141,141 @@ public:
 	 * \return Number of aggregate misses.
 	 */
 	std::size_t aggregate_misses() const noexcept;
+	// AGGREGATE TOPOLOGY
+	/**
+	 * \brief Enables or disables recording of the particle each new particle sticks to, building
+	 *        the aggregate up as a tree rooted on the attractor. Disabling discards any recorded links.
+	 *
+	 * \param _track Flag determining whether parent links are recorded.
+	 * \throw Throws std::logic_error if enabling tracking on a non-empty aggregate.
+	 */
+	void set_parent_tracking(bool _track);
+	/**
+	 * \brief Gets whether parent links are recorded during aggregate generation.
+	 *
+	 * \return true if parent tracking is enabled, false otherwise.
+	 */
+	bool is_parent_tracking() const noexcept;
+	/**
+	 * \brief Gets the parent index of each particle in generation order, where the parent of
+	 *        a particle which stuck directly to the attractor is `utl::no_parent`.
+	 *
+	 * \return const reference to the parent-index array, empty if parent tracking is disabled.
+	 */
+	const std::vector<std::size_t>& parent_indices() const noexcept;
+	/**
+	 * \brief Computes the branch topology of the aggregate - branch lengths, Horton-Strahler
+	 *        orders, tip count and chemical distances from the attractor - in O(N).
+	 *
+	 * \return Branch topology of the aggregate.
+	 * \throw Throws std::logic_error if parent tracking was not enabled for the whole aggregate.
+	 */
+	utl::tree_topology analyse_tree_topology() const;
+	// GROWTH TIME SERIES
+	/**
+	 * \brief Enables or disables recording of growth samples - size, maximum radius, radius of
+	 *        gyration, misses, wall-clock time and random walk steps - at logarithmically spaced
+	 *        aggregate sizes during generation. Disabling discards any recorded samples.
+	 *
+	 * \param _record Flag determining whether growth samples are recorded.
+	 * \param samples_per_decade [= 10] Number of samples per decade of aggregate size.
+	 * \throw Throws std::logic_error if enabling recording on a non-empty aggregate.
+	 */
+	void set_growth_recording(bool _record, std::size_t samples_per_decade = 10U);
+	/**
+	 * \brief Gets whether growth samples are recorded during aggregate generation.
+	 *
+	 * \return true if growth recording is enabled, false otherwise.
+	 */
+	bool is_growth_recording() const noexcept;
+	/**
+	 * \brief Gets the recorded growth samples in order of increasing aggregate size.
+	 *
+	 * \return const reference to contiguous sample array, empty if growth recording is disabled.
+	 */
+	const std::vector<utl::growth_sample>& growth_series() const noexcept;
+	/**
+	 * \brief Writes the recorded growth samples to an output stream as tab separated columns.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 */
+	std::ostream& write_growth_series(std::ostream& os) const;
+	/**
+	 * \brief Gets the total number of random walk steps taken generating the aggregate.
+	 *
+	 * \return Number of random walk steps.
+	 */
+	std::uint64_t random_walk_steps() const noexcept;
+	// RANDOM NUMBER GENERATOR
+	/**
+	 * \brief Gets the seed of the random number generator.
+	 */
+	std::uint64_t get_seed() const noexcept;
+	/**
+	 * \brief Gets the stream of the random number generator.
+	 */
+	std::uint64_t get_stream() const noexcept;
+	/**
+	 * \brief Gets the number of values drawn from the stream of the random number generator, which
+	 *        together with the seed and stream restores the generator via `seed_generator`.
+	 */
+	std::uint64_t get_generator_offset() const noexcept;
+	// AGGREGATE CACHE
+	/**
+	 * \brief Attaches an on-disk cache of finished aggregates, or detaches it if null. Generating
+	 *        an aggregate from empty directly after seeding the generator via `seed_generator` is
+	 *        then served from the cache when an identical seeded aggregate was generated before,
+	 *        and stored otherwise.
+	 *
+	 * The cache is bypassed whilst generation is continuous or parent tracking or growth
+	 * recording are enabled, as cached aggregates hold neither parent links nor growth samples.
+	 *
+	 * \param _cache Cache to consult, may be shared between containers and threads.
+	 */
+	void set_aggregate_cache(std::shared_ptr<utl::aggregate_cache> _cache) noexcept;
+	/**
+	 * \brief Gets the attached aggregate cache.
+	 *
+	 * \return Attached cache, null if none.
+	 */
+	const std::shared_ptr<utl::aggregate_cache>& get_aggregate_cache() const noexcept;
+	// STORAGE REUSE
+	/**
+	 * \brief Enables or disables storage reuse, for ensembles of many small aggregates generated in
+	 *        turn by one container. Whilst enabled, `clear()` retains all container capacity and
+	 *        vacates every occupied lattice site at once by advancing an occupancy epoch, rather than
+	 *        freeing the aggregate particle by particle.
+	 *
+	 * \param _reuse Flag determining whether storage is reused across `clear()`.
+	 */
+	void set_storage_reuse(bool _reuse) noexcept;
+	/**
+	 * \brief Gets whether storage is reused across `clear()`.
+	 *
+	 * \return true if storage reuse is enabled, false otherwise.
+	 */
+	bool is_storage_reused() const noexcept;
 	// MODIFIERS
 	/**
-	 * \brief Raises an abort signal, stopping any current aggregate generation.
+	 * \brief Re-seeds the random number generator used for the random walk, such that
+	 *        subsequent generation is reproducible. Distinct streams of one seed are
+	 *        independent, e.g. for the replicas of an ensemble.
+	 *
+	 * \param _seed Seed for the generator engine.
+	 * \param _stream [= 0] Stream of the seed.
+	 * \param _offset [= 0] Number of values of the stream to skip, e.g. to resume from a checkpoint.
+	 */
+	void seed_generator(std::uint64_t _seed, std::uint64_t _stream = 0U, std::uint64_t _offset = 0U);
+	/**
+	 * \brief Raises an abort signal, stopping any current aggregate generation. The signal
+	 *        is lowered again by the generation which observes it.
 	 */
 	void raise_abort_signal() noexcept;
+	/**
+	 * \brief Lowers any pending abort signal which was not observed by a generation, such
+	 *        that the next generation is not immediately stopped.
+	 */
+	void reset_abort_signal() noexcept;
 	/**
 	 * \brief Changes the value of the continous_flag field to specified argument.
 	 *
@@ -142,17 +290,59 @@ public:
 	 *        `second` element indicates below flag.
 	 */
 	void set_random_walk_particle_spawn_source(const std::pair<bool, bool>& above_below);
+	/**
+	 * \brief Enables or disables periodic boundaries along a LINE or PLANE attractor, such that random
+	 *        walkers leaving one end of the substrate re-enter at the other rather than being reflected,
+	 *        the substrate having no edges. Particles keep co-ordinates from -att_size/2 to att_size/2 - 1
+	 *        along the substrate. Ignored for other attractors and by the engines without a substrate
+	 *        other than DLA<N>.
+	 *
+	 * \param _periodic Flag determining whether the boundaries along the substrate are periodic.
+	 * \throw Throws std::logic_error exception if the flag is changed on a non-empty aggregate.
+	 */
+	virtual void set_periodic_boundaries(bool _periodic);
+	/**
+	 * \brief Gets whether the boundaries along a LINE or PLANE attractor are periodic.
+	 */
+	bool has_periodic_boundaries() const noexcept;
 	/**
 	 * \brief Clears the aggregrate structure.
 	 */
 	virtual void clear();
 	/**
 	 * \brief Generates a diffusion limited aggregate consisting of the parameterised
-	 *        number of particles.
+	 *        number of particles, equivalent to `grow_to(n)`.
 	 *
 	 * \param _n Number of particles to generate in the DLA.
 	 */
-	virtual void generate(std::size_t n) = 0;
+	virtual void generate(std::size_t n);
+	/**
+	 * \brief Continues growth of the aggregate until it consists of `n` particles, reusing
+	 *        all existing aggregate and attractor state such that generation indices carry
+	 *        on from the current aggregate. Does nothing if the aggregate already has at
+	 *        least `n` particles (unless generation is continuous).
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	virtual void grow_to(std::size_t n) = 0;
+	/**
+	 * \brief Continues growth of the aggregate by `k` further particles.
+	 *
+	 * \param k Number of particles to add to the aggregate.
+	 */
+	void grow_by(std::size_t k);
+	/**
+	 * \brief Grows the aggregate to `n` particles asynchronously on a worker thread, see
+	 *        DLAGenerationHandle (include "DLAGenerationHandle.h" to use the returned handle).
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 * \param progress_granularity [= 0] Number of particles between progress callbacks, zero
+	 *        for a single callback upon completion.
+	 * \param on_progress [= {}] Callback invoked on the worker thread with the current aggregate size.
+	 * \return Handle for pausing, resuming, cancelling and awaiting the generation.
+	 */
+	DLAGenerationHandle generate_async(std::size_t n, std::size_t progress_granularity = 0U,
+		std::function<void(std::size_t)> on_progress = std::function<void(std::size_t)>());
 	/**
 	 * \brief Computes an estimate of the fractal dimension for the aggregrate.
 	 *
@@ -174,41 +364,92 @@ public:
 protected:
 	// lattice and attractor type properties
 	lattice_type lattice;
+	// table of lattice steps driving the random walk, set by the derived class for its dimension
+	const utl::lattice_descriptor* lattice_geometry = nullptr;
 	attractor_type attractor;
 	double coeff_stick;
-	// random floating point value generator uniform in [0.0, 1.0]
-	utl::uniform_random_probability_generator<> pr_gen;
-	// multithreaded event firing signal flags
-	bool abort_signal = false;
-	bool continuous = false;
+	// random floating point value generator uniform in [0.0, 1.0], counter-based such that
+	// any position of any stream is reachable in constant time
+	utl::uniform_random_probability_generator<double, utl::philox4x32> pr_gen;
+	// multithreaded event firing signal flags, written from controlling threads
+	utl::signal_flag abort_signal;
+	utl::signal_flag continuous;
 	// properties of aggregate
 	std::size_t aggregate_span = 0;
 	std::size_t aggregate_misses_ = 0;
+	// parent index of each particle in generation order, filled only if track_parents is set
+	bool track_parents = false;
+	std::vector<std::size_t> parents;
+	// log-spaced growth samples, filled only if recorder is active
+	utl::growth_recorder recorder;
+	std::uint64_t walk_steps = 0U;
+	// cache of finished aggregates, consulted only for generation from empty with a freshly seeded generator
+	std::shared_ptr<utl::aggregate_cache> cache;
+	std::uint64_t seed;
+	std::uint64_t stream = 0U;
+	// set only by an explicit call of seed_generator, as the seed drawn by default is not reproducible
+	bool is_seed_fresh = false;
+	// generation index of an occupied lattice site, which is occupied only if stamped with the current
+	// epoch such that all sites are vacated in constant time by advancing the epoch
+	struct occupancy {
+		std::size_t generation;
+		std::uint32_t epoch;
+	};
+	// stale sites of earlier epochs are purged once they exceed this multiple of the largest aggregate
+	static constexpr std::size_t max_stale_sites_ratio = 4U;
+	bool reuse_storage = false;
+	std::uint32_t epoch = 0U;
+	std::size_t occupied_sites = 0U;
 	// properties of attractor
 	std::size_t attractor_size;
 	bool is_spawn_source_above = true;
 	bool is_spawn_source_below = true;
+	// flag indicating whether walkers wrap about the ends of a LINE or PLANE attractor
+	bool periodic_boundaries = false;
+	// flag indicating whether attractor structure matches current attractor type and size
+	bool is_attractor_initialised = false;
 	/**
-	 * \brief Updates position of random walking particle.
+	 * \brief Advances the occupancy epoch, vacating every site stamped with the previous epoch.
 	 *
-	 * \param _current Current position, to be updated.
-	 * \param _movement_choice Double in [0,1] for direction choice.
+	 * \param site_count Number of sites, occupied or stale, in the occupancy map.
+	 * \param capacity Retained particle capacity.
+	 * \return true if stale sites must be purged from the occupancy map, false otherwise.
 	 */
-	void update_particle_position(std::pair<int,int>& current, const double& movement_choice) noexcept;
+	bool advance_epoch(std::size_t site_count, std::size_t capacity) noexcept;
 	/**
-	 * \copydoc DLAContainer::update_particle_position(std::pair<int,int>,const double&)
+	 * \brief Computes the capacity to reserve for aggregate containers such that growing
+	 *        to `n` particles never reallocates and repeated small continuations grow
+	 *        capacity geometrically.
+	 *
+	 * \param n Number of particles required.
+	 * \param current_cap Current capacity of aggregate containers.
+	 * \return New capacity, or `current_cap` if already sufficient.
+	 */
+	static std::size_t grown_capacity(std::size_t n, std::size_t current_cap) noexcept;
+	/**
+	 * \brief Gets whether growth to `n` particles may be served from or stored to the aggregate cache.
+	 *
+	 * \param n Number of particles required.
+	 * \return true if a cache is attached and growth to `n` is determined by the seed alone.
 	 */
-	void update_particle_position(std::tuple<int,int,int>& current, const double& movement_choice) noexcept;
+	bool is_cacheable(std::size_t n) const noexcept;
 	/**
-	 * \brief Checks for collision with boundary of lattice and reflects.
+	 * \brief Computes the aggregate cache key of an aggregate of `n` particles of this container.
 	 *
-	 * \param _current Current position, updated if collision occurred.
-	 * \param _previous Previous position.
-	 * \param _spawn_diam Current diameter of spawning box.
+	 * \param dimension Dimension of lattice.
+	 * \param n Number of particles.
 	 */
-	bool lattice_boundary_collision(std::pair<int,int>& current, const std::pair<int,int>& previous, const int& spawn_diam) const noexcept;
+	utl::aggregate_cache::key cache_key(unsigned dimension, std::size_t n) const noexcept;
 	/**
-	 * \copydoc DLAContainer::lattice_boundary_collision(std::pair<int,int>&,const std::pair<int,int>&,const int&)
+	 * \brief Serialises the state of the random number generator.
+	 *
+	 * \return Textual generator state.
+	 */
+	std::string generator_state() const;
+	/**
+	 * \brief Restores the state of the random number generator from `generator_state()` output.
+	 *
+	 * \param state Textual generator state.
 	 */
-	bool lattice_boundary_collision(std::tuple<int,int,int>& current, const std::tuple<int,int,int>& previous, const int& spawn_diam) const noexcept;
+	void restore_generator_state(const std::string& state);
 };
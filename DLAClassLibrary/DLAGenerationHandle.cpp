@@ -0,0 +1,106 @@
+#include "Stdafx.h"
+#include "DLAGenerationHandle.h"
+
+// defined alongside the handle such that DLAContainer.cpp need not include <thread>
+DLAGenerationHandle DLAContainer::generate_async(std::size_t n, std::size_t progress_granularity, std::function<void(std::size_t)> on_progress) {
+	return DLAGenerationHandle(*this, n, progress_granularity, std::move(on_progress));
+}
+
+DLAGenerationHandle::DLAGenerationHandle(DLAContainer& dla, std::size_t n, std::size_t progress_granularity, progress_callback on_progress)
+	: state(std::make_unique<shared_state>(dla, n, progress_granularity, std::move(on_progress))) {
+	worker = std::thread(&DLAGenerationHandle::run, state.get());
+}
+
+DLAGenerationHandle::~DLAGenerationHandle() {
+	if (!state) return;	// moved-from
+	cancel();
+	if (worker.joinable()) worker.join();
+}
+
+void DLAGenerationHandle::pause() {
+	std::lock_guard<std::mutex> lock(state->mtx);
+	if (state->done || state->cancelled) return;
+	state->paused = true;
+	state->dla.raise_abort_signal();	// stop walk within one step, worker then blocks on cv
+}
+
+void DLAGenerationHandle::resume() {
+	{
+		std::lock_guard<std::mutex> lock(state->mtx);
+		state->paused = false;
+	}
+	state->cv.notify_all();
+}
+
+void DLAGenerationHandle::cancel() {
+	{
+		std::lock_guard<std::mutex> lock(state->mtx);
+		if (state->done) return;
+		state->cancelled = true;
+		state->dla.raise_abort_signal();
+	}
+	state->cv.notify_all();
+}
+
+bool DLAGenerationHandle::is_paused() const {
+	std::lock_guard<std::mutex> lock(state->mtx);
+	return state->paused;
+}
+
+bool DLAGenerationHandle::is_cancelled() const {
+	std::lock_guard<std::mutex> lock(state->mtx);
+	return state->cancelled;
+}
+
+bool DLAGenerationHandle::is_done() const noexcept {
+	return state->done.load(std::memory_order_acquire);
+}
+
+std::size_t DLAGenerationHandle::progress() const noexcept {
+	return state->reported.load(std::memory_order_relaxed);
+}
+
+std::shared_future<void> DLAGenerationHandle::completion() const {
+	return state->done_future;
+}
+
+void DLAGenerationHandle::wait() const {
+	state->done_future.get();
+}
+
+void DLAGenerationHandle::run(shared_state* s) {
+	try {
+		while (s->dla.size() < s->target) {
+			{
+				std::unique_lock<std::mutex> lock(s->mtx);
+				s->cv.wait(lock, [s]() { return !s->paused || s->cancelled; });
+				if (s->cancelled) break;
+			}
+			// an abort raised by pause() or cancel() after the wait above stops this chunk at once
+			const std::size_t chunk_end = s->granularity ? std::min(s->dla.size() + s->granularity, s->target) : s->target;
+			s->dla.grow_to(chunk_end);
+			const std::size_t current = s->dla.size();
+			// only report chunks which completed, not those interrupted by pause or cancel
+			if (current >= chunk_end) {
+				s->reported.store(current, std::memory_order_relaxed);
+				if (s->on_progress) s->on_progress(current);
+			}
+		}
+		{
+			// lower any abort signal raised after the final chunk completed whilst holding the lock
+			// such that no later pause() or cancel() can raise another for this generation
+			std::lock_guard<std::mutex> lock(s->mtx);
+			s->done.store(true, std::memory_order_release);
+			s->dla.reset_abort_signal();
+		}
+		s->done_promise.set_value();
+	}
+	catch (...) {
+		{
+			std::lock_guard<std::mutex> lock(s->mtx);
+			s->done.store(true, std::memory_order_release);
+			s->dla.reset_abort_signal();
+		}
+		s->done_promise.set_exception(std::current_exception());
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "DLAContainer.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * \class DLAGenerationHandle
+ *
+ * \brief Handle to an asynchronous aggregate generation running on a dedicated worker thread.
+ *
+ * The worker grows the referenced DLAContainer in chunks of `progress_granularity` particles via
+ * `DLAContainer::grow_to`, invoking the progress callback (on the worker thread) after each chunk.
+ * Pausing and cancelling raise the container abort signal so that the walk stops within one step,
+ * the next chunk then continues from the existing aggregate state at the cost of only the walker in
+ * flight. A paused worker blocks on a condition variable rather than polling.
+ *
+ * The container must outlive the handle and must not be modified by any other thread whilst the
+ * generation is running. Destroying the handle cancels the generation and joins the worker thread.
+ */
+class DLAGenerationHandle {
+public:
+	typedef std::function<void(std::size_t)> progress_callback;
+	// CONSTRUCTION/ASSIGNMENT
+	/**
+	 * \brief Starts growth of `dla` to `n` particles on a new worker thread.
+	 *
+	 * \param dla Container to grow, existing particles are kept.
+	 * \param n Total number of particles in the aggregate after growth.
+	 * \param progress_granularity [= 0] Number of particles between progress callbacks, zero
+	 *        for a single callback upon completion.
+	 * \param on_progress [= {}] Callback invoked with the current aggregate size.
+	 */
+	DLAGenerationHandle(DLAContainer& dla, std::size_t n, std::size_t progress_granularity = 0U,
+		progress_callback on_progress = progress_callback());
+	DLAGenerationHandle(const DLAGenerationHandle&) = delete;
+	DLAGenerationHandle& operator=(const DLAGenerationHandle&) = delete;
+	/**
+	 * \brief Move constructor, transfers ownership of the running generation from `other`.
+	 *
+	 * \param other rvalue reference to DLAGenerationHandle instance.
+	 */
+	DLAGenerationHandle(DLAGenerationHandle&& other) noexcept = default;
+	/**
+	 * \brief Cancels the generation, if still running, and joins the worker thread.
+	 */
+	~DLAGenerationHandle();
+	// CONTROL
+	/**
+	 * \brief Pauses the generation, stopping the walk within one step. No effect if the
+	 *        generation has completed.
+	 */
+	void pause();
+	/**
+	 * \brief Resumes a paused generation.
+	 */
+	void resume();
+	/**
+	 * \brief Cooperatively cancels the generation, leaving the particles generated so far in
+	 *        the container. No effect if the generation has completed.
+	 */
+	void cancel();
+	// STATUS
+	/**
+	 * \brief Gets whether the generation is currently paused.
+	 *
+	 * \return true if paused, false otherwise.
+	 */
+	bool is_paused() const;
+	/**
+	 * \brief Gets whether the generation was cancelled before reaching its target size.
+	 *
+	 * \return true if cancelled, false otherwise.
+	 */
+	bool is_cancelled() const;
+	/**
+	 * \brief Gets whether the worker has finished, by completion, cancellation or error.
+	 *
+	 * \return true if finished, false otherwise.
+	 */
+	bool is_done() const noexcept;
+	/**
+	 * \brief Gets the aggregate size reported at the last progress point.
+	 *
+	 * \return Number of particles in the aggregate at the last completed chunk.
+	 */
+	std::size_t progress() const noexcept;
+	// COMPLETION
+	/**
+	 * \brief Gets a future which becomes ready once the worker finishes, rethrowing any
+	 *        exception thrown during generation.
+	 *
+	 * \return Shared future signalling completion.
+	 */
+	std::shared_future<void> completion() const;
+	/**
+	 * \brief Blocks until the worker finishes.
+	 *
+	 * \throw Rethrows any exception thrown during generation.
+	 */
+	void wait() const;
+	/**
+	 * \brief Blocks until the worker finishes or the timeout expires.
+	 *
+	 * \param timeout Maximum duration to block for.
+	 * \return true if the worker finished, false on timeout.
+	 */
+	template<class Rep, class Period>
+	bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+		return state->done_future.wait_for(timeout) == std::future_status::ready;
+	}
+private:
+	// state shared with the worker thread, heap allocated so the handle remains movable
+	struct shared_state {
+		DLAContainer& dla;
+		std::size_t target;
+		std::size_t granularity;
+		progress_callback on_progress;
+		mutable std::mutex mtx;
+		std::condition_variable cv;
+		bool paused = false;
+		bool cancelled = false;
+		std::atomic<bool> done{ false };
+		std::atomic<std::size_t> reported{ 0U };
+		std::promise<void> done_promise;
+		std::shared_future<void> done_future;
+		shared_state(DLAContainer& _dla, std::size_t n, std::size_t _granularity, progress_callback&& _on_progress)
+			: dla(_dla), target(n), granularity(_granularity), on_progress(std::move(_on_progress)),
+			done_future(done_promise.get_future().share()) {}
+	};
+	std::unique_ptr<shared_state> state;
+	std::thread worker;
+	/**
+	 * \brief Worker thread body, grows the container chunk by chunk honouring pause and cancel.
+	 *
+	 * \param s State shared with the controlling handle.
+	 */
+	static void run(shared_state* s);
+};
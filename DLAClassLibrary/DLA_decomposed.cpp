@@ -0,0 +1,365 @@
+#include "Stdafx.h"
+#include "DLA_decomposed.h"
+#include "worker_pool.h"
+#include <thread>
+
+namespace {
+	// distance of the spawn sources beyond the deposit, and of the reflecting walls beyond the spawn sources
+	// and the ends of the substrate, as for DLA<N>
+	constexpr int boundary_offset = 8;
+	constexpr int epsilon = 2;
+	// smallest width of a slab, such that the slabs advanced at once are at least two sites apart, and
+	// smallest and largest number of sites along each axis of the substrate
+	constexpr std::size_t min_slab_width = 4U;
+	constexpr std::size_t min_substrate_size = 8U;
+	constexpr std::size_t max_substrate_size = std::size_t(1U) << 20;
+	// number of random walk steps of each slab per phase unless set otherwise
+	constexpr std::size_t default_steps_per_phase = 1U << 12;
+}
+
+template<std::size_t N>
+constexpr std::size_t DLA_decomposed<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t DLA_decomposed<N>::no_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_decomposed<N>::attractor_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_decomposed<N>::pending_flag;
+
+template<std::size_t N>
+DLA_decomposed<N>::DLA_decomposed(std::size_t _substrate_size, lattice_type ltt, const double& _coeff_stick, std::uint64_t _seed)
+	: DLAContainer(ltt, (N == 2U) ? attractor_type::LINE : attractor_type::PLANE, _substrate_size, _coeff_stick, _seed),
+	steps_per_phase(default_steps_per_phase) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	check_attractor(attractor, attractor_size);
+	set_thread_count(0U);
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename DLA_decomposed<N>::aggregate_buffer_vector& DLA_decomposed<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::set_thread_count(std::size_t _threads) {
+	threads = _threads ? _threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::thread_count() const noexcept {
+	return threads;
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::slab_count() const noexcept {
+	return slabs.size();
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::set_sync_interval(std::size_t _steps) {
+	if (!_steps) throw std::invalid_argument("sync interval must be at least one step.");
+	steps_per_phase = _steps;
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::sync_interval() const noexcept {
+	return steps_per_phase;
+}
+
+template<std::size_t N>
+std::uint64_t DLA_decomposed<N>::walker_handoffs() const noexcept {
+	return handoffs;
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::lost_walkers() const noexcept {
+	return lost;
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::set_lattice_type(lattice_type ltt) {
+	// look up first such that an invalid lattice type leaves the aggregate unchanged
+	lattice_geometry = &utl::describe_lattice(ltt, static_cast<unsigned>(N));
+	// walkers of the old lattice are discarded upon the next growth
+	if (ltt != lattice) is_attractor_initialised = false;
+	DLAContainer::set_lattice_type(ltt);
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	check_attractor(attr, att_size);
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::set_periodic_boundaries(bool _periodic) {
+	if (_periodic) throw std::invalid_argument("DLA_decomposed does not support periodic boundaries.");
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::initialise_attractor_structure() {
+	is_attractor_initialised = true;
+	// the substrate spans [-att_size/2, +att_size/2) along each of its axes as for DLA<N>, its columns split
+	// evenly between the slabs, the walls beyond its ends belonging to the first and last slabs
+	const int half = static_cast<int>(attractor_size / 2U);
+	const std::size_t width = 2U*(attractor_size / 2U);
+	const std::size_t count = slab_count_for_threads();
+	slabs.clear();
+	slabs.resize(count);
+	for (std::size_t k = 0U; k < count; ++k) {
+		slab& s = slabs[k];
+		s.lo = (k == 0U) ? -half - epsilon : -half + static_cast<int>(k*width / count);
+		s.hi = (k + 1U == count) ? half + epsilon + 1 : -half + static_cast<int>((k + 1U)*width / count);
+		s.top = 0;
+		s.has_walker = false;
+		s.spawns.clear();
+		s.misses = 0U;
+		s.lost = 0U;
+		s.steps = 0U;
+		s.handoffs = 0U;
+	}
+	for (std::size_t i = 0U; i < buffer.size(); ++i) {
+		const site_type site = utl::coordinates_of(buffer[i]);
+		slab& s = slabs[slab_of(site[0])];
+		s.sites[key_of(site)] = static_cast<std::uint32_t>(i);
+		s.top = std::max(s.top, std::abs(site[N - 1U]));
+	}
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	max_height = 0;
+	handoffs = 0U;
+	lost = 0U;
+	slabs.clear();
+	if (!reuse_storage) {
+		buffer.shrink_to_fit();
+		slabs.shrink_to_fit();
+	}
+	is_attractor_initialised = false;
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised || slabs.size() != slab_count_for_threads()) initialise_attractor_structure();
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		buffer.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	if (recorder.active()) recorder.start_clock();
+	const std::size_t count = slabs.size();
+	while (size() < n || continuous.is_raised()) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		for (std::size_t parity = 0U; parity < 2U && (size() < n || continuous.is_raised()); ++parity) {
+			// the streams of the phase are keyed by a draw of the aggregate generator, such that growth is
+			// reproducible for a given seed and number of slabs
+			spawn_walkers();
+			const std::uint64_t key = static_cast<std::uint64_t>(pr_gen()*9007199254740992.0);
+			utl::parallel_for(count / 2U, threads, [this, key, parity](std::size_t m) { update_slab(2U*m + parity, key); });
+			for (std::size_t k = parity; k < count; k += 2U) merge_slab(slabs[k], n);
+		}
+	}
+	if (recorder.active()) recorder.stop_clock();
+}
+
+template<std::size_t N>
+double DLA_decomposed<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	// the last Cartesian axis depends upon the last co-ordinate only, so the height scales by its basis
+	return utl::estimate_fractal_dimension(size(), max_height*lattice_geometry->basis[N - 1U][N - 1U], attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& DLA_decomposed<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+std::uint64_t DLA_decomposed<N>::key_of(const site_type& s) noexcept {
+	// each co-ordinate offset into an equal share of the bits of the key
+	constexpr unsigned bits = 64U / N;
+	constexpr std::uint64_t mask = (std::uint64_t(1U) << bits) - 1U;
+	std::uint64_t key = 0U;
+	for (std::size_t i = 0U; i < N; ++i)
+		key |= ((static_cast<std::uint64_t>(static_cast<std::int64_t>(s[i]) + (std::int64_t(1) << (bits - 1U)))) & mask) << (i*bits);
+	return key;
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::slab_count_for_threads() const noexcept {
+	// an even number of slabs, two per thread, none narrower than the smallest width
+	const std::size_t width = 2U*(attractor_size / 2U);
+	std::size_t count = 2U*threads;
+	while (count > 2U && width / count < min_slab_width) count -= 2U;
+	return count;
+}
+
+template<std::size_t N>
+std::size_t DLA_decomposed<N>::slab_of(int x) const noexcept {
+	const int half = static_cast<int>(attractor_size / 2U);
+	const std::size_t width = 2U*(attractor_size / 2U);
+	if (x < -half) return 0U;
+	if (x >= half) return slabs.size() - 1U;
+	return ((static_cast<std::size_t>(x + half) + 1U)*slabs.size() - 1U) / width;
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::check_attractor(attractor_type att, std::size_t att_size) const {
+	if (att != ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE))
+		throw std::invalid_argument("attractor type of DLA_decomposed must be LINE in 2D and PLANE in 3D.");
+	if (att_size < min_substrate_size || att_size > max_substrate_size)
+		throw std::invalid_argument("substrate size of DLA_decomposed out of range.");
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::spawn_walkers() {
+	// walkers are spawned uniformly over the whole substrate, as for DLA<N>, and queued to the slabs owning
+	// their columns, such that no slab receives more walkers for its walkers ending sooner
+	std::size_t outstanding = 0U;
+	for (const auto& s : slabs) outstanding += s.has_walker + s.inbox[0].size() + s.inbox[1].size() + s.spawns.size();
+	const std::size_t width = 2U*(attractor_size / 2U);
+	const int half = static_cast<int>(attractor_size / 2U);
+	for (; outstanding < slabs.size(); ++outstanding) {
+		walker w;
+		for (std::size_t i = 0U; i + 1U < N; ++i) w.site[i] = static_cast<int>(utl::step_index(pr_gen(), width)) - half;
+		// the side of the spawn source, the height being set once the walker starts
+		const bool is_above = is_spawn_source_above && (!is_spawn_source_below || pr_gen() < 0.5);
+		w.site[N - 1U] = is_above ? 1 : -1;
+		w.ceiling = 0;
+		slabs[slab_of(w.site[0])].spawns.push_back(w);
+	}
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::update_slab(std::size_t k, std::uint64_t key) {
+	utl::uniform_random_probability_generator<double, utl::philox4x32> gen(utl::philox4x32(key, k));
+	slab& s = slabs[k];
+	s.attached.clear();
+	s.misses = 0U;
+	s.lost = 0U;
+	s.steps = 0U;
+	s.handoffs = 0U;
+	const int half = static_cast<int>(attractor_size / 2U);
+	const int wall = half + epsilon;
+	const std::size_t step_count = lattice_geometry->step_count;
+	// the slabs either side, idle during the phase, are read for the sites beyond the boundaries
+	slab* const below = (k > 0U) ? &slabs[k - 1U] : nullptr;
+	slab* const above = (k + 1U < slabs.size()) ? &slabs[k + 1U] : nullptr;
+	const int halo_top = std::max(below ? below->top : 0, above ? above->top : 0);
+	const auto content_of = [&](const site_type& t, const slab& owner) {
+		// the substrate spans [-att_size/2, +att_size/2) along each of its axes
+		bool is_attractor = t[N - 1U] == 0;
+		for (std::size_t i = 0U; i + 1U < N; ++i) is_attractor = is_attractor && t[i] >= -half && t[i] < half;
+		if (is_attractor) return attractor_index;
+		// no particle lies beyond the tallest column of the slab and its halos
+		if (std::abs(t[N - 1U]) > std::max(owner.top, halo_top)) return no_index;
+		const auto it = owner.sites.find(key_of(t));
+		return (it == owner.sites.end()) ? no_index : it->second;
+	};
+	for (std::size_t a = 0U; a < steps_per_phase; ++a) {
+		if (!s.has_walker) {
+			// walkers handed off are walked before any walker is spawned, any whose site was occupied since being lost
+			for (auto& box : s.inbox) {
+				while (!s.has_walker && !box.empty()) {
+					const walker w = box.front();
+					box.pop_front();
+					if (s.sites.count(key_of(w.site))) ++s.lost;
+					else {
+						s.current = w;
+						s.has_walker = true;
+					}
+				}
+			}
+		}
+		if (!s.has_walker) {
+			// walkers spawned onto the columns of the slab start at the height of the spawn sources of DLA<N>
+			if (s.spawns.empty()) break;
+			walker& w = s.current;
+			w = s.spawns.front();
+			s.spawns.pop_front();
+			const bool is_above = w.site[N - 1U] > 0;
+			w.ceiling = std::max(max_height, s.top) + boundary_offset;
+			w.site[N - 1U] = is_above ? w.ceiling : -w.ceiling;
+			utl::snap_to_lattice(w.site, lattice_geometry->sites);
+			if (w.site[0] >= s.hi) w.site[0] -= 2;
+			s.has_walker = true;
+		}
+		walker& w = s.current;
+		site_type t = w.site;
+		const auto& step = lattice_geometry->steps[utl::step_index(gen(), step_count)];
+		for (std::size_t i = 0U; i < N; ++i) t[i] += step.offset[i];
+		++s.steps;
+		// reflect from the walls beyond the ends of the substrate and the spawn sources
+		bool is_outside = std::abs(t[N - 1U]) > w.ceiling + epsilon;
+		for (std::size_t i = 0U; i + 1U < N; ++i) is_outside = is_outside || std::abs(t[i]) > wall;
+		if (is_outside) continue;
+		const slab& owner = (t[0] < s.lo) ? *below : (t[0] >= s.hi) ? *above : s;
+		const std::uint32_t content = content_of(t, owner);
+		if (content != no_index) {
+			// particle did not stick to aggregate, remaining at its site
+			if (coeff_stick < 1.0 && gen() > coeff_stick) {
+				++s.misses;
+				continue;
+			}
+			s.sites[key_of(w.site)] = pending_flag | static_cast<std::uint32_t>(s.attached.size());
+			s.attached.emplace_back(w.site, content);
+			s.top = std::max(s.top, std::abs(w.site[N - 1U]));
+			s.has_walker = false;
+		}
+		else if (&owner != &s) {
+			// hand the walker off to the slab it entered, which drains its inbox in a later phase
+			slabs[(&owner == below) ? k - 1U : k + 1U].inbox[(&owner == below) ? 1U : 0U].push_back(walker{ t, w.ceiling });
+			++s.handoffs;
+			s.has_walker = false;
+		}
+		else w.site = t;
+	}
+}
+
+template<std::size_t N>
+void DLA_decomposed<N>::merge_slab(slab& s, std::size_t n) {
+	aggregate_misses_ += s.misses;
+	walk_steps += s.steps;
+	handoffs += s.handoffs;
+	lost += s.lost;
+	// the attachments of the slab are numbered from the first generation index of the slab
+	const std::size_t first = buffer.size();
+	for (const auto& a : s.attached) {
+		const std::uint64_t key = key_of(a.first);
+		if (size() >= n && !continuous.is_raised()) {
+			s.sites.erase(key);
+			continue;
+		}
+		std::uint32_t contact = a.second;
+		if (contact != attractor_index && (contact & pending_flag)) contact = static_cast<std::uint32_t>(first + (contact & ~pending_flag));
+		s.sites[key] = static_cast<std::uint32_t>(buffer.size());
+		if (track_parents) parents.push_back((contact == attractor_index) ? utl::no_parent : contact);
+		const particle_type p = utl::make_lattice_point<N>(a.first);
+		buffer.push_back(p);
+		++occupied_sites;
+		max_height = std::max(max_height, std::abs(a.first[N - 1U]));
+		const double height = max_height*lattice_geometry->basis[N - 1U][N - 1U];
+		aggregate_span = static_cast<std::size_t>(height);
+		if (recorder.active()) {
+			recorder.accumulate(utl::cartesian_position(p, *lattice_geometry));
+			if (recorder.due(buffer.size())) recorder.record(buffer.size(), height, aggregate_misses_, walk_steps);
+		}
+	}
+	s.attached.clear();
+}
+
+template class DLA_decomposed<2U>;
+template class DLA_decomposed<3U>;
@@ -0,0 +1,264 @@
+#pragma once
+#include "DLAContainer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \class DLA_decomposed
+ *
+ * \brief Defines a diffusion limited aggregate grown on a wide substrate of an `N`-dimensional lattice, i.e. a
+ *        LINE attractor in 2D or a PLANE attractor in 3D, by spatial domain decomposition across threads.
+ *
+ * The substrate is split along the first axis into an even number of slabs, two per thread, each owning the
+ * sites above and below its columns and random walking one walker at a time. Walkers are spawned at random
+ * columns of the whole substrate, as many as there are slabs being walked or awaiting at once, and queued to
+ * the slabs owning the columns, starting at the height of the spawn sources of DLA<N>; each slab thus
+ * receives its share of walkers however long they walk. Alternate slabs advance concurrently for a bounded
+ * number of steps, `sync_interval` per slab, whereupon the other slabs advance; a walker reads the sites of
+ * the slabs either side of its own, which are idle meanwhile, such that these halos are synchronised at
+ * every change of phase. A walker stepping across a slab boundary onto an empty site is handed off to the
+ * inbox of that slab, written by one slab only and drained by its owner in a later phase, such that neither
+ * the hand-offs nor the sites are locked. A handed off walker whose site is occupied by the time it is
+ * drained is lost, counted by lost_walkers(). Walkers reaching the ends of the substrate are reflected as
+ * for DLA<N>.
+ *
+ * The whole is thus DLA fed by as many concurrent walkers as slabs. The attachments of each phase are
+ * numbered in slab order, such that growth is reproducible for a given seed and thread count, and growth
+ * ends with the phase in which the requested size is reached, the attachments beyond it undone. The sites of
+ * each slab are hashed, such that memory is proportional to the deposit rather than the substrate;
+ * substrates and heights are bounded by 2^20 sites in 3D.
+ *
+ * Parent tracking, growth recording and output behave as for the lattice aggregates, the aggregate cache is
+ * not consulted. Instantiated for N = 2 and 3 in DLA_decomposed.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class DLA_decomposed : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of DLA_decomposed must be 2 or 3.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::array<int, N> site_type;
+	typedef std::vector<particle_type> aggregate_buffer_vector;
+public:
+	/**
+	 * \brief Initialises empty aggregate on a substrate of given size, a LINE attractor in 2D or a PLANE
+	 *        attractor in 3D, grown by as many threads as the hardware supports.
+	 *
+	 * \param _substrate_size Number of sites along each axis of the substrate.
+	 * \param ltt [= lattice_type::SQUARE] Type of lattice.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1], the lattice is not defined
+	 *        in N dimensions or the substrate has fewer than 8 or more than 2^20 sites along each axis.
+	 */
+	explicit DLA_decomposed(std::size_t _substrate_size, lattice_type ltt = lattice_type::SQUARE,
+		const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~DLA_decomposed() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing the
+	 *        particles of the aggregate in the order in which they were added.
+	 *
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Sets the number of threads growing the aggregate, two slabs being grown per thread. A change
+	 *        of the number of slabs splits the substrate anew upon the next growth, discarding the walkers.
+	 *
+	 * \param _threads Number of threads, zero for the hardware concurrency.
+	 */
+	void set_thread_count(std::size_t _threads);
+	/**
+	 * \brief Gets the number of threads growing the aggregate.
+	 */
+	std::size_t thread_count() const noexcept;
+	/**
+	 * \brief Gets the number of slabs of the substrate, upon the last growth.
+	 */
+	std::size_t slab_count() const noexcept;
+	/**
+	 * \brief Sets the number of random walk steps of each slab between synchronisations of the halos.
+	 *
+	 * \param _steps Number of steps, at least 1.
+	 * \throw Throws std::invalid_argument exception if _steps is zero.
+	 */
+	void set_sync_interval(std::size_t _steps);
+	/**
+	 * \brief Gets the number of random walk steps of each slab between synchronisations of the halos.
+	 */
+	std::size_t sync_interval() const noexcept;
+	/**
+	 * \brief Gets the number of walkers handed off to another slab.
+	 */
+	std::uint64_t walker_handoffs() const noexcept;
+	/**
+	 * \brief Gets the number of handed off walkers lost to their sites being occupied before they were drained.
+	 */
+	std::size_t lost_walkers() const noexcept;
+	/**
+	 * \copydoc DLAContainer::set_lattice_type(lattice_type)
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is not LINE in 2D or PLANE in 3D, or
+	 *        the substrate has fewer than 8 or more than 2^20 sites along each axis.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \brief Decomposed growth is defined on a substrate with reflecting ends only, the first and last
+	 *        slabs owning the walls beyond them.
+	 *
+	 * \throw Throws std::invalid_argument exception if _periodic is true.
+	 */
+	void set_periodic_boundaries(bool _periodic) override;
+	/**
+	 * \brief Splits the substrate into slabs, placing the particles of any aggregate in the slabs owning
+	 *        them and discarding the walkers.
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the aggregate until it consists of at least the parameterised number of particles,
+	 *        continuing from any existing aggregate and walkers.
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the aggregate particles to an output stream. Without sorting each line is
+	 *        prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// content of a site: empty, the attractor, or the generation index of an aggregate site, which for an
+	// attachment of the current phase is its index among the attachments of its slab tagged by the pending flag
+	static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+	static constexpr std::uint32_t attractor_index = no_index - 1U;
+	static constexpr std::uint32_t pending_flag = std::uint32_t(1U) << 31;
+	/**
+	 * \struct site_hash
+	 *
+	 * \brief Hash of the packed co-ordinates of a site, mixing all bits such that the sites of a deposit
+	 *        spread over the buckets.
+	 */
+	struct site_hash {
+		std::size_t operator()(std::uint64_t key) const noexcept {
+			key = (key ^ (key >> 30))*0xBF58476D1CE4E5B9ULL;
+			key = (key ^ (key >> 27))*0x94D049BB133111EBULL;
+			return static_cast<std::size_t>(key ^ (key >> 31));
+		}
+	};
+	typedef std::unordered_map<std::uint64_t, std::uint32_t, site_hash> site_map;
+	/**
+	 * \struct walker
+	 *
+	 * \brief Random walking particle, reflected beyond the height `ceiling` of its spawn.
+	 */
+	struct walker {
+		site_type site;
+		int ceiling;
+	};
+	/**
+	 * \struct slab
+	 *
+	 * \brief Slab of the substrate of first co-ordinates `lo` to `hi` - 1, owning the sites above and below
+	 *        its columns and its walkers, with its counts and attachments of the current phase.
+	 */
+	struct slab {
+		int lo;
+		int hi;
+		site_map sites;
+		// largest distance along the last axis of any particle of the slab
+		int top;
+		// walker being walked, if any
+		bool has_walker;
+		walker current;
+		// walkers handed off from the slabs below and above along the first axis, and spawned onto its columns
+		std::array<std::deque<walker>, 2U> inbox;
+		std::deque<walker> spawns;
+		// sites of the attachments of the phase and the contents of the sites stepped onto
+		std::vector<std::pair<site_type, std::uint32_t>> attached;
+		std::size_t misses;
+		std::size_t lost;
+		std::uint64_t steps;
+		std::uint64_t handoffs;
+	};
+	std::size_t threads = 1U;
+	std::size_t steps_per_phase;
+	std::vector<slab> slabs;
+	// particles of the aggregate in order of generation
+	aggregate_buffer_vector buffer;
+	// largest co-ordinate magnitude along the last axis of any particle, in lattice units
+	int max_height = 0;
+	std::uint64_t handoffs = 0U;
+	std::size_t lost = 0U;
+	/**
+	 * \brief Packs the co-ordinates of a site into the key of the slab maps.
+	 */
+	static std::uint64_t key_of(const site_type& s) noexcept;
+	/**
+	 * \brief Gets the number of slabs for the current thread count.
+	 */
+	std::size_t slab_count_for_threads() const noexcept;
+	/**
+	 * \brief Gets the slab owning the sites of a first co-ordinate.
+	 */
+	std::size_t slab_of(int x) const noexcept;
+	/**
+	 * \brief Checks that the substrate of given type and size can be decomposed.
+	 *
+	 * \throw Throws std::invalid_argument exception if the attractor type is not LINE in 2D or PLANE in 3D,
+	 *        or the substrate has fewer than 8 or more than 2^20 sites along each axis.
+	 */
+	void check_attractor(attractor_type att, std::size_t att_size) const;
+	/**
+	 * \brief Spawns walkers at random columns of the substrate, queued to the slabs owning them, until as
+	 *        many walkers as slabs are walked or awaiting.
+	 */
+	void spawn_walkers();
+	/**
+	 * \brief Walks the walkers of a slab for up to `steps_per_phase` steps, idling once it has none.
+	 *
+	 * \param k Index of the slab, its stream of the phase.
+	 * \param key Key of the random number streams of the phase.
+	 */
+	void update_slab(std::size_t k, std::uint64_t key);
+	/**
+	 * \brief Numbers the attachments of a slab in the current phase, undoing those beyond the requested size.
+	 */
+	void merge_slab(slab& s, std::size_t n);
+};
+
+typedef DLA_decomposed<2U> DLA_decomposed_2d;
+typedef DLA_decomposed<3U> DLA_decomposed_3d;
+
+extern template class DLA_decomposed<2U>;
+extern template class DLA_decomposed<3U>;
@@ -0,0 +1,475 @@
+#include "Stdafx.h"
+#include "DLA_finite_density.h"
+#include "worker_pool.h"
+#include <thread>
+
+namespace {
+	// smallest side of the box, and of a slab of parallel growth, such that the sites reached by the walkers of
+	// concurrently updated slabs are at least two sites apart
+	constexpr std::size_t min_box_side = 8U;
+	constexpr std::size_t min_slab_width = 4U;
+}
+
+template<std::size_t N>
+constexpr std::size_t DLA_finite_density<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t DLA_finite_density<N>::no_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_finite_density<N>::walker_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_finite_density<N>::attractor_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_finite_density<N>::barred_index;
+template<std::size_t N>
+constexpr std::uint32_t DLA_finite_density<N>::pending_flag;
+template<std::size_t N>
+constexpr std::size_t DLA_finite_density<N>::no_update;
+
+template<std::size_t N>
+DLA_finite_density<N>::DLA_finite_density(double _concentration, std::size_t _box_length, lattice_type ltt,
+	attractor_type att, std::size_t att_size, const double& _coeff_stick, std::uint64_t _seed)
+	: DLAContainer(ltt, att, att_size, _coeff_stick, _seed), box(_box_length) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	set_concentration(_concentration);
+	if (lattice_geometry->sites != utl::lattice_sites::ALL && (box & 1U))
+		throw std::invalid_argument("box length must be even on a lattice with sites of given parity.");
+	if (box < min_box_side || box > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+		throw std::invalid_argument("box length out of range.");
+	check_attractor(att, att_size, *lattice_geometry);
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename DLA_finite_density<N>::aggregate_buffer_vector& DLA_finite_density<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+double DLA_finite_density<N>::get_concentration() const noexcept {
+	return concentration;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::set_concentration(double _concentration) {
+	if (!(_concentration > 0.0 && _concentration <= 0.5))
+		throw std::invalid_argument("concentration must be in interval (0,1/2]");
+	concentration = _concentration;
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::box_length() const noexcept {
+	return box;
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::walker_count() const noexcept {
+	return walkers[0].size();
+}
+
+template<std::size_t N>
+double DLA_finite_density<N>::elapsed_time() const noexcept {
+	return elapsed;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::set_thread_count(std::size_t _threads) {
+	threads = _threads ? _threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::thread_count() const noexcept {
+	return threads;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::set_lattice_type(lattice_type ltt) {
+	// look up and check first such that an invalid lattice type leaves the aggregate unchanged
+	const utl::lattice_descriptor* geometry = &utl::describe_lattice(ltt, static_cast<unsigned>(N));
+	if (geometry->sites != utl::lattice_sites::ALL && (box & 1U))
+		throw std::invalid_argument("box length must be even on a lattice with sites of given parity.");
+	check_attractor(attractor, attractor_size, *geometry);
+	lattice_geometry = geometry;
+	// the walkers are placed anew on the sites of the new lattice upon the next growth
+	if (ltt != lattice) is_attractor_initialised = false;
+	DLAContainer::set_lattice_type(ltt);
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	check_attractor(attr, att_size, *lattice_geometry);
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::initialise_attractor_structure() {
+	is_attractor_initialised = true;
+	attractor_sites = utl::attractor_sites<N>(attractor, attractor_size, *lattice_geometry);
+	std::size_t count = 1U;
+	for (std::size_t i = 0U; i < N; ++i) {
+		stride[i] = count;
+		count *= box;
+	}
+	grid.assign(count, no_index);
+	// bar the sites off the side of a single spawn source
+	if (!(is_spawn_source_above && is_spawn_source_below)) {
+		const int offset = static_cast<int>(box / 2U);
+		utl::for_each_node<N>(box, [&](std::size_t node, const std::array<std::size_t, N>& j) {
+			site_type s;
+			for (std::size_t i = 0U; i < N; ++i) s[i] = static_cast<int>(j[i]) - offset;
+			if (!is_source_site(s)) grid[node] = barred_index;
+		});
+	}
+	for (const auto& s : attractor_sites) grid[node_of(box_site_of(s))] = attractor_index;
+	// the aggregate is measured anew from an attractor or lattice changed since the last growth
+	max_distance = 0.0;
+	for (std::size_t i = 0U; i < buffer.size(); ++i) {
+		grid[node_of(box_site_of(utl::coordinates_of(buffer[i])))] = static_cast<std::uint32_t>(i);
+		max_distance = std::max(max_distance, utl::real_space_distance(buffer[i], attractor, attractor_size, *lattice_geometry));
+	}
+	fill_bath();
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	max_distance = 0.0;
+	elapsed = 0.0;
+	// the box is filled anew about the bare attractor upon the next growth
+	grid.clear();
+	for (auto& w : walkers) w.clear();
+	drawn_update = no_update;
+	if (!reuse_storage) {
+		buffer.shrink_to_fit();
+		grid.shrink_to_fit();
+		for (auto& w : walkers) w.shrink_to_fit();
+	}
+	is_attractor_initialised = false;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	// the aggregate grows by at most the walkers of the bath
+	const std::size_t new_cap = grown_capacity(std::min(n, size() + walker_count()), buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		buffer.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	if (recorder.active()) recorder.start_clock();
+	if (threads > 1U) update_in_parallel(n);
+	else update_serially(n);
+	if (recorder.active()) recorder.stop_clock();
+}
+
+template<std::size_t N>
+double DLA_finite_density<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	return utl::estimate_fractal_dimension(size(), max_distance, attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& DLA_finite_density<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::node_of(const site_type& s) const noexcept {
+	std::size_t node = 0U;
+	for (std::size_t i = 0U; i < N; ++i) node += static_cast<std::size_t>(s[i])*stride[i];
+	return node;
+}
+
+template<std::size_t N>
+std::size_t DLA_finite_density<N>::walker_node(std::size_t w) const noexcept {
+	std::size_t node = 0U;
+	for (std::size_t i = 0U; i < N; ++i) node += static_cast<std::size_t>(walkers[i][w])*stride[i];
+	return node;
+}
+
+template<std::size_t N>
+typename DLA_finite_density<N>::site_type DLA_finite_density<N>::box_site_of(const site_type& s) const noexcept {
+	const int side = static_cast<int>(box);
+	site_type t;
+	for (std::size_t i = 0U; i < N; ++i) t[i] = ((s[i] + side / 2) % side + side) % side;
+	return t;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::check_attractor(attractor_type att, std::size_t att_size, const utl::lattice_descriptor& geometry) const {
+	if (N == 2U && att == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DLA_finite_density to PLANE.");
+	// a LINE or PLANE may span the box, its ends meeting across the faces
+	if ((att == attractor_type::LINE || att == attractor_type::PLANE) && att_size > box)
+		throw std::invalid_argument("attractor size must not exceed the box length.");
+	if (att == attractor_type::CIRCLE) {
+		// the circle is drawn in Cartesian space, reaching beyond its radius in co-ordinates on a sheared or scaled lattice
+		int reach = 0;
+		for (const auto& s : utl::attractor_sites<N>(att, att_size, geometry))
+			for (int x : s) reach = std::max(reach, std::abs(x));
+		if (static_cast<std::size_t>(reach) + 1U >= box / 2U)
+			throw std::invalid_argument("circle attractor must lie within the box.");
+	}
+}
+
+template<std::size_t N>
+bool DLA_finite_density<N>::is_source_site(const site_type& s) const noexcept {
+	if (is_spawn_source_above && is_spawn_source_below) return true;
+	if (attractor == attractor_type::CIRCLE) {
+		// inside or outside the circle as drawn in Cartesian space
+		const double r2 = utl::real_space_distance(s, attractor_type::POINT, 0U, *lattice_geometry);
+		const double radius2 = static_cast<double>(attractor_size)*static_cast<double>(attractor_size);
+		return is_spawn_source_above ? r2 >= radius2 : r2 < radius2;
+	}
+	return is_spawn_source_above ? s[N - 1U] >= 0 : s[N - 1U] <= 0;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::fill_bath() {
+	for (auto& w : walkers) w.clear();
+	drawn_update = no_update;
+	// count the empty lattice sites open to the walkers
+	std::size_t open_sites = 0U;
+	const int half = static_cast<int>(box / 2U);
+	utl::for_each_node<N>(box, [&](std::size_t node, const std::array<std::size_t, N>& j) {
+		if (grid[node] != no_index) return;
+		site_type s;
+		for (std::size_t i = 0U; i < N; ++i) s[i] = static_cast<int>(j[i]) - half;
+		const site_type snapped = s;
+		utl::snap_to_lattice(s, lattice_geometry->sites);
+		if (s == snapped) ++open_sites;
+	});
+	const std::size_t count = static_cast<std::size_t>(std::llround(concentration*open_sites));
+	for (auto& w : walkers) w.reserve(count);
+	// place each walker at a random empty lattice site, drawn by rejection as at most half the open sites are taken
+	for (std::size_t k = 0U; k < count; ++k) {
+		site_type s;
+		std::size_t node;
+		do {
+			for (auto& x : s) x = static_cast<int>(utl::step_index(pr_gen(), box)) - half;
+			utl::snap_to_lattice(s, lattice_geometry->sites);
+			s = box_site_of(s);
+			node = node_of(s);
+		} while (grid[node] != no_index);
+		grid[node] = walker_index;
+		for (std::size_t i = 0U; i < N; ++i) walkers[i].push_back(s[i]);
+	}
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::remove_walker(std::size_t w) noexcept {
+	for (auto& coordinate : walkers) {
+		coordinate[w] = coordinate.back();
+		coordinate.pop_back();
+	}
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::attach(const site_type& s, std::uint32_t contact) {
+	grid[node_of(s)] = static_cast<std::uint32_t>(buffer.size());
+	if (track_parents) parents.push_back((contact == attractor_index) ? utl::no_parent : contact);
+	site_type c;
+	for (std::size_t i = 0U; i < N; ++i) c[i] = s[i] - static_cast<int>(box / 2U);
+	const particle_type p = utl::make_lattice_point<N>(c);
+	buffer.push_back(p);
+	++occupied_sites;
+	max_distance = std::max(max_distance, utl::real_space_distance(p, attractor, attractor_size, *lattice_geometry));
+	const double circle_offset = (N == 2U && attractor == attractor_type::CIRCLE) ? static_cast<double>(attractor_size) : 0.0;
+	aggregate_span = (max_distance > circle_offset) ? static_cast<std::size_t>(max_distance - circle_offset) : 0U;
+	if (recorder.active()) {
+		recorder.accumulate(utl::cartesian_position(p, *lattice_geometry));
+		if (recorder.due(buffer.size())) {
+			// linear distance from a 2D line or a plane, squared distance otherwise
+			const bool is_linear = attractor == ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE);
+			recorder.record(buffer.size(), is_linear ? max_distance : std::sqrt(max_distance), aggregate_misses_, walk_steps);
+		}
+	}
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::update_serially(std::size_t n) {
+	const int side = static_cast<int>(box);
+	const std::size_t step_count = lattice_geometry->step_count;
+	// a single draw over the pairs of walker and lattice step gives an update, the next update being drawn before
+	// the current one such that the co-ordinates of its walker are fetched from memory meanwhile
+	std::size_t update = drawn_update;
+	if (update / step_count >= walker_count() && walker_count() > 0U) update = utl::step_index(pr_gen(), walker_count()*step_count);
+	// attempts since the bath last changed, added to the elapsed time per walker once it changes
+	std::uint64_t attempts = 0U;
+	while ((size() < n || continuous.is_raised()) && walker_count() > 0U) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		const std::size_t w = update / step_count;
+		const auto& step = lattice_geometry->steps[update % step_count];
+		std::size_t next = utl::step_index(pr_gen(), walker_count()*step_count);
+		for (const auto& coordinate : walkers) utl::prefetch(coordinate.data() + next / step_count);
+		++walk_steps;
+		++attempts;
+		site_type s;
+		site_type t;
+		for (std::size_t i = 0U; i < N; ++i) {
+			s[i] = walkers[i][w];
+			t[i] = s[i] + step.offset[i];
+			if (t[i] < 0) t[i] += side;
+			else if (t[i] >= side) t[i] -= side;
+		}
+		const std::size_t target = node_of(t);
+		const std::uint32_t content = grid[target];
+		if (content == no_index) {
+			grid[node_of(s)] = no_index;
+			grid[target] = walker_index;
+			for (std::size_t i = 0U; i < N; ++i) walkers[i][w] = t[i];
+		}
+		// step onto the aggregate or attractor, exclusion by other walkers and barred sites rejecting the step
+		else if (content != walker_index && content != barred_index) {
+			// particle did not stick to aggregate, remaining at its site
+			if (coeff_stick < 1.0 && pr_gen() > coeff_stick) ++aggregate_misses_;
+			else {
+				elapsed += static_cast<double>(attempts) / walker_count();
+				attempts = 0U;
+				attach(s, content);
+				remove_walker(w);
+				// a draw of a walker beyond the bath is redrawn, leaving the draw uniform over the walkers
+				if (next / step_count >= walker_count() && walker_count() > 0U)
+					next = utl::step_index(pr_gen(), walker_count()*step_count);
+			}
+		}
+		update = next;
+	}
+	if (attempts > 0U) elapsed += static_cast<double>(attempts) / walker_count();
+	// the update drawn next is kept for the next growth
+	drawn_update = update;
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::update_in_parallel(std::size_t n) {
+	// an even number of slabs along the last axis, two per thread, of which alternate slabs are updated at once
+	std::size_t slab_count = 2U*threads;
+	while (slab_count > 2U && box / slab_count < min_slab_width) slab_count -= 2U;
+	slabs.resize(slab_count);
+	for (std::size_t k = 0U; k < slab_count; ++k) {
+		slabs[k].lo = static_cast<int>(k*box / slab_count);
+		slabs[k].hi = static_cast<int>((k + 1U)*box / slab_count);
+	}
+	// serial updates continue from an update drawn anew
+	drawn_update = no_update;
+	while ((size() < n || continuous.is_raised()) && walker_count() > 0U) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		for (std::size_t parity = 0U; parity < 2U && (size() < n || continuous.is_raised()); ++parity) {
+			// the streams of the phase are keyed by a draw of the aggregate generator, such that growth is
+			// reproducible for a given seed and number of slabs
+			const std::uint64_t key = static_cast<std::uint64_t>(pr_gen()*9007199254740992.0);
+			const std::size_t walkers_before = walker_count();
+			for (auto& s : slabs) s.walkers.clear();
+			for (std::size_t w = 0U; w < walkers_before; ++w) {
+				const std::size_t k = ((walkers[N - 1U][w] + 1U)*slab_count - 1U) / box;
+				if ((k & 1U) == parity) slabs[k].walkers.push_back(static_cast<std::uint32_t>(w));
+			}
+			std::size_t attempts = 0U;
+			for (std::size_t k = parity; k < slab_count; k += 2U) attempts += slabs[k].walkers.size();
+			utl::parallel_for(slab_count / 2U, threads, [this, key, parity](std::size_t m) {
+				const std::size_t k = 2U*m + parity;
+				update_slab(slabs[k], key, k);
+			});
+			// number the attachments in slab order, undoing those beyond the requested size
+			is_attached.assign(walkers_before, 0U);
+			bool any_attached = false;
+			for (std::size_t k = parity; k < slab_count; k += 2U) {
+				slab& s = slabs[k];
+				aggregate_misses_ += s.misses;
+				walk_steps += s.steps;
+				for (const attachment& a : s.attachments) {
+					if (size() >= n && !continuous.is_raised()) {
+						grid[a.node] = walker_index;
+						continue;
+					}
+					// a pending contact was numbered before, being earlier in the same slab
+					std::uint32_t contact = a.parent;
+					if (contact < barred_index && (contact & pending_flag))
+						contact = grid[walker_node(contact & ~pending_flag)];
+					site_type site;
+					for (std::size_t i = 0U; i < N; ++i) site[i] = walkers[i][a.walker];
+					attach(site, contact);
+					is_attached[a.walker] = 1U;
+					any_attached = true;
+				}
+			}
+			elapsed += static_cast<double>(attempts) / walkers_before;
+			// remove the attached walkers from the bath, keeping the order of the remaining walkers
+			if (any_attached) {
+				std::size_t kept = 0U;
+				for (std::size_t w = 0U; w < walkers_before; ++w) {
+					if (is_attached[w]) continue;
+					for (auto& coordinate : walkers) coordinate[kept] = coordinate[w];
+					++kept;
+				}
+				for (auto& coordinate : walkers) coordinate.resize(kept);
+			}
+		}
+	}
+}
+
+template<std::size_t N>
+void DLA_finite_density<N>::update_slab(slab& s, std::uint64_t key, std::size_t index) {
+	utl::uniform_random_probability_generator<double, utl::philox4x32> gen(utl::philox4x32(key, index));
+	s.attachments.clear();
+	s.misses = 0U;
+	s.steps = 0U;
+	const int side = static_cast<int>(box);
+	const std::size_t step_count = lattice_geometry->step_count;
+	// walkers move within the slab and the layers either side of it
+	const int below = (s.lo > 0) ? s.lo - 1 : side - 1;
+	const int above = (s.hi < side) ? s.hi : 0;
+	const auto is_reachable = [&s, below, above](int x) { return (x >= s.lo && x < s.hi) || x == below || x == above; };
+	std::vector<std::uint32_t>& bath = s.walkers;
+	const std::size_t attempts = bath.size();
+	for (std::size_t a = 0U; a < attempts && !bath.empty(); ++a) {
+		const std::size_t update = utl::step_index(gen(), bath.size()*step_count);
+		const std::size_t slot = update / step_count;
+		const std::uint32_t w = bath[slot];
+		const auto& step = lattice_geometry->steps[update % step_count];
+		++s.steps;
+		site_type from;
+		site_type t;
+		for (std::size_t i = 0U; i < N; ++i) {
+			from[i] = walkers[i][w];
+			t[i] = from[i] + step.offset[i];
+			if (t[i] < 0) t[i] += side;
+			else if (t[i] >= side) t[i] -= side;
+		}
+		if (!is_reachable(t[N - 1U])) continue;
+		const std::size_t target = node_of(t);
+		const std::uint32_t content = grid[target];
+		if (content == no_index) {
+			grid[node_of(from)] = no_index;
+			grid[target] = walker_index;
+			for (std::size_t i = 0U; i < N; ++i) walkers[i][w] = t[i];
+		}
+		else if (content != walker_index && content != barred_index) {
+			if (coeff_stick < 1.0 && gen() > coeff_stick) ++s.misses;
+			else {
+				// the site holds the walker until the attachments of the phase are numbered
+				const std::size_t node = node_of(from);
+				grid[node] = pending_flag | w;
+				s.attachments.push_back(attachment{ node, w, content });
+				bath[slot] = bath.back();
+				bath.pop_back();
+			}
+		}
+	}
+}
+
+template class DLA_finite_density<2U>;
+template class DLA_finite_density<3U>;
@@ -0,0 +1,276 @@
+#pragma once
+#include "DLAContainer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * \class DLA_finite_density
+ *
+ * \brief Defines a diffusion limited aggregate grown from a bath of walkers at finite concentration in a
+ *        periodic box of an `N`-dimensional lattice.
+ *
+ * Upon initialising the attractor the box is filled with walkers at random empty sites, a fraction
+ * `concentration` of the empty sites on the side of the spawn sources (the half-space along the last axis,
+ * or the outside (above) or inside (below) of a CIRCLE attractor) being occupied. For a single spawn source
+ * the walkers are confined to its side, steps off it being rejected. The walkers diffuse at
+ * once by random sequential updates: a walker chosen uniformly at random attempts a random lattice step,
+ * which is rejected if another walker occupies the site, such that no two walkers overlap. A walker
+ * stepping onto the aggregate or attractor sticks at its site with probability `coeff_stick`, counting a
+ * miss otherwise, and leaves the bath. Growth ends once the aggregate has the requested size or the bath is
+ * exhausted; the bath is not replenished. The zero-density limit is the single walker of DLA<N>.
+ *
+ * The walkers are held as arrays of each co-ordinate and the box as a grid of the contents of every site,
+ * the generation index of an aggregate site or a walker tag, such that both exclusion and contact are found
+ * by a single lookup. The elapsed time counts attempted steps per walker.
+ *
+ * With more than one thread the box is split along the last axis into an even number of slabs, two per
+ * thread. The walkers of alternate slabs are updated concurrently for one step per walker, each slab drawing
+ * its own stream of random numbers and its walkers moving at most one site beyond it, whereupon the other
+ * slabs are updated; the attachments of each phase are numbered in slab order. Growth is thus reproducible
+ * for a given seed and thread count, a single thread giving exact random sequential updates. A parallel
+ * growth ends with the phase in which the requested size is reached, the attachments beyond it undone.
+ *
+ * The attractor geometries of DLA<N> are placed at the centre of the box, and particles are written in
+ * co-ordinates from -L/2 to L/2 - 1 for a box of side L, an aggregate spanning the box being wrapped about
+ * its faces. Instantiated for N = 2 and 3 in DLA_finite_density.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class DLA_finite_density : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of DLA_finite_density must be 2 or 3.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::array<int, N> site_type;
+	typedef std::vector<particle_type> aggregate_buffer_vector;
+public:
+	/**
+	 * \brief Initialises empty aggregate in a periodic box, the bath of walkers being filled upon the
+	 *        first growth.
+	 *
+	 * \param _concentration Fraction of the empty sites on the side of the spawn sources occupied by walkers.
+	 * \param _box_length Side of the periodic box, in lattice units.
+	 * \param ltt [= lattice_type::SQUARE] Type of lattice.
+	 * \param att [= attractor_type::POINT] Type of attractor.
+	 * \param att_size [= 1] Size of attractor.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _concentration not in (0,1/2], _coeff_stick not
+	 *        in (0,1], the lattice is not defined in N dimensions, the box has an odd side on a lattice
+	 *        with sites of given parity or fewer than 8 sites along each axis, or the attractor type
+	 *        is PLANE in 2D or does not fit within the box.
+	 */
+	DLA_finite_density(double _concentration, std::size_t _box_length, lattice_type ltt = lattice_type::SQUARE,
+		attractor_type att = attractor_type::POINT, std::size_t att_size = 1U, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~DLA_finite_density() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing the
+	 *        particles of the aggregate in the order in which they were added.
+	 *
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the concentration at which the bath is filled.
+	 */
+	double get_concentration() const noexcept;
+	/**
+	 * \brief Sets the concentration at which the bath is filled, applying from the next filling.
+	 *
+	 * \param _concentration Fraction of the empty sites on the side of the spawn sources occupied by walkers.
+	 * \throw Throws std::invalid_argument exception if _concentration not in (0,1/2].
+	 */
+	void set_concentration(double _concentration);
+	/**
+	 * \brief Gets the side of the periodic box, in lattice units.
+	 */
+	std::size_t box_length() const noexcept;
+	/**
+	 * \brief Gets the number of walkers remaining in the bath.
+	 */
+	std::size_t walker_count() const noexcept;
+	/**
+	 * \brief Gets the elapsed time of the growth, in attempted steps per walker.
+	 */
+	double elapsed_time() const noexcept;
+	/**
+	 * \brief Sets the number of threads updating the walkers, one by default.
+	 *
+	 * \param _threads Number of threads, zero for the hardware concurrency.
+	 */
+	void set_thread_count(std::size_t _threads);
+	/**
+	 * \brief Gets the number of threads updating the walkers.
+	 */
+	std::size_t thread_count() const noexcept;
+	/**
+	 * \copydoc DLAContainer::set_lattice_type(lattice_type)
+	 * \throw Throws std::invalid_argument exception if the box has an odd side on a lattice with sites of
+	 *        given parity.
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is PLANE in 2D or the attractor
+	 *        does not fit within the box.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \brief Places the attractor and any aggregate in the box and fills the bath of walkers anew, for
+	 *        the current concentration and spawn sources.
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the aggregate until it consists of the parameterised number of particles, continuing
+	 *        from any existing aggregate and bath, or until the bath is exhausted.
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the aggregate particles to an output stream. Without sorting each line is
+	 *        prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// content of a site: empty, a walker, the attractor, a site barred to walkers, the generation index of an
+	// aggregate site, or the walker of an attachment pending in the current phase tagged by the pending flag
+	static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+	static constexpr std::uint32_t walker_index = no_index - 1U;
+	static constexpr std::uint32_t attractor_index = no_index - 2U;
+	static constexpr std::uint32_t barred_index = no_index - 3U;
+	static constexpr std::uint32_t pending_flag = std::uint32_t(1U) << 31;
+	// update of no draw
+	static constexpr std::size_t no_update = std::numeric_limits<std::size_t>::max();
+	/**
+	 * \struct attachment
+	 *
+	 * \brief Attachment of a walker pending in a phase of parallel growth, its parent being the content of
+	 *        the site it stepped onto.
+	 */
+	struct attachment {
+		std::size_t node;
+		std::uint32_t walker;
+		std::uint32_t parent;
+	};
+	/**
+	 * \struct slab
+	 *
+	 * \brief Slab of the box along the last axis, of co-ordinates `lo` to `hi` - 1, with the walkers within
+	 *        it at the start of a phase and its counts and attachments of the phase.
+	 */
+	struct slab {
+		int lo;
+		int hi;
+		std::vector<std::uint32_t> walkers;
+		std::vector<attachment> attachments;
+		std::size_t misses;
+		std::uint64_t steps;
+	};
+	double concentration;
+	std::size_t box;
+	std::size_t threads = 1U;
+	std::array<std::size_t, N> stride = {};
+	// sites of attractor, centred on the origin
+	std::vector<site_type> attractor_sites;
+	// particles of the aggregate in order of generation
+	aggregate_buffer_vector buffer;
+	// content of every site of the box
+	std::vector<std::uint32_t> grid;
+	// co-ordinates of the walkers from 0 to `box` - 1 along each axis
+	std::array<std::vector<std::int32_t>, N> walkers;
+	// walker and lattice step drawn for the next serial update, none if the bath was filled anew since
+	std::size_t drawn_update = no_update;
+	// flags of walkers attached in the current phase of parallel growth
+	std::vector<std::uint8_t> is_attached;
+	std::vector<slab> slabs;
+	// largest distance of any particle from the attractor in real space, as given by utl::real_space_distance
+	double max_distance = 0.0;
+	double elapsed = 0.0;
+	/**
+	 * \brief Computes the index in the grid of a site of co-ordinates from 0 to `box` - 1.
+	 */
+	std::size_t node_of(const site_type& s) const noexcept;
+	/**
+	 * \brief Wraps a site of centred co-ordinates into the box, to co-ordinates from 0 to `box` - 1.
+	 */
+	site_type box_site_of(const site_type& s) const noexcept;
+	/**
+	 * \brief Checks that the attractor of given type and size fits within the box on the given lattice.
+	 *
+	 * \throw Throws std::invalid_argument exception if the attractor type is PLANE in 2D, a LINE or PLANE
+	 *        exceeds the side of the box or a CIRCLE reaches its faces.
+	 */
+	void check_attractor(attractor_type att, std::size_t att_size, const utl::lattice_descriptor& geometry) const;
+	/**
+	 * \brief Computes the index in the grid of the site of a walker.
+	 */
+	std::size_t walker_node(std::size_t w) const noexcept;
+	/**
+	 * \brief Gets whether a site of centred co-ordinates lies on the side of the spawn sources.
+	 */
+	bool is_source_site(const site_type& s) const noexcept;
+	/**
+	 * \brief Fills the bath with walkers at random empty sites on the side of the spawn sources.
+	 */
+	void fill_bath();
+	/**
+	 * \brief Removes a walker from the bath by moving the last walker into its place.
+	 */
+	void remove_walker(std::size_t w) noexcept;
+	/**
+	 * \brief Adds the particle on a site to the aggregate.
+	 *
+	 * \param s Site of co-ordinates from 0 to `box` - 1.
+	 * \param contact Generation index of the particle stuck to, or the attractor index.
+	 */
+	void attach(const site_type& s, std::uint32_t contact);
+	/**
+	 * \brief Updates the walkers by random sequential updates on the calling thread.
+	 */
+	void update_serially(std::size_t n);
+	/**
+	 * \brief Updates the walkers of alternate slabs concurrently, one phase of each parity per round.
+	 */
+	void update_in_parallel(std::size_t n);
+	/**
+	 * \brief Updates the walkers of a slab for one attempted step per walker.
+	 *
+	 * \param s Slab.
+	 * \param key Key of the random number streams of the phase.
+	 * \param index Index of the slab, its stream of the phase.
+	 */
+	void update_slab(slab& s, std::uint64_t key, std::size_t index);
+};
+
+typedef DLA_finite_density<2U> DLA_finite_density_2d;
+typedef DLA_finite_density<3U> DLA_finite_density_3d;
+
+extern template class DLA_finite_density<2U>;
+extern template class DLA_finite_density<3U>;
@@ -0,0 +1,483 @@
+#include "Stdafx.h"
+#include "DLA_off_lattice.h"
+
+namespace {
+	// contact distance of the centres of two particles of unit diameter
+	constexpr double contact_distance = 1.0;
+	// distance of the spawn surface beyond the furthest particle, and tolerance of the boundary beyond it
+	constexpr double spawn_offset = 4.0;
+	constexpr double boundary_epsilon = 2.0;
+	// side of the cells of the cell list, such that a search for the nearest particle spans few cells
+	constexpr double cell_side = 2.0;
+	// side of the cells of each level of coarse grid
+	constexpr std::size_t coarse_levels = 4U;
+	constexpr double coarse_side[coarse_levels] = { 4.0, 16.0, 64.0, 256.0 };
+
+	template<std::size_t N>
+	double distance_squared(const std::array<double, N>& a, const std::array<double, N>& b) noexcept {
+		double d2 = 0.0;
+		for (std::size_t i = 0U; i < N; ++i) d2 += (a[i] - b[i])*(a[i] - b[i]);
+		return d2;
+	}
+	template<std::size_t N>
+	std::array<int, N> cell_of(const std::array<double, N>& p) noexcept {
+		std::array<int, N> cell;
+		for (std::size_t i = 0U; i < N; ++i) cell[i] = static_cast<int>(std::floor(p[i] / cell_side));
+		return cell;
+	}
+	template<std::size_t N>
+	std::array<int, N + 1U> coarse_cell_of(const std::array<double, N>& p, std::size_t level, double side) noexcept {
+		std::array<int, N + 1U> cell;
+		for (std::size_t i = 0U; i < N; ++i) cell[i] = static_cast<int>(std::floor(p[i] / side));
+		cell[N] = static_cast<int>(level);
+		return cell;
+	}
+}
+
+template<std::size_t N>
+constexpr std::size_t DLA_off_lattice<N>::dimension;
+template<std::size_t N>
+constexpr double DLA_off_lattice<N>::min_step_length;
+template<std::size_t N>
+constexpr std::size_t DLA_off_lattice<N>::attractor_flag;
+template<std::size_t N>
+constexpr std::size_t DLA_off_lattice<N>::end_of_cell;
+template<std::size_t N>
+constexpr double DLA_off_lattice<N>::search_radius;
+
+template<std::size_t N>
+DLA_off_lattice<N>::DLA_off_lattice(const double& _coeff_stick, std::uint64_t _seed, utl::memory_resource* _resource)
+	: DLAContainer(_coeff_stick, _seed), buffer(_resource), attractor_particles(_resource), cell_heads(_resource),
+	next_in_cell(_resource), next_attractor_in_cell(_resource), coarse_cells(_resource) {}
+
+template<std::size_t N>
+DLA_off_lattice<N>::DLA_off_lattice(attractor_type att, std::size_t att_size, const double& _coeff_stick, std::uint64_t _seed,
+	utl::memory_resource* _resource) : DLAContainer(lattice_type::SQUARE, att, att_size, _coeff_stick, _seed),
+	buffer(_resource), attractor_particles(_resource), cell_heads(_resource), next_in_cell(_resource),
+	next_attractor_in_cell(_resource), coarse_cells(_resource) {
+	if (N == 2U && att == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DLA to PLANE.");
+	initialise_attractor_structure();
+}
+
+template<std::size_t N>
+DLA_off_lattice<N>::DLA_off_lattice(const DLA_off_lattice& other) : DLAContainer(other),
+	buffer(other.buffer), attractor_particles(other.attractor_particles), cell_heads(other.cell_heads),
+	next_in_cell(other.next_in_cell), next_attractor_in_cell(other.next_attractor_in_cell),
+	coarse_cells(other.coarse_cells), extent_min(other.extent_min), extent_max(other.extent_max) {}
+
+template<std::size_t N>
+DLA_off_lattice<N>::DLA_off_lattice(DLA_off_lattice&& other) noexcept : DLAContainer(std::move(other)),
+	buffer(std::move(other.buffer)), attractor_particles(std::move(other.attractor_particles)),
+	cell_heads(std::move(other.cell_heads)), next_in_cell(std::move(other.next_in_cell)),
+	next_attractor_in_cell(std::move(other.next_attractor_in_cell)), coarse_cells(std::move(other.coarse_cells)), extent_min(other.extent_min),
+	extent_max(other.extent_max), notifier(std::move(other.notifier)) {}
+
+template<std::size_t N>
+std::size_t DLA_off_lattice<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename DLA_off_lattice<N>::aggregate_buffer_vector& DLA_off_lattice<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+utl::memory_resource* DLA_off_lattice<N>::get_memory_resource() const noexcept {
+	return buffer.get_allocator().resource();
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::add_observer(std::shared_ptr<utl::attachment_observer<particle_type>> observer, std::size_t batch_size,
+	std::chrono::microseconds interval, utl::dispatch_mode mode) {
+	notifier.add(std::move(observer), batch_size, interval, mode, buffer.size());
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::remove_observer(const std::shared_ptr<utl::attachment_observer<particle_type>>& observer) {
+	notifier.remove(observer);
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::set_lattice_type(lattice_type) {
+	throw std::invalid_argument("off-lattice DLA has no lattice type.");
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	if (N == 2U && attr == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D DLA to PLANE.");
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::initialise_attractor_structure() {
+	// remove any current attractor particles, retaining the aggregate particles in the cell list
+	cell_heads.clear();
+	coarse_cells.clear();
+	attractor_particles.clear();
+	next_attractor_in_cell.clear();
+	is_attractor_initialised = true;
+	particle_type centre = {};
+	// number of particles along each side of a line or plane, centred on the origin
+	const std::size_t count = std::max<std::size_t>(1U, attractor_size);
+	const double first = -0.5*(count - 1U);
+	switch (attractor) {
+	case attractor_type::POINT:	// single particle at origin
+		attractor_particles.push_back(centre);
+		break;
+	case attractor_type::LINE:	// row of att_size touching particles along x
+		for (std::size_t i = 0U; i < count; ++i) {
+			centre[0] = first + i;
+			attractor_particles.push_back(centre);
+		}
+		break;
+	case attractor_type::PLANE:	// square array of att_size^2 touching particles in the xy-plane
+		for (std::size_t i = 0U; i < count; ++i) {
+			for (std::size_t j = 0U; j < count; ++j) {
+				centre[0] = first + i;
+				centre[1] = first + j;
+				attractor_particles.push_back(centre);
+			}
+		}
+		break;
+	case attractor_type::CIRCLE: {	// ring of touching particles of radius att_size in the xy-plane
+		const std::size_t count = std::max<std::size_t>(1U, static_cast<std::size_t>(std::ceil(2.0*M_PI*attractor_size)));
+		for (std::size_t i = 0U; i < count; ++i) {
+			const double theta = 2.0*M_PI*i / count;
+			centre[0] = attractor_size*std::cos(theta);
+			centre[1] = attractor_size*std::sin(theta);
+			attractor_particles.push_back(centre);
+		}
+		break;
+	}
+	}
+	extent_min = std::numeric_limits<double>::max();
+	extent_max = 0.0;
+	for (std::size_t i = 0U; i < attractor_particles.size(); ++i) {
+		next_attractor_in_cell.push_back(end_of_cell);
+		insert_into_cells(attractor_particles[i], i | attractor_flag);
+	}
+	next_in_cell.assign(buffer.size(), end_of_cell);
+	for (std::size_t i = 0U; i < buffer.size(); ++i) insert_into_cells(buffer[i], i);
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	next_in_cell.clear();
+	// the attractor particles are re-inserted into the emptied cell list upon the next growth
+	cell_heads.clear();
+	coarse_cells.clear();
+	is_attractor_initialised = false;
+	if (!reuse_storage && *get_memory_resource() == *utl::new_delete_resource()) {
+		buffer.shrink_to_fit();
+		next_in_cell.shrink_to_fit();
+	}
+	notifier.reset(0U);
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		cell_heads.reserve(new_cap);
+		buffer.reserve(new_cap);
+		next_in_cell.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	particle_type w = {};
+	particle_type prev = w;
+	particle_type u;
+	bool has_next_spawned = false;
+	double spawn_radius = 0.0;
+	if (recorder.active()) recorder.start_clock();
+	while (size() < n || continuous.is_raised()) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		if (!has_next_spawned) {
+			spawn_particle(w, spawn_radius);
+			// respawn a walker placed onto a particle, e.g. at the centre of a filled circle
+			if (nearest_distance_squared(w) < contact_distance*contact_distance) continue;
+			has_next_spawned = true;
+		}
+		prev = w;
+		// free distance: to the region spanned by the aggregate and attractor if far from it, else to
+		// the nearest occupied coarse cell or particle
+		const double e = extent(w);
+		double free = std::max(e - extent_max, extent_min - e) - contact_distance;
+		if (free < coarse_side[coarse_levels - 1U]) free = std::max(free, free_distance(w));
+		random_direction(u);
+		++walk_steps;
+		if (free >= min_step_length) {
+			for (std::size_t i = 0U; i < N; ++i) w[i] += free*u[i];
+		}
+		else {
+			// near contact: resolve a step of minimal length exactly against every particle in reach
+			double t = 0.0;
+			const std::size_t hit = first_contact(w, u, min_step_length, t);
+			if (hit != end_of_cell) {
+				// particle did not stick to aggregate, walker remains at its position
+				if (pr_gen() > coeff_stick) {
+					++aggregate_misses_;
+					continue;
+				}
+				for (std::size_t i = 0U; i < N; ++i) w[i] += t*u[i];
+				push_particle(w, (hit & attractor_flag) ? utl::no_parent : hit);
+				has_next_spawned = false;
+				continue;
+			}
+			for (std::size_t i = 0U; i < N; ++i) w[i] += min_step_length*u[i];
+		}
+		// reflect walker from the boundary enclosing the spawn surface
+		if (is_outside(w, spawn_radius)) w = prev;
+	}
+	if (recorder.active()) recorder.stop_clock();
+	// deliver any partial batches such that observers see every particle of this generation
+	if (notifier.active()) notifier.flush(buffer);
+}
+
+template<std::size_t N>
+double DLA_off_lattice<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	return utl::estimate_fractal_dimension(size(), max_attractor_distance(), attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& DLA_off_lattice<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+double DLA_off_lattice<N>::extent(const particle_type& p) const noexcept {
+	switch (attractor) {
+	case attractor_type::LINE:
+		return (N == 2U) ? std::abs(p[1]) : std::sqrt(p[1]*p[1] + p[N - 1U]*p[N - 1U]);
+	case attractor_type::PLANE:
+		return std::abs(p[N - 1U]);
+	default:
+		return std::sqrt(distance_squared(p, particle_type{}));
+	}
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::spawn_particle(particle_type& w, double& spawn_radius) noexcept {
+	spawn_radius = std::max(extent_max, extent_min) + spawn_offset;
+	// sign of the last co-ordinate, which is confined to the upper : lower half-space for a single source
+	const double side = (is_spawn_source_above && is_spawn_source_below) ? 0.0 : (is_spawn_source_above ? 1.0 : -1.0);
+	particle_type u;
+	switch (attractor) {
+	case attractor_type::LINE:
+		// on the lines (2D) or cylinder (3D) at spawn_radius from the attractor, along its length
+		random_direction(u);
+		w[0] = attractor_size*(pr_gen() - 0.5);
+		if (N == 2U) w[1] = spawn_radius*((side != 0.0) ? side : (u[0] < 0.0 ? -1.0 : 1.0));
+		else {
+			const double norm = std::sqrt(u[1]*u[1] + u[N - 1U]*u[N - 1U]);
+			w[1] = spawn_radius*u[1] / norm;
+			w[N - 1U] = spawn_radius*((side != 0.0) ? side*std::abs(u[N - 1U]) : u[N - 1U]) / norm;
+		}
+		break;
+	case attractor_type::PLANE:
+		w[0] = attractor_size*(pr_gen() - 0.5);
+		w[1] = attractor_size*(pr_gen() - 0.5);
+		w[N - 1U] = spawn_radius*((side != 0.0) ? side : (pr_gen() < 0.5 ? 1.0 : -1.0));
+		break;
+	case attractor_type::CIRCLE:
+		// at the centre of the circle (below) or on the sphere enclosing the aggregate (above)
+		if (!is_spawn_source_above || (is_spawn_source_below && pr_gen() < 0.5)) {
+			w.fill(0.0);
+			// once the aggregate reaches the centre, at a uniformly random point of the ball bounded by the circle
+			if (extent_min <= contact_distance) {
+				random_direction(w);
+				const double r = attractor_size*std::pow(pr_gen(), 1.0 / N);
+				for (auto& x : w) x *= r;
+			}
+			break;
+		}
+		random_direction(w);
+		for (auto& x : w) x *= spawn_radius;
+		break;
+	default:	// on the circle (2D) or sphere (3D) enclosing the aggregate
+		random_direction(w);
+		if (side != 0.0) w[N - 1U] = side*std::abs(w[N - 1U]);
+		for (auto& x : w) x *= spawn_radius;
+		break;
+	}
+}
+
+template<std::size_t N>
+bool DLA_off_lattice<N>::is_outside(const particle_type& w, double spawn_radius) const noexcept {
+	const double bound = spawn_radius + boundary_epsilon;
+	const double half_attractor = 0.5*attractor_size + boundary_epsilon;
+	switch (attractor) {
+	case attractor_type::POINT:
+		return extent(w) > bound;
+	case attractor_type::LINE:
+		return std::abs(w[0]) > half_attractor || extent(w) > bound;
+	case attractor_type::PLANE:
+		return std::abs(w[0]) > half_attractor || std::abs(w[1]) > half_attractor || extent(w) > bound;
+	case attractor_type::CIRCLE:
+		// a walker spawned within the ring can only leave it in 3D, through the plane of the ring
+		return extent(w) > bound;
+	}
+	return false;
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::random_direction(particle_type& u) noexcept {
+	const double phi = 2.0*M_PI*pr_gen();
+	if (N == 2U) {
+		u[0] = std::cos(phi);
+		u[1] = std::sin(phi);
+	}
+	else {	// uniform on the sphere by Archimedes' hat-box theorem
+		const double z = 2.0*pr_gen() - 1.0;
+		const double rho = std::sqrt(1.0 - z*z);
+		u[0] = rho*std::cos(phi);
+		u[1] = rho*std::sin(phi);
+		u[N - 1U] = z;
+	}
+}
+
+template<std::size_t N>
+template<class Function>
+void DLA_off_lattice<N>::for_each_neighbour(const particle_type& w, double radius, Function f) const {
+	cell_type first;
+	cell_type last;
+	for (std::size_t i = 0U; i < N; ++i) {
+		first[i] = static_cast<int>(std::floor((w[i] - radius) / cell_side));
+		last[i] = static_cast<int>(std::floor((w[i] + radius) / cell_side));
+	}
+	// odometer over the cells overlapping the bounding box of the ball
+	for (cell_type cell = first;;) {
+		const auto it = cell_heads.find(cell);
+		if (it != cell_heads.end()) {
+			for (std::size_t j = it->second; j != end_of_cell;) {
+				if (j & attractor_flag) {
+					const std::size_t k = j & ~attractor_flag;
+					f(j, attractor_particles[k]);
+					j = next_attractor_in_cell[k];
+				}
+				else {
+					f(j, buffer[j]);
+					j = next_in_cell[j];
+				}
+			}
+		}
+		std::size_t i = 0U;
+		while (i < N && cell[i] == last[i]) {
+			cell[i] = first[i];
+			++i;
+		}
+		if (i == N) break;
+		++cell[i];
+	}
+}
+
+template<std::size_t N>
+double DLA_off_lattice<N>::nearest_distance_squared(const particle_type& w) const noexcept {
+	double nearest = search_radius*search_radius;
+	for_each_neighbour(w, search_radius, [&w, &nearest](std::size_t, const particle_type& c) {
+		nearest = std::min(nearest, distance_squared(w, c));
+	});
+	return nearest;
+}
+
+template<std::size_t N>
+double DLA_off_lattice<N>::free_distance(const particle_type& w) const noexcept {
+	// a particle outside the empty 3^N block of cells around the walker is at least a cell side away
+	const std::size_t coarse_block = (N == 2U) ? 9U : 27U;
+	std::size_t level = 0U;
+	for (; level < coarse_levels; ++level) {
+		const auto centre = coarse_cell_of(w, level, coarse_side[level]);
+		auto cell = centre;
+		bool is_empty = true;
+		for (std::size_t block = 0U; is_empty && block < coarse_block; ++block) {
+			std::size_t digits = block;
+			for (std::size_t i = 0U; i < N; ++i, digits /= 3U)
+				cell[i] = centre[i] + static_cast<int>(digits % 3U) - 1;
+			is_empty = coarse_cells.find(cell) == coarse_cells.end();
+		}
+		if (!is_empty) break;
+	}
+	if (level > 0U) return coarse_side[level - 1U] - contact_distance;
+	return std::sqrt(nearest_distance_squared(w)) - contact_distance;
+}
+
+template<std::size_t N>
+std::size_t DLA_off_lattice<N>::first_contact(const particle_type& w, const particle_type& u, double length, double& t) const noexcept {
+	std::size_t hit = end_of_cell;
+	t = length;
+	for_each_neighbour(w, contact_distance + length, [&](std::size_t j, const particle_type& c) {
+		// smallest root of |w + s*u - c|^2 = contact_distance^2 with s in [0, t]
+		double b = 0.0;
+		for (std::size_t i = 0U; i < N; ++i) b += (w[i] - c[i])*u[i];
+		const double q = distance_squared(w, c) - contact_distance*contact_distance;
+		if (q <= 0.0) {	// in contact already, through rounding
+			if (b < 0.0) {
+				hit = j;
+				t = 0.0;
+			}
+			return;
+		}
+		const double disc = b*b - q;
+		if (b >= 0.0 || disc < 0.0) return;
+		const double s = -b - std::sqrt(disc);
+		if (s <= t) {
+			hit = j;
+			t = s;
+		}
+	});
+	return hit;
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::insert_into_cells(const particle_type& p, std::size_t encoded) {
+	const auto head = cell_heads.insert(std::make_pair(cell_of(p), end_of_cell)).first;
+	if (encoded & attractor_flag) next_attractor_in_cell[encoded & ~attractor_flag] = head->second;
+	else next_in_cell[encoded] = head->second;
+	head->second = encoded;
+	for (std::size_t level = 0U; level < coarse_levels; ++level)
+		coarse_cells.insert(coarse_cell_of(p, level, coarse_side[level]));
+	const double e = extent(p);
+	extent_min = std::min(extent_min, e);
+	extent_max = std::max(extent_max, e);
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::push_particle(const particle_type& p, std::size_t parent) {
+	if (track_parents) parents.push_back(parent);
+	buffer.push_back(p);
+	next_in_cell.push_back(end_of_cell);
+	insert_into_cells(p, buffer.size() - 1U);
+	update_aggregate_span();
+	if (recorder.active()) {
+		recorder.accumulate(p);
+		if (recorder.due(buffer.size())) recorder.record(buffer.size(), extent_max, aggregate_misses_, walk_steps);
+	}
+	if (notifier.active()) notifier.on_push(buffer);
+}
+
+template<std::size_t N>
+double DLA_off_lattice<N>::max_attractor_distance() const noexcept {
+	const bool is_linear = attractor == ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE);
+	return is_linear ? extent_max : extent_max*extent_max;
+}
+
+template<std::size_t N>
+void DLA_off_lattice<N>::update_aggregate_span() noexcept {
+	// less the radius of a 2D circle, as for lattice aggregates
+	const double circle_offset = (N == 2U && attractor == attractor_type::CIRCLE) ? static_cast<double>(attractor_size) : 0.0;
+	aggregate_span = static_cast<std::size_t>(std::max(max_attractor_distance() - circle_offset, 0.0));
+}
+
+template class DLA_off_lattice<2U>;
+template class DLA_off_lattice<3U>;
@@ -0,0 +1,279 @@
+#pragma once
+#include "DLAContainer.h"
+#include "attachment_observer.h"
+#include "memory_resource.h"
+#include <array>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * \class DLA_off_lattice
+ *
+ * \brief Defines a diffusion limited aggregate of unit diameter discs (2D) or spheres (3D) in
+ *        continuous space.
+ *
+ * Walkers take steps of adaptive length in uniformly random directions. Far from the aggregate a
+ * step spans the distance to the bounding region of the aggregate, within it the distance to the
+ * nearest occupied cell of a hierarchy of hashed grids and near particles the distance to the nearest
+ * particle, found through a hashed grid of cells of side 2. Within `min_step_length` of contact
+ * a walker takes steps of that length, each resolved exactly against every particle it may touch,
+ * such that a particle sticks at the point of first contact of the two discs or spheres.
+ *
+ * Particles are stored as `std::array<double,N>` in generation order. The attractor is built of
+ * particles of the same diameter: a single particle for POINT, a row of att_size touching particles for LINE,
+ * a square array for PLANE (3D only) and a ring for CIRCLE. Spawn sources, the stickiness coefficient,
+ * parent tracking, growth recording, observers and output behave as for the lattice aggregates.
+ * The lattice type is meaningless, and the aggregate cache (of lattice co-ordinates) is not consulted.
+ *
+ * Instantiated for N = 2 and 3 in DLA_off_lattice.cpp.
+ *
+ * \tparam N Dimension of space.
+ */
+template<std::size_t N>
+class DLA_off_lattice : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of off-lattice DLA must be 2 or 3.");
+public:
+	// centre of a particle
+	typedef std::array<double, N> particle_type;
+	static constexpr std::size_t dimension = N;
+	// length of the step of a walker within this distance of contact
+	static constexpr double min_step_length = 0.5;
+private:
+	typedef std::array<int, N> cell_type;
+	typedef std::unordered_map<cell_type,
+		std::size_t,
+		utl::tuple_hash,
+		std::equal_to<cell_type>,
+		utl::polymorphic_allocator<std::pair<const cell_type, std::size_t>>> cell_list_map;
+	// coarse cell, with its level as the last co-ordinate
+	typedef std::array<int, N + 1U> coarse_cell_type;
+	typedef std::unordered_set<coarse_cell_type,
+		utl::tuple_hash,
+		std::equal_to<coarse_cell_type>,
+		utl::polymorphic_allocator<coarse_cell_type>> coarse_cell_set;
+	typedef std::vector<particle_type,
+		utl::polymorphic_allocator<particle_type>> aggregate_buffer_vector;
+	typedef std::vector<std::size_t,
+		utl::polymorphic_allocator<std::size_t>> index_vector;
+public:
+	/**
+	 * \brief Default constructor, initialises empty aggregate with a point attractor and the given
+	 *        stickiness coefficient.
+	 *
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \param _resource [= utl::new_delete_resource()] Memory resource of all internal containers, which
+	 *        must outlive this aggregate.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
+	 */
+	DLA_off_lattice(const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed(),
+		utl::memory_resource* _resource = utl::new_delete_resource());
+	/**
+	 * \brief Initialises empty aggregate with specified attractor type.
+	 *
+	 * \param att Type of attractor of initial aggregate.
+	 * \param att_size Size of attractor, in particle diameters.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \param _resource [= utl::new_delete_resource()] Memory resource of all internal containers, which
+	 *        must outlive this aggregate.
+	 * \throw Throws std::invalid_argument exception if the attractor type is PLANE in 2D.
+	 */
+	DLA_off_lattice(attractor_type att, std::size_t att_size, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed(), utl::memory_resource* _resource = utl::new_delete_resource());
+	/**
+	 * \brief Copy constructor, copies contents of parameterised DLA_off_lattice to this. The copy
+	 *        allocates from `utl::new_delete_resource()`, not the memory resource of `other`.
+	 *
+	 * \param other const reference to DLA_off_lattice instance.
+	 */
+	DLA_off_lattice(const DLA_off_lattice& other);
+	/**
+	 * \brief Move constructor, leaving `other` in a valid but unspecified state.
+	 *
+	 * \param other rvalue reference to DLA_off_lattice instance.
+	 */
+	DLA_off_lattice(DLA_off_lattice&& other) noexcept;
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~DLA_off_lattice() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing the
+	 *        centres of the particles of the aggregate in the order in which they were added.
+	 *
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the memory resource from which the internal containers allocate.
+	 */
+	utl::memory_resource* get_memory_resource() const noexcept;
+	/**
+	 * \brief Registers an observer notified of particles as they attach to the aggregate, in
+	 *        batches of `batch_size` particles or once `interval` has elapsed since the last batch.
+	 *
+	 * The interval is checked only as particles attach, so a batch it holds back waits for the next
+	 * attachment or, failing that, for the remainder delivered when the generation ends. An exception
+	 * thrown by an observer on the dispatch thread is rethrown by the end of the generation or by
+	 * `remove_observer`.
+	 *
+	 * \param observer Observer to register.
+	 * \param batch_size [= 1] Number of particles per notification, zero to batch by time only.
+	 * \param interval [= 0] Maximum time between notifications, zero to batch by count only.
+	 * \param mode [= INLINE] Deliver on the generating thread or on a dispatch thread.
+	 */
+	void add_observer(std::shared_ptr<utl::attachment_observer<particle_type>> observer, std::size_t batch_size = 1U,
+		std::chrono::microseconds interval = std::chrono::microseconds::zero(), utl::dispatch_mode mode = utl::dispatch_mode::INLINE);
+	/**
+	 * \brief Unregisters an observer, waiting for any notifications already dispatched to it.
+	 *
+	 * \param observer Observer to unregister.
+	 * \throw Rethrows the first exception thrown by an observer on the dispatch thread since last rethrown.
+	 */
+	void remove_observer(const std::shared_ptr<utl::attachment_observer<particle_type>>& observer);
+	/**
+	 * \brief An off-lattice aggregate has no lattice.
+	 *
+	 * \throw Always throws std::invalid_argument.
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is PLANE in 2D.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \copydoc DLAContainer::initialise_attractor_structure()
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the off-lattice aggregate until it consists of the parameterised number of
+	 *        particles, continuing from any existing aggregate.
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the centres of the aggregate particles to an output stream, in the precision
+	 *        of the stream. Without sorting each line is prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// index flag of attractor particles in the cell list, and end of a chain of a cell
+	static constexpr std::size_t attractor_flag = ~(std::numeric_limits<std::size_t>::max() >> 1);
+	static constexpr std::size_t end_of_cell = std::numeric_limits<std::size_t>::max();
+	// radius of the neighbourhood searched for the nearest particle
+	static constexpr double search_radius = 2.0;
+	// centres of aggregate particles in order of generation
+	aggregate_buffer_vector buffer;
+	// centres of attractor particles
+	aggregate_buffer_vector attractor_particles;
+	// first particle of each occupied cell, chained through next_in_cell and next_attractor_in_cell
+	cell_list_map cell_heads;
+	index_vector next_in_cell;
+	index_vector next_attractor_in_cell;
+	// occupied cells of the coarse grids, of sides increasing by a factor 4 from 4 particle diameters
+	coarse_cell_set coarse_cells;
+	// range of the distances of all particles from the attractor, bounding the region walkers must reach
+	double extent_min = 0.0;
+	double extent_max = 0.0;
+	// batches attachment events to registered observers
+	utl::attachment_notifier<particle_type> notifier;
+	/**
+	 * \brief Computes the distance of a point from the attractor: from the origin for a point or
+	 *        circle, from the x-axis for a line and from the xy-plane for a plane.
+	 */
+	double extent(const particle_type& p) const noexcept;
+	/**
+	 * \brief Spawns a walker on the spawn surface enclosing the aggregate.
+	 *
+	 * \param w Position of walker.
+	 * \param spawn_radius Distance of spawn surface from the attractor.
+	 */
+	void spawn_particle(particle_type& w, double& spawn_radius) noexcept;
+	/**
+	 * \brief Checks whether a walker has left the region enclosed by the spawn surface.
+	 */
+	bool is_outside(const particle_type& w, double spawn_radius) const noexcept;
+	/**
+	 * \brief Sets `u` to a uniformly random unit vector.
+	 */
+	void random_direction(particle_type& u) noexcept;
+	/**
+	 * \brief Computes the squared distance from `w` to the nearest particle centre within
+	 *        `search_radius`, or `search_radius` squared if there is none.
+	 */
+	double nearest_distance_squared(const particle_type& w) const noexcept;
+	/**
+	 * \brief Computes a lower bound of the distance a walker at `w` may move without touching a
+	 *        particle, from the largest empty neighbourhood of coarse cells around it or, among
+	 *        occupied cells, from the nearest particle.
+	 */
+	double free_distance(const particle_type& w) const noexcept;
+	/**
+	 * \brief Finds the first particle touched by a walker moving from `w` along unit vector `u`.
+	 *
+	 * \param w Position of walker.
+	 * \param u Direction of step.
+	 * \param length Length of step, at most `min_step_length`.
+	 * \param t Distance travelled to contact, set on contact.
+	 * \return Encoded index of the touched particle, `end_of_cell` if none.
+	 */
+	std::size_t first_contact(const particle_type& w, const particle_type& u, double length, double& t) const noexcept;
+	/**
+	 * \brief Calls `f(encoded index, centre)` for every particle in the cells overlapping the
+	 *        bounding box of the ball of given radius about `w`.
+	 */
+	template<class Function>
+	void for_each_neighbour(const particle_type& w, double radius, Function f) const;
+	/**
+	 * \brief Inserts an aggregate or attractor particle into the cell list.
+	 *
+	 * \param p Centre of particle.
+	 * \param encoded Index of particle, flagged with `attractor_flag` for attractor particles.
+	 */
+	void insert_into_cells(const particle_type& p, std::size_t encoded);
+	/**
+	 * \brief Pushes a particle into the aggregate.
+	 *
+	 * \param p Centre of particle.
+	 * \param parent Index of particle stuck to, `utl::no_parent` for the attractor.
+	 */
+	void push_particle(const particle_type& p, std::size_t parent);
+	/**
+	 * \brief Gets the distance of the furthest particle from the attractor as measured for lattice
+	 *        aggregates by utl::attractor_distance: linear from a 2D line or a plane, squared otherwise.
+	 */
+	double max_attractor_distance() const noexcept;
+	/**
+	 * \brief Updates the spanning distance of the aggregate from its furthest particle.
+	 */
+	void update_aggregate_span() noexcept;
+};
+
+typedef DLA_off_lattice<2U> DLA_off_lattice_2d;
+typedef DLA_off_lattice<3U> DLA_off_lattice_3d;
+
+extern template class DLA_off_lattice<2U>;
+extern template class DLA_off_lattice<3U>;
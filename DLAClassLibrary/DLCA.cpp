@@ -0,0 +1,369 @@
+#include "Stdafx.h"
+#include "DLCA.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+template<std::size_t N>
+constexpr std::size_t DLCA<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t DLCA<N>::no_particle;
+
+template<std::size_t N>
+DLCA<N>::DLCA(std::size_t _particles, std::size_t _box_length, lattice_type ltt, const double& _coeff_stick,
+	double _mobility_exponent, std::uint64_t _seed) : lattice(ltt), lattice_geometry(&utl::describe_lattice(ltt, N)),
+	coeff_stick(_coeff_stick), mobility_exponent(_mobility_exponent), box(_box_length), particle_count(_particles),
+	pr_gen(utl::philox4x32(_seed)), seed(_seed) {
+	// if _coeff_stick not in (0,1] => throw std::invalid_argument
+	if (_coeff_stick <= 0.0 || _coeff_stick > 1.0)
+		throw std::invalid_argument("_coeff_stick must be in interval (0,1]");
+	if (lattice_geometry->sites != utl::lattice_sites::ALL && (box & 1U))
+		throw std::invalid_argument("box length must be even on a lattice with sites of given parity.");
+	if (box < 2U || box > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+		throw std::invalid_argument("box length out of range.");
+	// number of lattice sites in the box, halved for each parity constraint
+	std::size_t sites = 1U;
+	for (std::size_t i = 0U; i < N; ++i) sites *= box;
+	if (lattice_geometry->sites == utl::lattice_sites::EVEN_SUM) sites /= 2U;
+	else if (lattice_geometry->sites == utl::lattice_sites::EQUAL_PARITY) sites >>= N - 1U;
+	if (!_particles || _particles > sites / 2U || _particles >= no_particle)
+		throw std::invalid_argument("number of particles must be from 1 to half the number of sites of the box.");
+	reset();
+}
+
+template<std::size_t N>
+DLCA<N>::DLCA(const DLCA& other) : lattice(other.lattice), lattice_geometry(other.lattice_geometry),
+	coeff_stick(other.coeff_stick), mobility_exponent(other.mobility_exponent), box(other.box),
+	particle_count(other.particle_count), pr_gen(other.pr_gen), seed(other.seed), positions(other.positions),
+	sites(other.sites), grid(other.grid), parent(other.parent), mass(other.mass), last_member(other.last_member),
+	next_member(other.next_member), clusters(other.clusters), cluster_slot(other.cluster_slot),
+	mass_count(other.mass_count), min_mass(other.min_mass), max_mass(other.max_mass), elapsed(other.elapsed),
+	moves(other.moves), misses(other.misses) {}
+
+template<std::size_t N>
+DLCA<N>::DLCA(DLCA&& other) noexcept : lattice(other.lattice), lattice_geometry(other.lattice_geometry),
+	coeff_stick(other.coeff_stick), mobility_exponent(other.mobility_exponent), box(other.box),
+	particle_count(other.particle_count), pr_gen(std::move(other.pr_gen)), seed(other.seed), abort_signal(std::move(other.abort_signal)),
+	positions(std::move(other.positions)), sites(std::move(other.sites)), grid(std::move(other.grid)), parent(std::move(other.parent)),
+	mass(std::move(other.mass)), last_member(std::move(other.last_member)), next_member(std::move(other.next_member)),
+	clusters(std::move(other.clusters)), cluster_slot(std::move(other.cluster_slot)), mass_count(std::move(other.mass_count)),
+	min_mass(other.min_mass), max_mass(other.max_mass), elapsed(other.elapsed), moves(other.moves), misses(other.misses) {}
+
+template<std::size_t N>
+std::size_t DLCA<N>::size() const noexcept {
+	return particle_count;
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::box_length() const noexcept {
+	return box;
+}
+
+template<std::size_t N>
+lattice_type DLCA<N>::get_lattice_type() const noexcept {
+	return lattice;
+}
+
+template<std::size_t N>
+double DLCA<N>::get_coeff_stick() const noexcept {
+	return coeff_stick;
+}
+
+template<std::size_t N>
+double DLCA<N>::get_mobility_exponent() const noexcept {
+	return mobility_exponent;
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::cluster_count() const noexcept {
+	return clusters.size();
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::largest_cluster_mass() const noexcept {
+	return max_mass;
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::cluster_of(std::size_t i) const noexcept {
+	while (parent[i] != i) i = parent[i];
+	return i;
+}
+
+template<std::size_t N>
+const std::vector<typename DLCA<N>::particle_type>& DLCA<N>::particles() const noexcept {
+	return positions;
+}
+
+template<std::size_t N>
+double DLCA<N>::elapsed_time() const noexcept {
+	return elapsed;
+}
+
+template<std::size_t N>
+std::uint64_t DLCA<N>::cluster_moves() const noexcept {
+	return moves;
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::aggregate_misses() const noexcept {
+	return misses;
+}
+
+template<std::size_t N>
+void DLCA<N>::seed_generator(std::uint64_t _seed, std::uint64_t _stream, std::uint64_t _offset) {
+	utl::philox4x32 engine(_seed, _stream);
+	engine.discard(_offset);
+	pr_gen = utl::uniform_random_probability_generator<double, utl::philox4x32>(std::move(engine));
+	seed = _seed;
+}
+
+template<std::size_t N>
+std::uint64_t DLCA<N>::get_seed() const noexcept {
+	return seed;
+}
+
+template<std::size_t N>
+void DLCA<N>::raise_abort_signal() noexcept {
+	abort_signal.raise();
+}
+
+template<std::size_t N>
+void DLCA<N>::reset() {
+	const std::size_t n = particle_count;
+	std::size_t site_count = 1U;
+	for (std::size_t i = 0U; i < N; ++i) site_count *= box;
+	positions.resize(n);
+	sites.resize(n);
+	grid.assign(site_count, no_particle);
+	parent.resize(n);
+	mass.assign(n, 1U);
+	last_member.resize(n);
+	next_member.assign(n, no_particle);
+	clusters.resize(n);
+	cluster_slot.resize(n);
+	mass_count.assign(n + 1U, 0U);
+	mass_count[1] = n;
+	min_mass = 1U;
+	max_mass = 1U;
+	elapsed = 0.0;
+	moves = 0U;
+	misses = 0U;
+	const int side = static_cast<int>(box);
+	for (std::uint32_t i = 0U; i < n; ++i) {
+		parent[i] = i;
+		last_member[i] = i;
+		clusters[i] = i;
+		cluster_slot[i] = i;
+		// place particle at a random empty site
+		particle_type p;
+		do {
+			for (auto& x : p) x = static_cast<std::int32_t>(utl::step_index(pr_gen(), box));
+			utl::snap_to_lattice(p, lattice_geometry->sites);
+			for (auto& x : p) if (x >= side) x -= side;
+		} while (grid[site_index(p)] != no_particle);
+		positions[i] = p;
+		sites[i] = p;
+		grid[site_index(p)] = i;
+	}
+	// particles placed on neighbouring sites form the initial clusters
+	for (std::uint32_t i = 0U; i < n; ++i) {
+		for (std::size_t s = 0U; s < lattice_geometry->step_count; ++s) {
+			const std::uint32_t k = grid[site_index(neighbour_site(sites[i], lattice_geometry->steps[s].offset))];
+			if (k != no_particle && find(i) != find(k)) merge(contact{ i, k, s });
+		}
+	}
+}
+
+template<std::size_t N>
+void DLCA<N>::aggregate_to(std::size_t target) {
+	target = std::max<std::size_t>(target, 1U);
+	double mobility = max_mobility();
+	while (clusters.size() > target) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		++moves;
+		elapsed += 1.0 / (clusters.size()*mobility);
+		const std::uint32_t root = clusters[utl::step_index(pr_gen(), clusters.size())];
+		// move the chosen cluster with probability D(m)/D_max
+		const std::size_t fastest = (mobility_exponent <= 0.0) ? min_mass : max_mass;
+		if (mass[root] != fastest && pr_gen() >= std::pow(static_cast<double>(mass[root]) / fastest, mobility_exponent))
+			continue;
+		std::size_t move;
+		if (!move_cluster(root, move)) continue;
+		collect_contacts(root, move);
+		bool has_merged = false;
+		for (const auto& c : contacts) {
+			// cluster did not stick to neighbouring cluster
+			if (pr_gen() > coeff_stick) {
+				++misses;
+				continue;
+			}
+			merge(c);
+			has_merged = true;
+		}
+		if (has_merged) mobility = max_mobility();
+	}
+}
+
+template<std::size_t N>
+double DLCA<N>::radius_of_gyration(std::size_t root) const {
+	if (root >= particle_count || parent[root] != root)
+		throw std::invalid_argument("particle is not the root of a cluster.");
+	double sum[N] = {};
+	double sum2 = 0.0;
+	for (std::uint32_t j = static_cast<std::uint32_t>(root); j != no_particle; j = next_member[j]) {
+		// Cartesian position from lattice co-ordinates
+		for (std::size_t k = 0U; k < N; ++k) {
+			double x = 0.0;
+			for (std::size_t i = 0U; i < N; ++i) x += positions[j][i]*lattice_geometry->basis[i][k];
+			sum[k] += x;
+			sum2 += x*x;
+		}
+	}
+	const double m = mass[root];
+	double r2 = sum2 / m;
+	for (std::size_t k = 0U; k < N; ++k) r2 -= (sum[k] / m)*(sum[k] / m);
+	return std::sqrt(std::max(r2, 0.0));
+}
+
+template<std::size_t N>
+double DLCA<N>::estimate_fractal_dimension() const {
+	const auto largest = std::max_element(clusters.begin(), clusters.end(),
+		[this](std::uint32_t lhs, std::uint32_t rhs) { return mass[lhs] < mass[rhs]; });
+	const double r_g = radius_of_gyration(*largest);
+	if (r_g <= 1.0) return 0.0;
+	// compute fractal dimension via ln(M)/ln(R_g)
+	return std::log(mass[*largest]) / std::log(r_g);
+}
+
+template<std::size_t N>
+std::ostream& DLCA<N>::write(std::ostream& os, bool sort_by_cluster) const {
+	using utl::operator<<;
+	if (sort_by_cluster) {
+		for (const auto root : clusters)
+			for (std::uint32_t j = root; j != no_particle; j = next_member[j]) os << root << '\t' << positions[j] << '\n';
+	}
+	else {
+		for (std::size_t i = 0U; i < particle_count; ++i) os << cluster_of(i) << '\t' << positions[i] << '\n';
+	}
+	return os;
+}
+
+template<std::size_t N>
+std::size_t DLCA<N>::site_index(const particle_type& site) const noexcept {
+	std::size_t index = 0U;
+	for (std::size_t i = N; i-- > 0U;) index = index*box + static_cast<std::size_t>(site[i]);
+	return index;
+}
+
+template<std::size_t N>
+typename DLCA<N>::particle_type DLCA<N>::neighbour_site(const particle_type& site, const int* offset) const noexcept {
+	const std::int32_t side = static_cast<std::int32_t>(box);
+	particle_type neighbour;
+	for (std::size_t i = 0U; i < N; ++i) {
+		neighbour[i] = site[i] + offset[i];
+		if (neighbour[i] < 0) neighbour[i] += side;
+		else if (neighbour[i] >= side) neighbour[i] -= side;
+	}
+	return neighbour;
+}
+
+template<std::size_t N>
+std::uint32_t DLCA<N>::find(std::uint32_t i) noexcept {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+template<std::size_t N>
+void DLCA<N>::merge(const contact& c) {
+	std::uint32_t big = find(c.moved);
+	std::uint32_t small = find(c.other);
+	if (big == small) return;
+	// translation of the other particle onto the neighbouring site of the moved one, a multiple of the box side
+	particle_type shift;
+	bool is_wrapped = false;
+	for (std::size_t i = 0U; i < N; ++i) {
+		shift[i] = positions[c.moved][i] + lattice_geometry->steps[c.step].offset[i] - positions[c.other][i];
+		is_wrapped |= shift[i] != 0;
+	}
+	if (mass[big] < mass[small]) {
+		std::swap(big, small);
+		for (auto& x : shift) x = -x;
+	}
+	if (is_wrapped) {
+		for (std::uint32_t j = small; j != no_particle; j = next_member[j])
+			for (std::size_t i = 0U; i < N; ++i) positions[j][i] += shift[i];
+	}
+	// union by size, appending the members of the smaller cluster to those of the larger
+	parent[small] = big;
+	next_member[last_member[big]] = small;
+	last_member[big] = last_member[small];
+	--mass_count[mass[big]];
+	--mass_count[mass[small]];
+	mass[big] += mass[small];
+	++mass_count[mass[big]];
+	max_mass = std::max<std::size_t>(max_mass, mass[big]);
+	while (!mass_count[min_mass]) ++min_mass;
+	const std::uint32_t slot = cluster_slot[small];
+	clusters[slot] = clusters.back();
+	cluster_slot[clusters[slot]] = slot;
+	clusters.pop_back();
+}
+
+template<std::size_t N>
+void DLCA<N>::collect_contacts(std::uint32_t root, std::size_t move) {
+	contacts.clear();
+	const int* offset = lattice_geometry->steps[move].offset;
+	for (std::uint32_t j = root; j != no_particle; j = next_member[j]) {
+		// a cluster always sticking had no contacts before the move, so a member followed by another in the
+		// direction of the move neighbours only sites the latter neighboured before the move, all empty
+		if (coeff_stick == 1.0) {
+			const std::uint32_t k = grid[site_index(neighbour_site(sites[j], offset))];
+			if (k != no_particle && find(k) == root) continue;
+		}
+		for (std::size_t s = 0U; s < lattice_geometry->step_count; ++s) {
+			const std::uint32_t k = grid[site_index(neighbour_site(sites[j], lattice_geometry->steps[s].offset))];
+			if (k == no_particle) continue;
+			const std::uint32_t other = find(k);
+			if (other == root || std::any_of(contacts.begin(), contacts.end(),
+				[this, other](const contact& c) { return find(c.other) == other; })) continue;
+			contacts.push_back(contact{ j, k, s });
+		}
+	}
+}
+
+template<std::size_t N>
+bool DLCA<N>::move_cluster(std::uint32_t root, std::size_t& move) {
+	move = utl::step_index(pr_gen(), lattice_geometry->step_count);
+	const int* step = lattice_geometry->steps[move].offset;
+	// a cluster in contact with another, having failed to stick, may not move onto it
+	if (coeff_stick < 1.0) {
+		for (std::uint32_t j = root; j != no_particle; j = next_member[j]) {
+			const std::uint32_t k = grid[site_index(neighbour_site(sites[j], step))];
+			if (k != no_particle && find(k) != root) return false;
+		}
+	}
+	for (std::uint32_t j = root; j != no_particle; j = next_member[j]) grid[site_index(sites[j])] = no_particle;
+	for (std::uint32_t j = root; j != no_particle; j = next_member[j]) {
+		for (std::size_t i = 0U; i < N; ++i) positions[j][i] += step[i];
+		sites[j] = neighbour_site(sites[j], step);
+		grid[site_index(sites[j])] = j;
+	}
+	return true;
+}
+
+template<std::size_t N>
+double DLCA<N>::max_mobility() const noexcept {
+	// mobility decreases with mass for a non-positive exponent, increases otherwise
+	return std::pow(static_cast<double>((mobility_exponent <= 0.0) ? min_mass : max_mass), mobility_exponent);
+}
+
+template class DLCA<2U>;
+template class DLCA<3U>;
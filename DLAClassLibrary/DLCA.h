@@ -0,0 +1,265 @@
+#pragma once
+#include "lattice.h"
+#include "signal_flag.h"
+#include "utilities.h"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+/**
+ * \class DLCA
+ *
+ * \brief Defines diffusion limited cluster-cluster aggregation of particles on an `N`-dimensional
+ *        lattice in a periodic box.
+ *
+ * Particles are placed at random sites of a periodic box of side `box_length` lattice units,
+ * particles placed on neighbouring sites forming the initial clusters. At each step a cluster chosen
+ * uniformly at random moves rigidly by one lattice step with probability D(m)/D_max, where the
+ * mobility of a cluster of mass m is D(m) = m^mobility_exponent and D_max is the largest mobility of
+ * any current cluster, and the time advances by 1/(cluster_count*D_max). A moved cluster sticks, with
+ * probability `coeff_stick`, to every other cluster it now neighbours. A move onto a site occupied by
+ * another cluster, possible only for `coeff_stick` below one, is rejected.
+ *
+ * Clusters are tracked by a union-find forest over the particles, merged by size with path halving,
+ * and the occupancy grid of the box stores the index of the particle on each site such that the
+ * cluster of a site is found in near-constant time. The members of each cluster are chained in a
+ * list headed by its root, so a move or merge touches the members of the moved or smaller cluster
+ * only. Co-ordinates are stored unwrapped, every cluster being contiguous across the periodic
+ * boundaries, and a site is occupied by the particle whose wrapped co-ordinates it has.
+ *
+ * The random walk is driven by the lattice descriptor tables shared with DLA<N>. Instantiated for
+ * N = 2 and 3 in DLCA.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class DLCA {
+	static_assert(N == 2U || N == 3U, "dimension of DLCA must be 2 or 3.");
+public:
+	// unwrapped co-ordinates of a particle
+	typedef std::array<std::int32_t, N> particle_type;
+	static constexpr std::size_t dimension = N;
+	/**
+	 * \brief Places particles at random sites of a periodic box, each set of particles on
+	 *        neighbouring sites forming one initial cluster.
+	 *
+	 * \param _particles Number of particles.
+	 * \param _box_length Side of the periodic box, in lattice units.
+	 * \param ltt [= lattice_type::SQUARE] Type of lattice.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _mobility_exponent [= -0.5] Exponent of the mass dependence of cluster mobility.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1], if the lattice is not
+	 *        defined in N dimensions, if the box has an odd side on a lattice with sites of given parity,
+	 *        or if the particles would fill more than half of the sites of the box.
+	 */
+	DLCA(std::size_t _particles, std::size_t _box_length, lattice_type ltt = lattice_type::SQUARE,
+		const double& _coeff_stick = 1.0, double _mobility_exponent = -0.5, std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \brief Copy constructor, copies the state of parameterised DLCA to this.
+	 *
+	 * \param other const reference to DLCA instance.
+	 */
+	DLCA(const DLCA& other);
+	/**
+	 * \brief Move constructor, leaving `other` in a valid but unspecified state.
+	 *
+	 * \param other rvalue reference to DLCA instance.
+	 */
+	DLCA(DLCA&& other) noexcept;
+	/**
+	 * \brief Gets the number of particles.
+	 */
+	std::size_t size() const noexcept;
+	/**
+	 * \brief Gets the side of the periodic box, in lattice units.
+	 */
+	std::size_t box_length() const noexcept;
+	/**
+	 * \brief Gets the type of lattice.
+	 */
+	lattice_type get_lattice_type() const noexcept;
+	/**
+	 * \brief Gets the stickiness coefficient.
+	 */
+	double get_coeff_stick() const noexcept;
+	/**
+	 * \brief Gets the exponent of the mass dependence of cluster mobility.
+	 */
+	double get_mobility_exponent() const noexcept;
+	/**
+	 * \brief Gets the current number of clusters.
+	 */
+	std::size_t cluster_count() const noexcept;
+	/**
+	 * \brief Gets the number of particles in the largest cluster.
+	 */
+	std::size_t largest_cluster_mass() const noexcept;
+	/**
+	 * \brief Gets the cluster of a particle, identified by the index of its root particle.
+	 *
+	 * \param i Index of particle.
+	 * \return Index of root particle of the cluster of particle `i`.
+	 */
+	std::size_t cluster_of(std::size_t i) const noexcept;
+	/**
+	 * \brief Gets the unwrapped co-ordinates of the particles, in order of initial placement.
+	 */
+	const std::vector<particle_type>& particles() const noexcept;
+	/**
+	 * \brief Gets the elapsed time of the aggregation, in units of the time taken by a single
+	 *        particle to make one lattice step.
+	 */
+	double elapsed_time() const noexcept;
+	/**
+	 * \brief Gets the number of attempted cluster moves.
+	 */
+	std::uint64_t cluster_moves() const noexcept;
+	/**
+	 * \brief Gets the number of contacts of clusters which failed to stick.
+	 */
+	std::size_t aggregate_misses() const noexcept;
+	/**
+	 * \brief Re-seeds the random number generator, such that subsequent aggregation is reproducible.
+	 *
+	 * \param _seed Seed for the generator engine.
+	 * \param _stream [= 0] Stream of the seed.
+	 * \param _offset [= 0] Number of values of the stream to skip.
+	 */
+	void seed_generator(std::uint64_t _seed, std::uint64_t _stream = 0U, std::uint64_t _offset = 0U);
+	/**
+	 * \brief Gets the seed of the random number generator.
+	 */
+	std::uint64_t get_seed() const noexcept;
+	/**
+	 * \brief Raises an abort signal, stopping any current aggregation. The signal is lowered again
+	 *        by the aggregation which observes it.
+	 */
+	void raise_abort_signal() noexcept;
+	/**
+	 * \brief Places all particles anew at random sites, as upon construction, resetting the time,
+	 *        move and miss counts.
+	 */
+	void reset();
+	/**
+	 * \brief Moves clusters until at most the given number of clusters remain.
+	 *
+	 * \param clusters [= 1] Number of clusters at which to stop.
+	 */
+	void aggregate_to(std::size_t clusters = 1U);
+	/**
+	 * \brief Computes the radius of gyration of a cluster, in units of the nearest neighbour distance.
+	 *
+	 * \param root Index of root particle of the cluster.
+	 */
+	double radius_of_gyration(std::size_t root) const;
+	/**
+	 * \brief Computes an estimate of the fractal dimension of the largest cluster, via ln(M)/ln(R_g).
+	 */
+	double estimate_fractal_dimension() const;
+	/**
+	 * \brief Writes the particles to an output stream, each line holding the root index of the cluster
+	 *        of a particle followed by its unwrapped co-ordinates.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_cluster [= false] Flag to write the particles of each cluster consecutively,
+	 *        rather than in order of initial placement.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_cluster = false) const;
+private:
+	// index of no particle, terminating a member list and marking an empty site
+	static constexpr std::uint32_t no_particle = std::numeric_limits<std::uint32_t>::max();
+	/**
+	 * \struct contact
+	 *
+	 * \brief Contact of particle `moved` of the moved cluster with particle `other` of another
+	 *        cluster, on the neighbouring site given by lattice step `step`.
+	 */
+	struct contact {
+		std::uint32_t moved;
+		std::uint32_t other;
+		std::size_t step;
+	};
+	lattice_type lattice;
+	const utl::lattice_descriptor* lattice_geometry;
+	double coeff_stick;
+	double mobility_exponent;
+	std::size_t box;
+	std::size_t particle_count;
+	utl::uniform_random_probability_generator<double, utl::philox4x32> pr_gen;
+	std::uint64_t seed;
+	utl::signal_flag abort_signal;
+	// unwrapped co-ordinates of each particle, and its site in the box
+	std::vector<particle_type> positions;
+	std::vector<particle_type> sites;
+	// index of the particle on each site of the box, no_particle if empty
+	std::vector<std::uint32_t> grid;
+	// union-find parent of each particle, and mass and last member of each root
+	std::vector<std::uint32_t> parent;
+	std::vector<std::uint32_t> mass;
+	std::vector<std::uint32_t> last_member;
+	// next particle in the member list of the cluster of each particle
+	std::vector<std::uint32_t> next_member;
+	// roots of the current clusters, and the position of each root therein
+	std::vector<std::uint32_t> clusters;
+	std::vector<std::uint32_t> cluster_slot;
+	// number of clusters of each mass, bounding the masses of the most mobile clusters
+	std::vector<std::size_t> mass_count;
+	std::size_t min_mass = 1U;
+	std::size_t max_mass = 1U;
+	// scratch list of the contacts of the last moved cluster
+	std::vector<contact> contacts;
+	double elapsed = 0.0;
+	std::uint64_t moves = 0U;
+	std::size_t misses = 0U;
+	/**
+	 * \brief Computes the index in the occupancy grid of a site of the box.
+	 */
+	std::size_t site_index(const particle_type& site) const noexcept;
+	/**
+	 * \brief Computes the site of the box neighbouring a site by a lattice step, wrapped into the box.
+	 *
+	 * \param site Site of the box.
+	 * \param offset Offset of lattice step, of components from -1 to 1.
+	 */
+	particle_type neighbour_site(const particle_type& site, const int* offset) const noexcept;
+	/**
+	 * \brief Finds the root of the cluster of a particle, halving the path to it.
+	 */
+	std::uint32_t find(std::uint32_t i) noexcept;
+	/**
+	 * \brief Merges the clusters of two particles on neighbouring sites, translating the smaller
+	 *        cluster by a multiple of the box side such that the two are contiguous.
+	 *
+	 * \param c Contact of the particles.
+	 */
+	void merge(const contact& c);
+	/**
+	 * \brief Collects the contacts of the members of a moved cluster with every other cluster, one
+	 *        per neighbouring cluster.
+	 *
+	 * \param root Index of root particle of the cluster.
+	 * \param move Index of the lattice step by which the cluster moved.
+	 */
+	void collect_contacts(std::uint32_t root, std::size_t move);
+	/**
+	 * \brief Attempts a rigid move of a cluster by a random lattice step.
+	 *
+	 * \param root Index of root particle of the cluster.
+	 * \param move Index of the lattice step drawn.
+	 * \return true if the cluster moved, false if the move was rejected.
+	 */
+	bool move_cluster(std::uint32_t root, std::size_t& move);
+	/**
+	 * \brief Computes the largest mobility of any current cluster.
+	 */
+	double max_mobility() const noexcept;
+};
+
+typedef DLCA<2U> DLCA_2d;
+typedef DLCA<3U> DLCA_3d;
+
+extern template class DLCA<2U>;
+extern template class DLCA<3U>;
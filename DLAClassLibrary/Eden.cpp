@@ -0,0 +1,345 @@
+#include "Stdafx.h"
+#include "Eden.h"
+
+namespace {
+	// smallest side of the grid, and distance kept between the aggregate and the faces of the grid
+	constexpr std::size_t min_grid_side = 32U;
+	constexpr int grid_margin = 8;
+}
+
+template<std::size_t N>
+constexpr std::size_t Eden<N>::dimension;
+template<std::size_t N>
+constexpr std::uint32_t Eden<N>::no_index;
+template<std::size_t N>
+constexpr std::uint32_t Eden<N>::perimeter_flag;
+template<std::size_t N>
+constexpr std::uint32_t Eden<N>::attractor_index;
+template<std::size_t N>
+constexpr std::uint32_t Eden<N>::barred_index;
+template<std::size_t N>
+constexpr std::size_t Eden<N>::no_slot;
+
+template<std::size_t N>
+Eden<N>::Eden(const double& _coeff_stick, std::uint64_t _seed) : DLAContainer(_coeff_stick, _seed) {
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+}
+
+template<std::size_t N>
+Eden<N>::Eden(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick, std::uint64_t _seed)
+	: DLAContainer(ltt, att, att_size, _coeff_stick, _seed) {
+	if (N == 2U && att == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D Eden to PLANE.");
+	lattice_geometry = &utl::describe_lattice(lattice, static_cast<unsigned>(N));
+	initialise_attractor_structure();
+}
+
+template<std::size_t N>
+std::size_t Eden<N>::size() const noexcept {
+	return buffer.size();
+}
+
+template<std::size_t N>
+const typename Eden<N>::aggregate_buffer_vector& Eden<N>::aggregate_buffer() const noexcept {
+	return buffer;
+}
+
+template<std::size_t N>
+std::size_t Eden<N>::perimeter_size() const noexcept {
+	return perimeter.size();
+}
+
+template<std::size_t N>
+std::size_t Eden<N>::box_length() const noexcept {
+	return side;
+}
+
+template<std::size_t N>
+void Eden<N>::set_lattice_type(lattice_type ltt) {
+	// look up first such that an invalid lattice type leaves the aggregate unchanged
+	lattice_geometry = &utl::describe_lattice(ltt, static_cast<unsigned>(N));
+	// the neighbours of the grid are rebuilt for the new lattice upon the next growth
+	if (ltt != lattice) is_attractor_initialised = false;
+	DLAContainer::set_lattice_type(ltt);
+}
+
+template<std::size_t N>
+void Eden<N>::set_attractor_type(attractor_type attr, std::size_t att_size) {
+	if (N == 2U && attr == attractor_type::PLANE)
+		throw std::invalid_argument("Cannot set attractor type of 2D Eden to PLANE.");
+	DLAContainer::set_attractor_type(attr, att_size);
+}
+
+template<std::size_t N>
+void Eden<N>::initialise_attractor_structure() {
+	is_attractor_initialised = true;
+	attractor_sites = utl::attractor_sites<N>(attractor, attractor_size, *lattice_geometry);
+	extent = 0;
+	for (const auto& s : attractor_sites)
+		for (int x : s) extent = std::max(extent, std::abs(x));
+	// the aggregate is measured anew from an attractor or lattice changed since the last growth
+	max_distance = 0.0;
+	for (const auto& q : buffer) {
+		for (int x : utl::coordinates_of(q)) extent = std::max(extent, std::abs(x));
+		max_distance = std::max(max_distance, utl::real_space_distance(q, attractor, attractor_size, *lattice_geometry));
+	}
+	// the perimeter of any old lattice is collected anew
+	grid.clear();
+	perimeter.clear();
+	build_grid(grid_side_for(extent));
+}
+
+template<std::size_t N>
+void Eden<N>::clear() {
+	DLAContainer::clear();
+	buffer.clear();
+	max_distance = 0.0;
+	// the grid is rebuilt about the bare attractor upon the next growth
+	grid.clear();
+	perimeter.clear();
+	drawn_slot = no_slot;
+	if (!reuse_storage) {
+		buffer.shrink_to_fit();
+		grid.shrink_to_fit();
+		perimeter.shrink_to_fit();
+	}
+	is_attractor_initialised = false;
+}
+
+template<std::size_t N>
+void Eden<N>::grow_to(std::size_t n) {
+	if (!is_attractor_initialised) initialise_attractor_structure();
+	// barred sites follow the spawn sources
+	else if (grid_sources != std::make_pair(is_spawn_source_above, is_spawn_source_below)) build_grid(side);
+	const std::size_t new_cap = grown_capacity(n, buffer.capacity());
+	if (new_cap > buffer.capacity()) {
+		buffer.reserve(new_cap);
+		if (track_parents) parents.reserve(new_cap);
+	}
+	is_seed_fresh = false;
+	if (recorder.active()) recorder.start_clock();
+	// the slot of the next particle is drawn before the current particle occupies its site, from a range bounding
+	// the perimeter thereafter, such that the sites about the next site are fetched from memory meanwhile
+	const std::size_t max_new_sites = neighbours.size();
+	std::size_t slot = drawn_slot;
+	if (slot >= perimeter.size() && !perimeter.empty()) slot = utl::step_index(pr_gen(), perimeter.size());
+	while (size() < n || continuous.is_raised()) {
+		// observe and lower any abort signal raised by a controlling thread
+		if (abort_signal.is_raised()) {
+			abort_signal.lower();
+			break;
+		}
+		if (perimeter.empty()) break;
+		// particle did not stick to aggregate, the site is drawn anew
+		if (coeff_stick < 1.0 && pr_gen() > coeff_stick) {
+			++aggregate_misses_;
+			slot = utl::step_index(pr_gen(), perimeter.size());
+			continue;
+		}
+		std::size_t next_slot = utl::step_index(pr_gen(), perimeter.size() - 1U + max_new_sites);
+		if (next_slot < perimeter.size()) {
+			const std::size_t next = perimeter[next_slot];
+			for (std::ptrdiff_t step : neighbours) utl::prefetch(grid.data() + (next + step));
+		}
+		occupy(slot);
+		// enlarge the grid once the aggregate reaches its faces
+		if (extent >= static_cast<int>(side / 2U)) build_grid(grid_side_for(extent));
+		// a slot beyond the perimeter is rejected, leaving the draw uniform over the perimeter
+		if (next_slot >= perimeter.size() && !perimeter.empty()) next_slot = utl::step_index(pr_gen(), perimeter.size());
+		slot = next_slot;
+	}
+	// the slot drawn for the next particle is kept for the next growth
+	drawn_slot = slot;
+	if (recorder.active()) recorder.stop_clock();
+}
+
+template<std::size_t N>
+double Eden<N>::estimate_fractal_dimension() const {
+	if (buffer.empty()) return 0.0;
+	return utl::estimate_fractal_dimension(size(), max_distance, attractor, attractor_size, N);
+}
+
+template<std::size_t N>
+std::ostream& Eden<N>::write(std::ostream& os, bool sort_by_gen_order) const {
+	return utl::write_generations(os, buffer, sort_by_gen_order);
+}
+
+template<std::size_t N>
+std::size_t Eden<N>::node_of(const site_type& s) const noexcept {
+	const int offset = static_cast<int>(side / 2U) + 1;
+	std::size_t node = 0U;
+	for (std::size_t i = 0U; i < N; ++i) node += static_cast<std::size_t>(s[i] + offset)*stride[i];
+	return node;
+}
+
+template<std::size_t N>
+typename Eden<N>::site_type Eden<N>::site_of(std::size_t node) const noexcept {
+	const int offset = static_cast<int>(side / 2U) + 1;
+	const std::size_t nodes = side + 3U;
+	site_type s;
+	for (std::size_t i = 0U; i < N; ++i) s[i] = static_cast<int>((node / stride[i]) % nodes) - offset;
+	return s;
+}
+
+template<std::size_t N>
+std::size_t Eden<N>::grid_side_for(int ext) noexcept {
+	// compact aggregates fill the grid, so its margin is kept small
+	return std::max(min_grid_side, 2U*static_cast<std::size_t>(ext + ext / 4 + grid_margin));
+}
+
+template<std::size_t N>
+bool Eden<N>::is_growth_site(const site_type& s) const noexcept {
+	if (is_spawn_source_above && is_spawn_source_below) return true;
+	if (attractor == attractor_type::CIRCLE) {
+		// inside or outside the circle as drawn in Cartesian space
+		const double r2 = utl::real_space_distance(s, attractor_type::POINT, 0U, *lattice_geometry);
+		const double radius2 = static_cast<double>(attractor_size)*static_cast<double>(attractor_size);
+		return is_spawn_source_above ? r2 >= radius2 : r2 < radius2;
+	}
+	return is_spawn_source_above ? s[N - 1U] >= 0 : s[N - 1U] <= 0;
+}
+
+template<std::size_t N>
+void Eden<N>::build_grid(std::size_t _side) {
+	// an enlarged grid carries over the contents of every site of the old grid, else the aggregate is placed anew
+	const bool is_enlarging = !grid.empty() && _side >= side
+		&& grid_sources == std::make_pair(is_spawn_source_above, is_spawn_source_below);
+	std::vector<std::uint32_t> old_grid;
+	old_grid.swap(grid);
+	const std::size_t old_nodes = side + 3U;
+	const std::array<std::size_t, N> old_stride = stride;
+	const std::size_t shift = _side / 2U - side / 2U;
+	// sites of the old perimeter in slot order
+	std::vector<site_type> old_perimeter;
+	if (!old_grid.empty() && !is_enlarging) {
+		old_perimeter.reserve(perimeter.size());
+		for (std::size_t node : perimeter) old_perimeter.push_back(site_of(node));
+	}
+	side = _side;
+	const std::size_t nodes = side + 3U;
+	std::size_t count = 1U;
+	for (std::size_t i = 0U; i < N; ++i) {
+		stride[i] = count;
+		count *= nodes;
+	}
+	grid.assign(count, no_index);
+	grid_sources = std::make_pair(is_spawn_source_above, is_spawn_source_below);
+	// offsets of the distinct nearest neighbours, the steps of the random walk repeating some by weight
+	neighbours.clear();
+	for (std::size_t k = 0U; k < lattice_geometry->step_count; ++k) {
+		std::ptrdiff_t offset = 0;
+		for (std::size_t i = 0U; i < N; ++i) offset += lattice_geometry->steps[k].offset[i] * static_cast<std::ptrdiff_t>(stride[i]);
+		if (std::find(neighbours.begin(), neighbours.end(), offset) == neighbours.end()) neighbours.push_back(offset);
+	}
+	// bar the halo, and the sites off the side of a single spawn source
+	const bool is_one_sided = !(is_spawn_source_above && is_spawn_source_below);
+	const int offset = static_cast<int>(side / 2U) + 1;
+	utl::for_each_node<N>(nodes, [&](std::size_t node, const std::array<std::size_t, N>& j) {
+		site_type s;
+		bool is_halo = false;
+		for (std::size_t i = 0U; i < N; ++i) {
+			is_halo = is_halo || j[i] == 0U || j[i] == nodes - 1U;
+			s[i] = static_cast<int>(j[i]) - offset;
+		}
+		if (is_halo || (is_one_sided && !is_growth_site(s))) grid[node] = barred_index;
+	});
+	const auto is_occupied = [](std::uint32_t index) { return index < barred_index || index == attractor_index; };
+	const auto push_neighbours = [this](std::size_t node) {
+		for (std::ptrdiff_t step : neighbours) {
+			const std::size_t next = node + step;
+			if (grid[next] == no_index) {
+				grid[next] = perimeter_flag | static_cast<std::uint32_t>(perimeter.size());
+				perimeter.push_back(next);
+			}
+		}
+	};
+	if (is_enlarging) {
+		// copy the rows of the old grid along the first axis, the perimeter keeping its slots
+		const auto new_node_of = [&](const std::array<std::size_t, N>& j) {
+			std::size_t node = 0U;
+			for (std::size_t i = 0U; i < N; ++i) node += (j[i] + shift)*stride[i];
+			return node;
+		};
+		utl::for_each_node<N>(old_nodes, [&](std::size_t node, const std::array<std::size_t, N>& j) {
+			if (j[0] != 1U || std::any_of(j.begin() + 1, j.end(), [old_nodes](std::size_t x) { return x == 0U || x == old_nodes - 1U; }))
+				return;
+			std::copy(old_grid.begin() + node, old_grid.begin() + node + (old_nodes - 2U), grid.begin() + new_node_of(j));
+		});
+		for (std::size_t& node : perimeter) {
+			std::array<std::size_t, N> j;
+			for (std::size_t i = 0U; i < N; ++i) j[i] = (node / old_stride[i]) % old_nodes;
+			node = new_node_of(j);
+		}
+		// the neighbours of occupied sites on the faces of the old grid, formerly its halo, join the perimeter
+		utl::for_each_node<N>(old_nodes, [&](std::size_t node, const std::array<std::size_t, N>& j) {
+			if (!is_occupied(old_grid[node])) return;
+			if (std::any_of(j.begin(), j.end(), [old_nodes](std::size_t x) { return x == 1U || x == old_nodes - 2U; }))
+				push_neighbours(new_node_of(j));
+		});
+		return;
+	}
+	old_grid.clear();
+	old_grid.shrink_to_fit();
+	drawn_slot = no_slot;
+	for (const auto& s : attractor_sites) grid[node_of(s)] = attractor_index;
+	for (std::size_t i = 0U; i < buffer.size(); ++i)
+		grid[node_of(utl::coordinates_of(buffer[i]))] = static_cast<std::uint32_t>(i);
+	perimeter.clear();
+	for (const auto& s : old_perimeter) {
+		const std::size_t node = node_of(s);
+		if (grid[node] == no_index) {
+			grid[node] = perimeter_flag | static_cast<std::uint32_t>(perimeter.size());
+			perimeter.push_back(node);
+		}
+	}
+	// sites freed from being barred join the perimeter after the old one
+	for (const auto& s : attractor_sites) push_neighbours(node_of(s));
+	for (const auto& q : buffer) push_neighbours(node_of(utl::coordinates_of(q)));
+}
+
+template<std::size_t N>
+void Eden<N>::occupy(std::size_t slot) {
+	const std::size_t node = perimeter[slot];
+	// move the last site into the slot
+	const std::size_t last = perimeter.back();
+	perimeter[slot] = last;
+	grid[last] = perimeter_flag | static_cast<std::uint32_t>(slot);
+	perimeter.pop_back();
+	// the parent is the first occupied neighbour in order of the lattice steps
+	std::size_t parent = utl::no_parent;
+	for (std::ptrdiff_t offset : neighbours) {
+		const std::uint32_t index = grid[node + offset];
+		if (index < barred_index) {
+			parent = index;
+			break;
+		}
+	}
+	grid[node] = static_cast<std::uint32_t>(buffer.size());
+	for (std::ptrdiff_t offset : neighbours) {
+		const std::size_t next = node + offset;
+		if (grid[next] == no_index) {
+			grid[next] = perimeter_flag | static_cast<std::uint32_t>(perimeter.size());
+			perimeter.push_back(next);
+		}
+	}
+	const site_type s = site_of(node);
+	const particle_type p = utl::make_lattice_point<N>(s);
+	if (track_parents) parents.push_back(parent);
+	buffer.push_back(p);
+	++occupied_sites;
+	for (int x : s) extent = std::max(extent, std::abs(x));
+	max_distance = std::max(max_distance, utl::real_space_distance(p, attractor, attractor_size, *lattice_geometry));
+	const double circle_offset = (N == 2U && attractor == attractor_type::CIRCLE) ? static_cast<double>(attractor_size) : 0.0;
+	aggregate_span = (max_distance > circle_offset) ? static_cast<std::size_t>(max_distance - circle_offset) : 0U;
+	if (recorder.active()) {
+		recorder.accumulate(utl::cartesian_position(p, *lattice_geometry));
+		if (recorder.due(buffer.size())) {
+			// linear distance from a 2D line or a plane, squared distance otherwise
+			const bool is_linear = attractor == ((N == 2U) ? attractor_type::LINE : attractor_type::PLANE);
+			recorder.record(buffer.size(), is_linear ? max_distance : std::sqrt(max_distance), aggregate_misses_, walk_steps);
+		}
+	}
+}
+
+template class Eden<2U>;
+template class Eden<3U>;
@@ -0,0 +1,192 @@
+#pragma once
+#include "DLAContainer.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * \class Eden
+ *
+ * \brief Defines an aggregate grown by the Eden model on an `N`-dimensional lattice.
+ *
+ * Each new particle occupies a site drawn uniformly at random from the perimeter of the aggregate, i.e. the
+ * empty sites neighbouring the aggregate or attractor by a lattice step, giving compact clusters with a rough
+ * surface against which DLA<N> aggregates may be compared. A drawn site is rejected with probability
+ * 1 - `coeff_stick`, counting a miss, and drawn anew.
+ *
+ * The sites are held in a dense grid about the aggregate storing the generation index of each aggregate
+ * site or the slot of each perimeter site in the perimeter array. A drawn site is removed from the perimeter
+ * by moving the last slot into it and its empty neighbours are appended, such that every particle costs
+ * O(1) independent of the size of the aggregate. The grid is enlarged as the aggregate approaches its faces,
+ * carrying over the perimeter in slot order. The grid holds four bytes per site, bounding the aggregates of
+ * a given memory, e.g. about 10^8 particles per gigabyte in 2D.
+ *
+ * The attractor types are the geometries of DLA<N> and the neighbours are the nearest neighbours of the
+ * lattice descriptor tables, such that every lattice of the dimension is supported. For a single spawn
+ * source growth is confined to the half-space on its side along the last axis, or to the outside (above)
+ * or inside (below) of a CIRCLE attractor. Parent tracking, growth recording and output behave as for the
+ * lattice aggregates, the aggregate cache is not consulted and no random walk steps are taken.
+ *
+ * Instantiated for N = 2 and 3 in Eden.cpp.
+ *
+ * \tparam N Dimension of lattice.
+ */
+template<std::size_t N>
+class Eden : public DLAContainer {
+	static_assert(N == 2U || N == 3U, "dimension of Eden must be 2 or 3.");
+public:
+	// co-ordinates of a particle
+	typedef typename utl::lattice_point<N>::type particle_type;
+	static constexpr std::size_t dimension = N;
+private:
+	typedef std::array<int, N> site_type;
+	typedef std::vector<particle_type> aggregate_buffer_vector;
+public:
+	/**
+	 * \brief Default constructor, initialises empty aggregate with a point attractor on the square lattice.
+	 *
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if _coeff_stick not in (0,1].
+	 */
+	explicit Eden(const double& _coeff_stick = 1.0, std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \brief Initialises empty aggregate with specified lattice and attractor types.
+	 *
+	 * \param ltt Type of lattice.
+	 * \param att Type of attractor of initial aggregate.
+	 * \param att_size Size of attractor.
+	 * \param _coeff_stick [= 1.0] Coefficient of stickiness.
+	 * \param _seed [= utl::random_seed()] Seed of the random number generator.
+	 * \throw Throws std::invalid_argument exception if the lattice is not defined in N dimensions or the
+	 *        attractor type is PLANE in 2D.
+	 */
+	Eden(lattice_type ltt, attractor_type att, std::size_t att_size, const double& _coeff_stick = 1.0,
+		std::uint64_t _seed = utl::random_seed());
+	/**
+	 * \copydoc DLAContainer::~DLAContainer()
+	 */
+	~Eden() override = default;
+	/**
+	 * \copydoc DLAContainer::size()
+	 */
+	std::size_t size() const noexcept override;
+	/**
+	 * \brief Returns a const reference to the buffer vector of the aggregate, storing the
+	 *        particles of the aggregate in the order in which they were added.
+	 *
+	 * \return const reference to buffer of aggregate.
+	 */
+	const aggregate_buffer_vector& aggregate_buffer() const noexcept;
+	/**
+	 * \brief Gets the number of sites of the perimeter from which the next particle is drawn.
+	 */
+	std::size_t perimeter_size() const noexcept;
+	/**
+	 * \brief Gets the side of the grid about the aggregate, in lattice units.
+	 */
+	std::size_t box_length() const noexcept;
+	/**
+	 * \copydoc DLAContainer::set_lattice_type(lattice_type)
+	 */
+	void set_lattice_type(lattice_type ltt) override;
+	/**
+	 * \copydoc DLAContainer::set_attractor_type(attractor_type)
+	 * \throw Throws std::invalid_argument exception if _attractor_type is PLANE in 2D.
+	 */
+	void set_attractor_type(attractor_type att, std::size_t att_size) override;
+	/**
+	 * \copydoc DLAContainer::initialise_attractor_structure()
+	 */
+	void initialise_attractor_structure() override;
+	/**
+	 * \copydoc DLAContainer::clear()
+	 */
+	void clear() override;
+	/**
+	 * \brief Grows the aggregate until it consists of the parameterised number of particles,
+	 *        continuing from any existing aggregate.
+	 *
+	 * \param n Total number of particles in the aggregate after growth.
+	 */
+	void grow_to(std::size_t n) override;
+	/**
+	 * \copydoc DLAContainer::estimate_fractal_dimension()
+	 */
+	double estimate_fractal_dimension() const override;
+	/**
+	 * \brief Writes the aggregate particles to an output stream. Without sorting each line is
+	 *        prefixed by the generation index.
+	 *
+	 * \param os Instance of std::ostream for writing to.
+	 * \param sort_by_gen_order [= false] Flag to omit generation indices, particles being
+	 *        stored in generation order.
+	 */
+	std::ostream& write(std::ostream& os, bool sort_by_gen_order = false) const override;
+private:
+	// content of a grid site: empty, the generation index of an aggregate site, the attractor, a site barred from
+	// growth, or a perimeter slot tagged by the perimeter flag
+	static constexpr std::uint32_t no_index = std::numeric_limits<std::uint32_t>::max();
+	static constexpr std::uint32_t perimeter_flag = std::uint32_t(1U) << 31;
+	static constexpr std::uint32_t attractor_index = perimeter_flag - 1U;
+	static constexpr std::uint32_t barred_index = perimeter_flag - 2U;
+	// perimeter slot of no site
+	static constexpr std::size_t no_slot = std::numeric_limits<std::size_t>::max();
+	// sites of attractor
+	std::vector<site_type> attractor_sites;
+	// particles of the aggregate in order of generation
+	aggregate_buffer_vector buffer;
+	// largest co-ordinate magnitude of any particle or attractor site, bounding the aggregate within the grid
+	int extent = 0;
+	// largest distance of any particle from the attractor in real space, as given by utl::real_space_distance
+	double max_distance = 0.0;
+	// grid of sites 0 to `side` along each axis surrounded by a layer of barred halo sites
+	std::size_t side = 0U;
+	std::array<std::size_t, N> stride = {};
+	std::vector<std::uint32_t> grid;
+	// offsets in the grid of the distinct nearest neighbours of the lattice
+	std::vector<std::ptrdiff_t> neighbours;
+	// grid sites of the perimeter
+	std::vector<std::size_t> perimeter;
+	// slot of the perimeter drawn for the next particle, none if the perimeter was collected anew since
+	std::size_t drawn_slot = no_slot;
+	// spawn sources for which the barred sites of the grid were set
+	std::pair<bool, bool> grid_sources;
+	/**
+	 * \brief Computes the index in the grid of a site.
+	 */
+	std::size_t node_of(const site_type& s) const noexcept;
+	/**
+	 * \brief Computes the site of an index in the grid.
+	 */
+	site_type site_of(std::size_t node) const noexcept;
+	/**
+	 * \brief Computes the side of the grid for an aggregate of given extent.
+	 */
+	static std::size_t grid_side_for(int ext) noexcept;
+	/**
+	 * \brief Gets whether a site lies on the side of the spawn sources, such that it may join the aggregate.
+	 */
+	bool is_growth_site(const site_type& s) const noexcept;
+	/**
+	 * \brief Builds the grid for the given side, placing the attractor and aggregate and carrying over
+	 *        the perimeter in slot order, then appending any further empty neighbours of the aggregate.
+	 *
+	 * \param _side Side of the grid.
+	 */
+	void build_grid(std::size_t _side);
+	/**
+	 * \brief Occupies the site of a perimeter slot by a new particle of the aggregate.
+	 *
+	 * \param slot Slot of the perimeter.
+	 */
+	void occupy(std::size_t slot);
+};
+
+typedef Eden<2U> Eden_2d;
+typedef Eden<3U> Eden_3d;
+
+extern template class Eden<2U>;
+extern template class Eden<3U>;
@@ -0,0 +1,318 @@
+#include "Stdafx.h"
+#include "aggregate_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace {
+	// layout of the start of each cache file, followed by the co-ordinates and generator state
+	struct file_header {
+		char magic[4];
+		std::uint32_t engine_version;
+		std::uint32_t dimension;
+		std::uint32_t state_bytes;
+		std::uint64_t hash;
+		std::uint64_t count;
+		std::uint64_t misses;
+		std::uint64_t steps;
+	};
+	const char file_magic[4] = { 'D', 'L', 'A', 'C' };
+	const char* entry_extension = ".dla";
+	// serialises eviction scans of caches within this process
+	std::mutex cache_mtx;
+	std::atomic<unsigned> temp_counter{ 0U };
+
+	struct file_info {
+		std::string path;
+		std::uint64_t bytes;
+		std::int64_t modified;
+	};
+	// lists the cache entries in `dir`
+	std::vector<file_info> list_entries(const std::string& dir) {
+		std::vector<file_info> files;
+		const std::size_t ext_len = std::strlen(entry_extension);
+		auto is_entry = [ext_len](const std::string& name) {
+			return name.size() > ext_len && name.compare(name.size() - ext_len, ext_len, entry_extension) == 0;
+		};
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((dir + "\\*").c_str(), &data);
+		if (find == INVALID_HANDLE_VALUE) return files;
+		do {
+			const std::string name = data.cFileName;
+			if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || !is_entry(name)) continue;
+			const std::uint64_t modified = (static_cast<std::uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+			files.push_back(file_info{ dir + "\\" + name,
+				(static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow, static_cast<std::int64_t>(modified) });
+		} while (FindNextFileA(find, &data));
+		FindClose(find);
+#else
+		DIR* d = opendir(dir.c_str());
+		if (!d) return files;
+		while (dirent* ent = readdir(d)) {
+			const std::string name = ent->d_name;
+			if (!is_entry(name)) continue;
+			struct stat st;
+			const std::string path = dir + "/" + name;
+			if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+			files.push_back(file_info{ path, static_cast<std::uint64_t>(st.st_size), static_cast<std::int64_t>(st.st_mtime) });
+		}
+		closedir(d);
+#endif
+		return files;
+	}
+
+	unsigned process_id() {
+#ifdef _WIN32
+		return static_cast<unsigned>(GetCurrentProcessId());
+#else
+		return static_cast<unsigned>(getpid());
+#endif
+	}
+
+	bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+		return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+	}
+
+	void touch(const std::string& path) {
+#ifdef _WIN32
+		_utime(path.c_str(), nullptr);
+#else
+		utime(path.c_str(), nullptr);
+#endif
+	}
+
+	void fnv1a(std::uint64_t& h, const void* data, std::size_t n) noexcept {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0U; i < n; ++i) {
+			h ^= bytes[i];
+			h *= 1099511628211ULL;
+		}
+	}
+	template<typename Ty>
+	void fnv1a_value(std::uint64_t& h, Ty value) noexcept {
+		// hash fixed width little-endian representation, independent of platform word size
+		const std::uint64_t v = static_cast<std::uint64_t>(value);
+		unsigned char bytes[8];
+		for (std::size_t i = 0U; i < 8U; ++i) bytes[i] = static_cast<unsigned char>(v >> (8U*i));
+		fnv1a(h, bytes, 8U);
+	}
+}
+
+bool utl::mapped_file::open(const std::string& path) {
+	release();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) return false;
+	address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!address) {
+		CloseHandle(mapping);
+		return false;
+	}
+	native_handle = mapping;
+	bytes = static_cast<std::size_t>(file_size.QuadPart);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void* addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) return false;
+	address = addr;
+	bytes = static_cast<std::size_t>(st.st_size);
+#endif
+	return true;
+}
+
+utl::mapped_file::mapped_file(mapped_file&& other) noexcept
+	: address(other.address), bytes(other.bytes), native_handle(other.native_handle) {
+	other.address = nullptr;
+	other.native_handle = nullptr;
+	other.bytes = 0U;
+}
+
+utl::mapped_file& utl::mapped_file::operator=(mapped_file&& other) noexcept {
+	if (this != &other) {
+		release();
+		address = other.address;
+		bytes = other.bytes;
+		native_handle = other.native_handle;
+		other.address = nullptr;
+		other.native_handle = nullptr;
+		other.bytes = 0U;
+	}
+	return *this;
+}
+
+utl::mapped_file::~mapped_file() {
+	release();
+}
+
+void utl::mapped_file::release() noexcept {
+#ifdef _WIN32
+	if (address) UnmapViewOfFile(address);
+	if (native_handle) CloseHandle(static_cast<HANDLE>(native_handle));
+#else
+	if (address) munmap(address, bytes);
+#endif
+	address = nullptr;
+	native_handle = nullptr;
+	bytes = 0U;
+}
+
+utl::aggregate_cache::aggregate_cache(const std::string& _directory, std::uint64_t _max_bytes)
+	: dir(_directory), max_size(_max_bytes) {
+#ifdef _WIN32
+	if (!CreateDirectoryA(dir.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+		throw std::runtime_error("unable to create aggregate cache directory " + dir);
+#else
+	if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+		throw std::runtime_error("unable to create aggregate cache directory " + dir);
+#endif
+}
+
+std::uint64_t utl::aggregate_cache::hash(const key& k) noexcept {
+	std::uint64_t h = 14695981039346656037ULL;
+	std::uint64_t coeff_bits;
+	static_assert(sizeof(coeff_bits) == sizeof(k.coeff_stick), "double must be 64-bit.");
+	std::memcpy(&coeff_bits, &k.coeff_stick, sizeof(coeff_bits));
+	fnv1a_value(h, engine_version);
+	fnv1a_value(h, k.dimension);
+	fnv1a_value(h, static_cast<int>(k.lattice));
+	fnv1a_value(h, static_cast<int>(k.attractor));
+	fnv1a_value(h, k.attractor_size);
+	fnv1a_value(h, k.size);
+	fnv1a_value(h, coeff_bits);
+	fnv1a_value(h, k.spawn_above);
+	fnv1a_value(h, k.spawn_below);
+	// hashed only if set, such that entries cached before periodic boundaries existed remain valid
+	if (k.periodic) fnv1a_value(h, k.periodic);
+	fnv1a_value(h, k.seed);
+	fnv1a_value(h, k.stream);
+	return h;
+}
+
+std::string utl::aggregate_cache::entry_path(std::uint64_t h) const {
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(h));
+#ifdef _WIN32
+	return dir + "\\" + name + entry_extension;
+#else
+	return dir + "/" + name + entry_extension;
+#endif
+}
+
+bool utl::aggregate_cache::lookup(const key& k, entry& e) const {
+	const std::uint64_t h = hash(k);
+	const std::string path = entry_path(h);
+	mapped_file file;
+	if (!file.open(path) || file.size() < sizeof(file_header)) return false;
+	file_header header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	const std::uint64_t coord_bytes = header.count * header.dimension * sizeof(std::int32_t);
+	if (std::memcmp(header.magic, file_magic, sizeof(file_magic)) || header.engine_version != engine_version
+		|| header.hash != h || header.dimension != k.dimension || header.count != k.size
+		|| file.size() != sizeof(file_header) + coord_bytes + header.state_bytes) return false;
+	const char* base = static_cast<const char*>(file.data());
+	e.coordinates = reinterpret_cast<const std::int32_t*>(base + sizeof(file_header));
+	e.count = static_cast<std::size_t>(header.count);
+	e.dimension = header.dimension;
+	e.misses = header.misses;
+	e.steps = header.steps;
+	e.generator_state.assign(base + sizeof(file_header) + coord_bytes, header.state_bytes);
+	e.file = std::move(file);
+	touch(path);	// most recently used
+	return true;
+}
+
+void utl::aggregate_cache::store(const key& k, const std::int32_t* coordinates, std::size_t count, std::uint64_t misses,
+	std::uint64_t steps, const std::string& generator_state) const {
+	const std::uint64_t h = hash(k);
+	const std::uint64_t coord_bytes = static_cast<std::uint64_t>(count) * k.dimension * sizeof(std::int32_t);
+	const std::uint64_t total = sizeof(file_header) + coord_bytes + generator_state.size();
+	if (total > max_size) return;
+	std::lock_guard<std::mutex> lock(cache_mtx);
+	evict(total);
+	const std::string path = entry_path(h);
+	const std::string temp = path + ".tmp" + std::to_string(process_id()) + "_" + std::to_string(temp_counter++);
+	{
+		std::ofstream ofs(temp, std::ios::binary | std::ios::trunc);
+		if (!ofs) return;
+		file_header header;
+		std::memcpy(header.magic, file_magic, sizeof(file_magic));
+		header.engine_version = engine_version;
+		header.dimension = k.dimension;
+		header.state_bytes = static_cast<std::uint32_t>(generator_state.size());
+		header.hash = h;
+		header.count = count;
+		header.misses = misses;
+		header.steps = steps;
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(coordinates), static_cast<std::streamsize>(coord_bytes));
+		ofs.write(generator_state.data(), static_cast<std::streamsize>(generator_state.size()));
+		if (!ofs) {
+			ofs.close();
+			std::remove(temp.c_str());
+			return;
+		}
+	}
+	if (!replace_file(temp, path)) std::remove(temp.c_str());
+}
+
+std::uint64_t utl::aggregate_cache::size_bytes() const {
+	std::uint64_t total = 0U;
+	for (const auto& f : list_entries(dir)) total += f.bytes;
+	return total;
+}
+
+void utl::aggregate_cache::clear() const {
+	std::lock_guard<std::mutex> lock(cache_mtx);
+	for (const auto& f : list_entries(dir)) std::remove(f.path.c_str());
+}
+
+void utl::aggregate_cache::evict(std::uint64_t incoming) const {
+	std::vector<file_info> files = list_entries(dir);
+	std::uint64_t total = incoming;
+	for (const auto& f : files) total += f.bytes;
+	if (total <= max_size) return;
+	// least recently used first
+	std::sort(files.begin(), files.end(), [](const file_info& lhs, const file_info& rhs) { return lhs.modified < rhs.modified; });
+	for (const auto& f : files) {
+		if (total <= max_size) break;
+		if (std::remove(f.path.c_str()) == 0) total -= f.bytes;
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include "utilities.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace utl {
+	/**
+	 * \class mapped_file
+	 *
+	 * \brief RAII read-only memory mapping of a whole file, `mmap` on POSIX systems and a file
+	 *        mapping on Windows.
+	 */
+	class mapped_file {
+	public:
+		/**
+		 * \brief Creates an empty mapping.
+		 */
+		mapped_file() noexcept = default;
+		/**
+		 * \brief Maps the file at `path` read-only.
+		 *
+		 * \param path Path of file.
+		 * \return true if the file was mapped, false if it does not exist, is empty or cannot be mapped.
+		 */
+		bool open(const std::string& path);
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept;
+		mapped_file& operator=(mapped_file&& other) noexcept;
+		~mapped_file();
+		const void* data() const noexcept { return address; }
+		std::size_t size() const noexcept { return bytes; }
+	private:
+		void release() noexcept;
+		void* address = nullptr;
+		std::size_t bytes = 0U;
+		void* native_handle = nullptr;	// HANDLE of file mapping on Windows, unused on POSIX
+	};
+	/**
+	 * \class aggregate_cache
+	 *
+	 * \brief Content-addressed on-disk cache of finished aggregates, keyed by a hash of every
+	 *        parameter determining a seeded generation together with the engine version.
+	 *
+	 * Each aggregate is stored in its own file, named by the hash, holding the particles in
+	 * generation order as packed 32-bit co-ordinates along with the miss and step counters and the
+	 * state of the random number generator after generation, such that continuing growth of a cached
+	 * aggregate is identical to continuing the original. Hits are served from a read-only mapping
+	 * of the file. The total size of the cache directory is bounded by evicting the least recently
+	 * used entries, recency being tracked by file modification time so that it persists across
+	 * sessions. Entries are written to a temporary file and renamed into place, such that several
+	 * processes may share one cache directory.
+	 */
+	class aggregate_cache {
+	public:
+		// version of the generation algorithm, to be incremented by any change altering the aggregate
+		// generated for a given seed such that stale entries are never served
+		static constexpr std::uint32_t engine_version = 2U;
+		/**
+		 * \struct key
+		 *
+		 * \brief Parameters which, together with the engine version, fully determine a seeded aggregate.
+		 */
+		struct key {
+			unsigned dimension;
+			lattice_type lattice;
+			attractor_type attractor;
+			std::size_t attractor_size;
+			std::size_t size;
+			double coeff_stick;
+			bool spawn_above;
+			bool spawn_below;
+			bool periodic;
+			std::uint64_t seed;
+			std::uint64_t stream;
+		};
+		/**
+		 * \struct entry
+		 *
+		 * \brief View of a cached aggregate, valid whilst the entry (holding its file mapping) lives.
+		 */
+		struct entry {
+			mapped_file file;
+			const std::int32_t* coordinates = nullptr;	// `dimension` co-ordinates per particle
+			std::size_t count = 0U;
+			unsigned dimension = 0U;
+			std::uint64_t misses = 0U;
+			std::uint64_t steps = 0U;
+			std::string generator_state;
+		};
+		/**
+		 * \brief Creates a cache in `_directory`, creating the directory if it does not exist.
+		 *
+		 * \param _directory Directory of cache files.
+		 * \param _max_bytes Maximum total size of cache files.
+		 * \throw Throws std::runtime_error if the directory cannot be created.
+		 */
+		aggregate_cache(const std::string& _directory, std::uint64_t _max_bytes);
+		const std::string& directory() const noexcept { return dir; }
+		std::uint64_t max_bytes() const noexcept { return max_size; }
+		/**
+		 * \brief Computes the content address of an aggregate.
+		 *
+		 * \param k Parameters of aggregate.
+		 * \return 64-bit FNV-1a hash of the parameters and engine version.
+		 */
+		static std::uint64_t hash(const key& k) noexcept;
+		/**
+		 * \brief Looks up an aggregate, marking it as most recently used on a hit.
+		 *
+		 * \param k Parameters of aggregate.
+		 * \param e Entry to fill on a hit.
+		 * \return true on a hit, false otherwise (including for corrupt entries).
+		 */
+		bool lookup(const key& k, entry& e) const;
+		/**
+		 * \brief Stores an aggregate, evicting least recently used entries as required. Does nothing
+		 *        if the aggregate alone exceeds the size bound or cannot be written.
+		 *
+		 * \param k Parameters of aggregate.
+		 * \param coordinates Packed co-ordinates of `count` particles in generation order.
+		 * \param count Number of particles.
+		 * \param misses Number of aggregate misses.
+		 * \param steps Number of random walk steps.
+		 * \param generator_state Serialised state of the random number generator after generation.
+		 */
+		void store(const key& k, const std::int32_t* coordinates, std::size_t count, std::uint64_t misses,
+			std::uint64_t steps, const std::string& generator_state) const;
+		/**
+		 * \brief Gets the total size of the entries in the cache directory.
+		 */
+		std::uint64_t size_bytes() const;
+		/**
+		 * \brief Removes every entry from the cache directory.
+		 */
+		void clear() const;
+	private:
+		std::string dir;
+		std::uint64_t max_size;
+		std::string entry_path(std::uint64_t h) const;
+		void evict(std::uint64_t incoming) const;
+	};
+}
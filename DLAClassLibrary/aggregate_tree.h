@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace utl {
+	/**
+	 * \brief Sentinel parent index of a particle which attached directly to the attractor
+	 *        rather than to another particle of the aggregate.
+	 */
+	constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+	/**
+	 * \struct tree_topology
+	 *
+	 * \brief Branch topology of an aggregate viewed as a forest rooted on the attractor, where
+	 *        each particle is linked to the particle (or attractor site) it stuck to.
+	 *
+	 * Per-particle vectors are indexed by order of generation, i.e. the same indices as the
+	 * aggregate buffer.
+	 */
+	struct tree_topology {
+		// number of bonds between each particle and the attractor (= 1 for particles stuck to the attractor)
+		std::vector<std::size_t> chemical_distance;
+		// Horton-Strahler order of the sub-tree rooted at each particle (= 1 for tips)
+		std::vector<std::size_t> strahler_order;
+		// number of particles in each unbranched segment, a segment running from a root or
+		// branch point child down to the next tip or branch point
+		std::vector<std::size_t> branch_lengths;
+		// number of particles with no children
+		std::size_t tip_count = 0U;
+		// Horton-Strahler order of the whole aggregate
+		std::size_t max_strahler_order = 0U;
+		// largest chemical distance of any particle from the attractor
+		std::size_t max_chemical_distance = 0U;
+	};
+	/**
+	 * \brief Computes the branch topology of an aggregate from its parent-index array in O(N).
+	 *
+	 * Relies on every particle having been attached after its parent, such that `parents[i] < i`
+	 * for all non-root particles; a single forward pass then resolves chemical distances and
+	 * segments and a single reverse pass resolves Horton-Strahler orders.
+	 *
+	 * \param parents Parent index of each particle in generation order, `utl::no_parent` for roots.
+	 * \return Branch topology of the aggregate.
+	 * \throw Throws std::invalid_argument if a parent index does not precede its child.
+	 */
+	inline tree_topology analyse_tree_topology(const std::vector<std::size_t>& parents) {
+		const std::size_t n = parents.size();
+		tree_topology topology;
+		topology.chemical_distance.resize(n);
+		topology.strahler_order.resize(n);
+		std::vector<std::size_t> child_count(n, 0U);
+		for (std::size_t i = 0U; i < n; ++i) {
+			if (parents[i] == no_parent) continue;
+			if (parents[i] >= i) throw std::invalid_argument("parent index must precede child index.");
+			++child_count[parents[i]];
+		}
+		// forward pass: chemical distance and unbranched segment membership
+		std::vector<std::size_t> segment(n);
+		for (std::size_t i = 0U; i < n; ++i) {
+			const std::size_t p = parents[i];
+			topology.chemical_distance[i] = (p == no_parent) ? 1U : topology.chemical_distance[p] + 1U;
+			topology.max_chemical_distance = std::max(topology.max_chemical_distance, topology.chemical_distance[i]);
+			// start a new segment at roots and at each child of a branch point
+			if (p == no_parent || child_count[p] > 1U) {
+				segment[i] = topology.branch_lengths.size();
+				topology.branch_lengths.push_back(0U);
+			}
+			else segment[i] = segment[p];
+			++topology.branch_lengths[segment[i]];
+			if (!child_count[i]) ++topology.tip_count;
+		}
+		// reverse pass: children always finalised before their parents
+		std::vector<std::size_t> max_child_order(n, 0U);
+		std::vector<std::size_t> max_child_order_count(n, 0U);
+		for (std::size_t i = n; i-- > 0U;) {
+			std::size_t order = 1U;
+			if (max_child_order[i]) order = max_child_order[i] + ((max_child_order_count[i] > 1U) ? 1U : 0U);
+			topology.strahler_order[i] = order;
+			topology.max_strahler_order = std::max(topology.max_strahler_order, order);
+			const std::size_t p = parents[i];
+			if (p == no_parent) continue;
+			if (order > max_child_order[p]) {
+				max_child_order[p] = order;
+				max_child_order_count[p] = 1U;
+			}
+			else if (order == max_child_order[p]) ++max_child_order_count[p];
+		}
+		return topology;
+	}
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include "observer_dispatcher.h"
+#include "particle_stream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace utl {
+	/**
+	 * \enum dispatch_mode
+	 *
+	 * \brief Defines where attachment notifications are delivered to an observer.
+	 */
+	enum class dispatch_mode {
+		INLINE, // on the generating thread, with a view into the aggregate buffer
+		THREAD, // on a dedicated dispatch thread, with a view into a copy of the batch
+	};
+	/**
+	 * \class attachment_observer
+	 *
+	 * \brief Interface for observing particles as they attach to an aggregate.
+	 *
+	 * \tparam Particle Co-ordinate type of the aggregate particles.
+	 */
+	template<class Particle>
+	class attachment_observer {
+	public:
+		virtual ~attachment_observer() = default;
+		/**
+		 * \brief Invoked with each batch of newly attached particles, in generation order.
+		 *
+		 * \param batch View of the new particles, valid only for the duration of the call.
+		 * \param first_index Generation index (buffer index) of the first particle in `batch`.
+		 */
+		virtual void on_attach(const particle_batch<Particle>& batch, std::size_t first_index) = 0;
+	};
+	/**
+	 * \class attachment_notifier
+	 *
+	 * \brief Batches attachment events of an aggregate and delivers them to registered observers.
+	 *
+	 * Each observer is notified once `batch_size` particles have attached since its last notification
+	 * or `interval` has elapsed since then, whichever comes first, and once more for any remainder when
+	 * a generation ends. Observers registered with `dispatch_mode::THREAD` share a single dispatch thread
+	 * created upon the first such registration.
+	 *
+	 * Batching is evaluated only as particles attach, there being no timer: a batch held back by
+	 * `interval` is delivered upon the next attachment after the interval elapses, or by the final
+	 * flush of the generation should no further particle attach.
+	 *
+	 * An exception thrown by an observer on the dispatch thread is rethrown on the generating thread
+	 * by the next `flush` or `remove`.
+	 *
+	 * \tparam Particle Co-ordinate type of the aggregate particles.
+	 */
+	template<class Particle>
+	class attachment_notifier {
+		typedef std::chrono::steady_clock clock_type;
+		struct registration {
+			std::shared_ptr<attachment_observer<Particle>> observer;
+			std::size_t batch_size;
+			clock_type::duration interval;
+			dispatch_mode mode;
+			std::size_t cursor;
+			clock_type::time_point last_notified;
+		};
+	public:
+		attachment_notifier() = default;
+		/**
+		 * \brief Copy constructor, observers are not copied such that the copy starts unobserved.
+		 */
+		attachment_notifier(const attachment_notifier&) noexcept {}
+		attachment_notifier(attachment_notifier&&) noexcept = default;
+		/**
+		 * \brief Gets whether any observers are registered.
+		 *
+		 * \return true if at least one observer is registered, false otherwise.
+		 */
+		bool active() const noexcept { return !registrations.empty(); }
+		/**
+		 * \brief Registers an observer, which is notified of particles attached from now on.
+		 *
+		 * \param observer Observer to register.
+		 * \param batch_size Number of particles per notification, zero to batch by time only.
+		 * \param interval Maximum time between notifications, zero to batch by count only.
+		 * \param mode Thread on which to deliver notifications.
+		 * \param cursor Buffer index of the first particle to notify.
+		 */
+		void add(std::shared_ptr<attachment_observer<Particle>> observer, std::size_t batch_size,
+			std::chrono::microseconds interval, dispatch_mode mode, std::size_t cursor) {
+			if (mode == dispatch_mode::THREAD && !dispatcher) dispatcher = std::make_unique<observer_dispatcher>();
+			registrations.push_back({ std::move(observer), batch_size, interval, mode, cursor, clock_type::now() });
+			update_timed();
+		}
+		/**
+		 * \brief Unregisters an observer after delivering any notifications already posted to it.
+		 *
+		 * \param observer Observer to unregister.
+		 * \throw Rethrows the first exception thrown by a dispatched observer since last rethrown,
+		 *        the observer being unregistered regardless.
+		 */
+		void remove(const std::shared_ptr<attachment_observer<Particle>>& observer) {
+			registrations.erase(std::remove_if(registrations.begin(), registrations.end(),
+				[&observer](const registration& r) { return r.observer == observer; }), registrations.end());
+			update_timed();
+			if (dispatcher) dispatcher->drain();
+		}
+		/**
+		 * \brief Notifies each observer whose batch is complete after a particle was appended to `buffer`.
+		 *
+		 * \param buffer Aggregate buffer in generation order.
+		 */
+		template<class Alloc>
+		void on_push(const std::vector<Particle, Alloc>& buffer) {
+			// only read the clock if some observer batches by time
+			const clock_type::time_point now = any_timed ? clock_type::now() : clock_type::time_point();
+			for (auto& r : registrations) {
+				const std::size_t pending = buffer.size() - r.cursor;
+				if ((r.batch_size && pending >= r.batch_size)
+					|| (r.interval.count() > 0 && now - r.last_notified >= r.interval)
+					|| (!r.batch_size && r.interval.count() <= 0)) notify(r, buffer, now);
+			}
+		}
+		/**
+		 * \brief Notifies every observer of all of its pending particles.
+		 *
+		 * \param buffer Aggregate buffer in generation order.
+		 * \throw Rethrows the first exception thrown by a dispatched observer since last rethrown, without
+		 *        waiting for the notifications posted by this flush.
+		 */
+		template<class Alloc>
+		void flush(const std::vector<Particle, Alloc>& buffer) {
+			const clock_type::time_point now = clock_type::now();
+			for (auto& r : registrations) {
+				if (buffer.size() > r.cursor) notify(r, buffer, now);
+			}
+			if (dispatcher) dispatcher->rethrow_error();
+		}
+		/**
+		 * \brief Rewinds every observer to `cursor`, used when the aggregate is cleared.
+		 *
+		 * \param cursor Buffer index of the next particle to notify.
+		 */
+		void reset(std::size_t cursor) noexcept {
+			for (auto& r : registrations) r.cursor = cursor;
+		}
+	private:
+		std::vector<registration> registrations;
+		std::unique_ptr<observer_dispatcher> dispatcher;
+		bool any_timed = false;
+		void update_timed() noexcept {
+			any_timed = std::any_of(registrations.begin(), registrations.end(),
+				[](const registration& r) { return r.interval.count() > 0; });
+		}
+		template<class Alloc>
+		void notify(registration& r, const std::vector<Particle, Alloc>& buffer, clock_type::time_point now) {
+			const std::size_t first_index = r.cursor;
+			if (r.mode == dispatch_mode::INLINE) {
+				particle_batch<Particle> batch;
+				batch.first = buffer.data() + first_index;
+				batch.last = buffer.data() + buffer.size();
+				r.observer->on_attach(batch, first_index);
+			}
+			else {
+				// copy batch since the buffer may reallocate before the dispatch thread runs
+				auto copy = std::make_shared<std::vector<Particle>>(buffer.begin() + first_index, buffer.end());
+				std::shared_ptr<attachment_observer<Particle>> observer = r.observer;
+				dispatcher->post([observer, copy, first_index]() {
+					particle_batch<Particle> batch;
+					batch.first = copy->data();
+					batch.last = copy->data() + copy->size();
+					observer->on_attach(batch, first_index);
+				});
+			}
+			r.cursor = buffer.size();
+			r.last_notified = now;
+		}
+	};
+}
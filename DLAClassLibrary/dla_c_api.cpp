@@ -0,0 +1,247 @@
+#include "Stdafx.h"
+#define DLA_C_API_EXPORTS
+#include "dla_c_api.h"
+#include "DLA_2d.h"
+#include "DLA_3d.h"
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+struct dla_handle {
+	std::unique_ptr<DLAContainer> dla;
+	// typed views of dla for dimension specific operations, exactly one is non-null
+	DLA_2d* dla_2d = nullptr;
+	DLA_3d* dla_3d = nullptr;
+};
+
+namespace {
+	thread_local std::string last_error;
+	// translates any exception escaping `f` into a dla_status, recording its message
+	template<class Fn>
+	dla_status guarded(Fn&& f) noexcept {
+		try {
+			f();
+			return DLA_OK;
+		}
+		catch (const std::invalid_argument& ex) { last_error = ex.what(); return DLA_INVALID_ARGUMENT; }
+		catch (const std::logic_error& ex) { last_error = ex.what(); return DLA_LOGIC_ERROR; }
+		catch (const std::bad_alloc& ex) { last_error = ex.what(); return DLA_OUT_OF_MEMORY; }
+		catch (const std::exception& ex) { last_error = ex.what(); return DLA_UNKNOWN_ERROR; }
+		catch (...) { last_error = "unknown error."; return DLA_UNKNOWN_ERROR; }
+	}
+	// converts a lattice received from C, which may hold any int, rejecting values out of range
+	lattice_type to_lattice_type(dla_lattice lattice) {
+		if (lattice < DLA_LATTICE_SQUARE || lattice > DLA_LATTICE_BCC) throw std::invalid_argument("Unrecognised lattice type.");
+		return static_cast<lattice_type>(lattice);
+	}
+	// converts an attractor received from C, which may hold any int, rejecting values out of range
+	attractor_type to_attractor_type(dla_attractor attractor) {
+		if (attractor < DLA_ATTRACTOR_POINT || attractor > DLA_ATTRACTOR_CIRCLE) throw std::invalid_argument("Unrecognised attractor type.");
+		return static_cast<attractor_type>(attractor);
+	}
+	// computes the int offset of element `I` within a particle of the aggregate buffer
+	template<std::size_t I, class Particle>
+	std::size_t element_offset(const Particle& p) noexcept {
+		return static_cast<std::size_t>(&std::get<I>(p) - reinterpret_cast<const int*>(&p));
+	}
+	static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int), "std::pair<int,int> must be tightly packed.");
+	static_assert(sizeof(std::tuple<int, int, int>) == 3 * sizeof(int), "std::tuple<int,int,int> must be tightly packed.");
+	static_assert(sizeof(dla_growth_sample) == sizeof(utl::growth_sample), "dla_growth_sample must mirror utl::growth_sample.");
+}
+
+dla_status dla_create(unsigned dimension, dla_lattice lattice, dla_attractor attractor,
+	size_t attractor_size, double coeff_stick, dla_handle** out) {
+	return guarded([&]() {
+		if (!out) throw std::invalid_argument("out must not be null.");
+		const lattice_type ltt = to_lattice_type(lattice);
+		const attractor_type att = to_attractor_type(attractor);
+		auto handle = std::make_unique<dla_handle>();
+		switch (dimension) {
+		case 2U:
+			if (attractor == DLA_ATTRACTOR_PLANE) throw std::invalid_argument("Cannot set attractor type of 2D DLA to PLANE.");
+			handle->dla_2d = new DLA_2d(ltt, att, attractor_size, coeff_stick);
+			handle->dla.reset(handle->dla_2d);
+			break;
+		case 3U:
+			handle->dla_3d = new DLA_3d(ltt, att, attractor_size, coeff_stick);
+			handle->dla.reset(handle->dla_3d);
+			break;
+		default:
+			throw std::invalid_argument("dimension must be 2 or 3.");
+		}
+		*out = handle.release();
+	});
+}
+
+dla_status dla_copy(const dla_handle* handle, dla_handle** out) {
+	return guarded([&]() {
+		if (!out) throw std::invalid_argument("out must not be null.");
+		auto copy = std::make_unique<dla_handle>();
+		if (handle->dla_2d) {
+			copy->dla_2d = new DLA_2d(*handle->dla_2d);
+			copy->dla.reset(copy->dla_2d);
+		}
+		else {
+			copy->dla_3d = new DLA_3d(*handle->dla_3d);
+			copy->dla.reset(copy->dla_3d);
+		}
+		*out = copy.release();
+	});
+}
+
+void dla_destroy(dla_handle* handle) {
+	delete handle;
+}
+
+unsigned dla_dimension(const dla_handle* handle) {
+	return handle->dla_2d ? 2U : 3U;
+}
+
+size_t dla_size(const dla_handle* handle) {
+	return handle->dla->size();
+}
+
+double dla_get_coeff_stick(const dla_handle* handle) {
+	return handle->dla->get_coeff_stick();
+}
+
+dla_status dla_set_coeff_stick(dla_handle* handle, double coeff_stick) {
+	return guarded([&]() { handle->dla->set_coeff_stick(coeff_stick); });
+}
+
+dla_lattice dla_get_lattice_type(const dla_handle* handle) {
+	return static_cast<dla_lattice>(handle->dla->get_lattice_type());
+}
+
+dla_status dla_set_lattice_type(dla_handle* handle, dla_lattice lattice) {
+	return guarded([&]() { handle->dla->set_lattice_type(to_lattice_type(lattice)); });
+}
+
+dla_attractor dla_get_attractor_type(const dla_handle* handle, size_t* attractor_size) {
+	const auto att = handle->dla->get_attractor_type();
+	if (attractor_size) *attractor_size = att.second;
+	return static_cast<dla_attractor>(att.first);
+}
+
+dla_status dla_set_attractor_type(dla_handle* handle, dla_attractor attractor, size_t attractor_size) {
+	return guarded([&]() { handle->dla->set_attractor_type(to_attractor_type(attractor), attractor_size); });
+}
+
+size_t dla_spanning_distance(const dla_handle* handle) {
+	return handle->dla->aggregate_spanning_distance();
+}
+
+size_t dla_misses(const dla_handle* handle) {
+	return handle->dla->aggregate_misses();
+}
+
+double dla_estimate_fractal_dimension(const dla_handle* handle) {
+	return handle->dla->estimate_fractal_dimension();
+}
+
+void dla_raise_abort_signal(dla_handle* handle) {
+	handle->dla->raise_abort_signal();
+}
+
+void dla_reset_abort_signal(dla_handle* handle) {
+	handle->dla->reset_abort_signal();
+}
+
+void dla_set_continuous(dla_handle* handle, int continuous) {
+	handle->dla->change_continuous_flag(continuous != 0);
+}
+
+dla_status dla_set_spawn_source(dla_handle* handle, int above, int below) {
+	return guarded([&]() { handle->dla->set_random_walk_particle_spawn_source(std::make_pair(above != 0, below != 0)); });
+}
+
+dla_status dla_set_parent_tracking(dla_handle* handle, int track) {
+	return guarded([&]() { handle->dla->set_parent_tracking(track != 0); });
+}
+
+dla_status dla_set_periodic_boundaries(dla_handle* handle, int periodic) {
+	return guarded([&]() { handle->dla->set_periodic_boundaries(periodic != 0); });
+}
+
+dla_status dla_set_growth_recording(dla_handle* handle, int record, size_t samples_per_decade) {
+	return guarded([&]() { handle->dla->set_growth_recording(record != 0, samples_per_decade); });
+}
+
+void dla_seed_generator(dla_handle* handle, uint64_t seed, uint64_t stream, uint64_t offset) {
+	handle->dla->seed_generator(seed, stream, offset);
+}
+
+void dla_generator_position(const dla_handle* handle, uint64_t* seed, uint64_t* stream, uint64_t* offset) {
+	if (seed) *seed = handle->dla->get_seed();
+	if (stream) *stream = handle->dla->get_stream();
+	if (offset) *offset = handle->dla->get_generator_offset();
+}
+
+dla_status dla_set_aggregate_cache(dla_handle* handle, const char* directory, uint64_t max_bytes) {
+	return guarded([&]() {
+		handle->dla->set_aggregate_cache(directory ? std::make_shared<utl::aggregate_cache>(directory, max_bytes) : nullptr);
+	});
+}
+
+void dla_set_storage_reuse(dla_handle* handle, int reuse) {
+	handle->dla->set_storage_reuse(reuse != 0);
+}
+
+void dla_clear(dla_handle* handle) {
+	handle->dla->clear();
+}
+
+dla_status dla_generate(dla_handle* handle, size_t n) {
+	return guarded([&]() { handle->dla->generate(n); });
+}
+
+dla_status dla_grow_to(dla_handle* handle, size_t n) {
+	return guarded([&]() { handle->dla->grow_to(n); });
+}
+
+dla_status dla_grow_by(dla_handle* handle, size_t k) {
+	return guarded([&]() { handle->dla->grow_by(k); });
+}
+
+dla_buffer_view dla_aggregate_buffer(const dla_handle* handle) {
+	dla_buffer_view view = {};
+	if (handle->dla_2d) {
+		const auto& buffer = handle->dla_2d->aggregate_buffer();
+		const std::pair<int, int> probe{};
+		view.data = reinterpret_cast<const int*>(buffer.data());
+		view.length = buffer.size();
+		view.stride = 2U;
+		view.offsets[0] = element_offset<0>(probe);
+		view.offsets[1] = element_offset<1>(probe);
+		view.dimension = 2U;
+	}
+	else {
+		const auto& buffer = handle->dla_3d->aggregate_buffer();
+		const std::tuple<int, int, int> probe{};
+		view.data = reinterpret_cast<const int*>(buffer.data());
+		view.length = buffer.size();
+		view.stride = 3U;
+		view.offsets[0] = element_offset<0>(probe);
+		view.offsets[1] = element_offset<1>(probe);
+		view.offsets[2] = element_offset<2>(probe);
+		view.dimension = 3U;
+	}
+	return view;
+}
+
+const size_t* dla_parent_indices(const dla_handle* handle, size_t* length) {
+	const auto& parents = handle->dla->parent_indices();
+	if (length) *length = parents.size();
+	return parents.data();
+}
+
+const dla_growth_sample* dla_growth_series(const dla_handle* handle, size_t* length) {
+	const auto& series = handle->dla->growth_series();
+	if (length) *length = series.size();
+	return reinterpret_cast<const dla_growth_sample*>(series.data());
+}
+
+const char* dla_last_error(void) {
+	return last_error.c_str();
+}
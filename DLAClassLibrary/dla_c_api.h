@@ -0,0 +1,135 @@
+/*
+ * dla_c_api.h : stable C interface to the native DLA_2d and DLA_3d engines for use from any
+ * language with a C foreign function interface, independent of .NET.
+ *
+ * All functions taking a handle require a valid handle from dla_create or dla_copy. Functions
+ * returning dla_status never throw; on failure a description of the error on the calling thread
+ * is available from dla_last_error until the next failing call on that thread. A dla_lattice or
+ * dla_attractor value outside its enumeration is rejected with DLA_INVALID_ARGUMENT.
+ */
+#ifndef DLA_C_API_H
+#define DLA_C_API_H
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#	if defined(DLA_C_API_EXPORTS)
+#		define DLA_API __declspec(dllexport)
+#	else
+#		define DLA_API __declspec(dllimport)
+#	endif
+#else
+#	define DLA_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* opaque handle to a 2D or 3D aggregate */
+typedef struct dla_handle dla_handle;
+
+/* values match lattice_type */
+typedef enum dla_lattice {
+	DLA_LATTICE_SQUARE = 0,
+	DLA_LATTICE_TRIANGLE = 1,
+	DLA_LATTICE_HEXAGONAL = 2, /* 2D only */
+	DLA_LATTICE_FCC = 3,       /* 3D only */
+	DLA_LATTICE_BCC = 4        /* 3D only */
+} dla_lattice;
+
+/* values match attractor_type */
+typedef enum dla_attractor {
+	DLA_ATTRACTOR_POINT = 0,
+	DLA_ATTRACTOR_LINE = 1,
+	DLA_ATTRACTOR_PLANE = 2,
+	DLA_ATTRACTOR_CIRCLE = 3
+} dla_attractor;
+
+typedef enum dla_status {
+	DLA_OK = 0,
+	DLA_INVALID_ARGUMENT = 1, /* parameter out of range, e.g. coeff_stick not in (0,1] */
+	DLA_LOGIC_ERROR = 2,      /* operation invalid in current state */
+	DLA_OUT_OF_MEMORY = 3,
+	DLA_UNKNOWN_ERROR = 4
+} dla_status;
+
+/*
+ * Zero-copy view of an aggregate buffer in generation order. Co-ordinate k of particle i is
+ * data[i*stride + offsets[k]] for k < dimension. The view is invalidated by any call which
+ * grows or clears the aggregate.
+ */
+typedef struct dla_buffer_view {
+	const int* data;
+	size_t length;
+	size_t stride;
+	size_t offsets[3];
+	unsigned dimension;
+} dla_buffer_view;
+
+/* Growth sample recorded at a log-spaced aggregate size, layout identical to utl::growth_sample. */
+typedef struct dla_growth_sample {
+	uint64_t size;
+	double max_radius;
+	double radius_of_gyration;
+	uint64_t misses;
+	double seconds;
+	uint64_t steps;
+} dla_growth_sample;
+
+/* CONSTRUCTION/DESTRUCTION */
+DLA_API dla_status dla_create(unsigned dimension, dla_lattice lattice, dla_attractor attractor,
+	size_t attractor_size, double coeff_stick, dla_handle** out);
+DLA_API dla_status dla_copy(const dla_handle* handle, dla_handle** out);
+DLA_API void dla_destroy(dla_handle* handle);
+
+/* AGGREGATE PROPERTIES */
+DLA_API unsigned dla_dimension(const dla_handle* handle);
+DLA_API size_t dla_size(const dla_handle* handle);
+DLA_API double dla_get_coeff_stick(const dla_handle* handle);
+DLA_API dla_status dla_set_coeff_stick(dla_handle* handle, double coeff_stick);
+DLA_API dla_lattice dla_get_lattice_type(const dla_handle* handle);
+DLA_API dla_status dla_set_lattice_type(dla_handle* handle, dla_lattice lattice);
+DLA_API dla_attractor dla_get_attractor_type(const dla_handle* handle, size_t* attractor_size);
+DLA_API dla_status dla_set_attractor_type(dla_handle* handle, dla_attractor attractor, size_t attractor_size);
+DLA_API size_t dla_spanning_distance(const dla_handle* handle);
+DLA_API size_t dla_misses(const dla_handle* handle);
+DLA_API double dla_estimate_fractal_dimension(const dla_handle* handle);
+
+/* SIGNALS - safe to call from a thread other than the generating thread */
+DLA_API void dla_raise_abort_signal(dla_handle* handle);
+DLA_API void dla_reset_abort_signal(dla_handle* handle);
+DLA_API void dla_set_continuous(dla_handle* handle, int continuous);
+
+/* GENERATION */
+DLA_API dla_status dla_set_spawn_source(dla_handle* handle, int above, int below);
+DLA_API dla_status dla_set_parent_tracking(dla_handle* handle, int track);
+/* wrap random walkers about the ends of a line or plane attractor rather than reflecting them, on an empty aggregate */
+DLA_API dla_status dla_set_periodic_boundaries(dla_handle* handle, int periodic);
+DLA_API dla_status dla_set_growth_recording(dla_handle* handle, int record, size_t samples_per_decade);
+/* position the counter-based generator at offset values into stream of seed, in constant time */
+DLA_API void dla_seed_generator(dla_handle* handle, uint64_t seed, uint64_t stream, uint64_t offset);
+/* current seed, stream and offset of the generator, restoring it when passed to dla_seed_generator */
+DLA_API void dla_generator_position(const dla_handle* handle, uint64_t* seed, uint64_t* stream, uint64_t* offset);
+/* serve generations from empty directly after dla_seed_generator out of an on-disk aggregate cache in directory, null to detach */
+DLA_API dla_status dla_set_aggregate_cache(dla_handle* handle, const char* directory, uint64_t max_bytes);
+/* retain storage across dla_clear, vacating the aggregate in constant time, for ensembles of small aggregates */
+DLA_API void dla_set_storage_reuse(dla_handle* handle, int reuse);
+DLA_API void dla_clear(dla_handle* handle);
+DLA_API dla_status dla_generate(dla_handle* handle, size_t n);
+DLA_API dla_status dla_grow_to(dla_handle* handle, size_t n);
+DLA_API dla_status dla_grow_by(dla_handle* handle, size_t k);
+
+/* DATA ACCESS */
+DLA_API dla_buffer_view dla_aggregate_buffer(const dla_handle* handle);
+/* parent index of each particle in generation order, (size_t)-1 for particles stuck to the attractor */
+DLA_API const size_t* dla_parent_indices(const dla_handle* handle, size_t* length);
+/* growth samples in order of increasing aggregate size, empty unless growth recording is enabled */
+DLA_API const dla_growth_sample* dla_growth_series(const dla_handle* handle, size_t* length);
+DLA_API const char* dla_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DLA_C_API_H */
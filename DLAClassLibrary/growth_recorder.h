@@ -0,0 +1,173 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace utl {
+	/**
+	 * \struct growth_sample
+	 *
+	 * \brief Snapshot of the state of an aggregate when it reached `size` particles.
+	 */
+	struct growth_sample {
+		std::uint64_t size;
+		double max_radius;				// distance of furthest particle from the attractor
+		double radius_of_gyration;		// about the centre of mass of the aggregate
+		std::uint64_t misses;
+		double seconds;					// wall-clock time spent generating
+		std::uint64_t steps;			// random walk steps taken
+	};
+	/**
+	 * \class growth_recorder
+	 *
+	 * \brief Records a time series of growth samples of an aggregate at logarithmically spaced
+	 *        particle counts, in memory fixed when recording is enabled.
+	 *
+	 * Samples are taken at N = 1 and then whenever N first reaches the next of `samples_per_decade`
+	 * log-spaced counts per decade, so every count representable by `std::size_t` fits within
+	 * the preallocated buffer. The radius of gyration is maintained incrementally from running
+	 * sums of particle positions at O(1) cost per particle, along the non-periodic axes only as an
+	 * aggregate wrapped about a periodic axis has no extent along it.
+	 */
+	class growth_recorder {
+	public:
+		/**
+		 * \brief Gets whether recording is enabled.
+		 */
+		bool active() const noexcept { return enabled; }
+		/**
+		 * \brief Enables recording, allocating the sample buffer and discarding any recorded samples.
+		 *
+		 * \param _samples_per_decade Number of samples per decade of particle count.
+		 * \throw Throws std::invalid_argument if _samples_per_decade is zero.
+		 */
+		void enable(std::size_t _samples_per_decade) {
+			if (!_samples_per_decade) throw std::invalid_argument("samples per decade must be positive.");
+			samples_per_decade = _samples_per_decade;
+			series.clear();
+			series.shrink_to_fit();
+			series.reserve(max_samples());
+			enabled = true;
+			reset();
+		}
+		/**
+		 * \brief Disables recording, releasing the sample buffer.
+		 */
+		void disable() {
+			enabled = false;
+			series.clear();
+			series.shrink_to_fit();
+		}
+		/**
+		 * \brief Discards all recorded samples and accumulated sums, e.g. upon clearing the aggregate.
+		 */
+		void reset() noexcept {
+			series.clear();
+			next_index = 0U;
+			next_size = 1U;
+			sum_r.fill(0.0);
+			sum_r2.fill(0.0);
+			elapsed = clock_type::duration::zero();
+		}
+		std::size_t get_samples_per_decade() const noexcept { return samples_per_decade; }
+		/**
+		 * \brief Sets the number of leading axes of particle positions which are periodic, excluded from
+		 *        the radius of gyration of subsequent samples.
+		 *
+		 * \param count Number of periodic axes, from the first.
+		 */
+		void set_periodic_axes(std::size_t count) noexcept { periodic_axes = count; }
+		/**
+		 * \brief Gets the recorded samples in order of increasing aggregate size.
+		 *
+		 * \return const reference to contiguous sample array.
+		 */
+		const std::vector<growth_sample>& samples() const noexcept { return series; }
+		/**
+		 * \brief Starts timing a generation.
+		 */
+		void start_clock() noexcept { started = clock_type::now(); }
+		/**
+		 * \brief Stops timing a generation, adding its duration to the total wall-clock time.
+		 */
+		void stop_clock() noexcept { elapsed += clock_type::now() - started; }
+		/**
+		 * \brief Adds a newly attached particle to the running position sums.
+		 *
+		 * \param p Position of particle.
+		 */
+		template<class Point>
+		void accumulate(const Point& p) noexcept {
+			accumulate_coordinates(p, std::make_index_sequence<std::tuple_size<Point>::value>());
+		}
+		/**
+		 * \brief Gets whether a sample is due for an aggregate of `n` particles.
+		 */
+		bool due(std::size_t n) const noexcept { return enabled && n >= next_size; }
+		/**
+		 * \brief Records a sample of an aggregate of `n` particles, all of which have been accumulated.
+		 *
+		 * \param n Number of particles in aggregate.
+		 * \param max_radius Distance of furthest particle from attractor.
+		 * \param misses Number of aggregate misses.
+		 * \param steps Number of random walk steps taken.
+		 */
+		void record(std::size_t n, double max_radius, std::size_t misses, std::uint64_t steps) {
+			const double count = static_cast<double>(n);
+			double rg2 = 0.0;
+			for (std::size_t i = periodic_axes; i < max_dimension; ++i) rg2 += sum_r2[i] / count - (sum_r[i] / count)*(sum_r[i] / count);
+			const double seconds = std::chrono::duration<double>(elapsed + (clock_type::now() - started)).count();
+			if (series.size() < max_samples())
+				series.push_back(growth_sample{ n, max_radius, std::sqrt(rg2 > 0.0 ? rg2 : 0.0), misses, seconds, steps });
+			// advance to the first log-spaced count beyond n, skipping counts which round to the same integer
+			while (next_size <= n) {
+				++next_index;
+				next_size = static_cast<std::size_t>(std::ceil(std::pow(10.0, static_cast<double>(next_index) / samples_per_decade) - 1e-9));
+			}
+		}
+		/**
+		 * \brief Writes the recorded samples as tab separated columns with a header row.
+		 *
+		 * \param os Stream to write to.
+		 * \return Reference to os.
+		 */
+		std::ostream& write(std::ostream& os) const {
+			os << "size\tmax_radius\tradius_of_gyration\tmisses\tseconds\tsteps\n";
+			for (const auto& s : series)
+				os << s.size << '\t' << s.max_radius << '\t' << s.radius_of_gyration << '\t'
+					<< s.misses << '\t' << s.seconds << '\t' << s.steps << '\n';
+			return os;
+		}
+	private:
+		typedef std::chrono::steady_clock clock_type;
+		// decades of particle count spanned by std::size_t, bounding the number of samples
+		static constexpr std::size_t max_decades = 20U;
+		// largest dimension of particle position
+		static constexpr std::size_t max_dimension = 5U;
+		bool enabled = false;
+		std::size_t samples_per_decade = 10U;
+		std::vector<growth_sample> series;
+		std::size_t next_index = 0U;
+		std::size_t next_size = 1U;
+		std::size_t periodic_axes = 0U;
+		std::array<double, max_dimension> sum_r = {};
+		std::array<double, max_dimension> sum_r2 = {};
+		clock_type::time_point started;
+		clock_type::duration elapsed = clock_type::duration::zero();
+
+		std::size_t max_samples() const noexcept { return samples_per_decade*max_decades + 1U; }
+		template<class Point, std::size_t... I>
+		void accumulate_coordinates(const Point& p, std::index_sequence<I...>) noexcept {
+			static_assert(sizeof...(I) <= max_dimension, "dimension of particle exceeds that of growth_recorder.");
+			int expand[] = { 0, (sum_r[I] += std::get<I>(p), sum_r2[I] += static_cast<double>(std::get<I>(p))*std::get<I>(p), 0)... };
+			(void)expand;
+		}
+	};
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include "utilities.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace utl {
+	// largest dimension of lattice for which an aggregate may be generated
+	constexpr std::size_t max_lattice_dimension = 5U;
+	/**
+	 * \struct lattice_point
+	 *
+	 * \brief Type of the co-ordinates of a site of an `N`-dimensional lattice: `std::pair` and `std::tuple`
+	 *        in two and three dimensions, as exposed by the 2D and 3D aggregates since their inception,
+	 *        and `std::array` in higher dimensions. All are accessed uniformly through `std::get`.
+	 */
+	template<std::size_t N>
+	struct lattice_point {
+		typedef std::array<std::int32_t, N> type;
+	};
+	template<>
+	struct lattice_point<2U> {
+		typedef std::pair<int, int> type;
+	};
+	template<>
+	struct lattice_point<3U> {
+		typedef std::tuple<int, int, int> type;
+	};
+	/**
+	 * \struct lattice_step
+	 *
+	 * \brief Translation of a random walker by a single step, components beyond the dimension of
+	 *        the lattice being zero.
+	 */
+	struct lattice_step {
+		int offset[max_lattice_dimension];
+	};
+	/**
+	 * \enum lattice_sites
+	 *
+	 * \brief Subset of the integer points which are sites of a lattice. Steps never leave the subset,
+	 *        such that walkers must be spawned on a site to ever meet the aggregate.
+	 */
+	enum class lattice_sites {
+		ALL, // every integer point
+		EVEN_SUM, // points whose co-ordinates sum to an even number
+		EQUAL_PARITY, // points whose co-ordinates are all even or all odd
+	};
+	/**
+	 * \struct lattice_descriptor
+	 *
+	 * \brief Table describing a lattice in integer co-ordinates, from which the random walk and
+	 *        hence the collision geometry of an aggregate are driven.
+	 *
+	 * A walker takes one of `step_count` equally likely steps per move, chosen by indexing `steps`
+	 * with a uniform random number such that the move is branch-free. The steps are the nearest
+	 * neighbour vectors of the lattice, each repeated in proportion to its move weight. A walker
+	 * collides with the aggregate on stepping onto an occupied site, i.e. when a nearest neighbour
+	 * of its previous position is occupied.
+	 */
+	struct lattice_descriptor {
+		lattice_type type;
+		unsigned dimension;
+		const char* name;
+		const lattice_step* steps;
+		std::size_t step_count;
+		std::size_t coordination; // number of distinct nearest neighbours
+		lattice_sites sites;
+		// Cartesian position of a site is the sum of co-ordinate i times basis[i], with unit nearest
+		// neighbour distance, for rendering and for measuring the aggregate in real space; lower
+		// triangular, such that Cartesian axis k depends upon co-ordinates k onwards only
+		double basis[max_lattice_dimension][max_lattice_dimension];
+	};
+	/**
+	 * \brief Gets the descriptor of a lattice.
+	 *
+	 * \param ltt Type of lattice.
+	 * \param dimension Dimension of lattice, from 2 to `max_lattice_dimension`.
+	 * \return Descriptor with static storage duration.
+	 * \throw Throws std::invalid_argument if the lattice is not defined in `dimension` dimensions.
+	 */
+	inline const lattice_descriptor& describe_lattice(lattice_type ltt, unsigned dimension) {
+		// square: 4 neighbours of equal weight
+		static constexpr lattice_step square_steps[] = {
+			{ { 1, 0, 0 } }, { { -1, 0, 0 } }, { { 0, 1, 0 } }, { { 0, -1, 0 } }
+		};
+		// original triangular: 6 neighbours, the diagonals twice as likely as (+-1,0)
+		static constexpr lattice_step triangle_steps[] = {
+			{ { 1, 0, 0 } }, { { -1, 0, 0 } }, { { 1, 1, 0 } }, { { 1, 1, 0 } }, { { 1, -1, 0 } },
+			{ { 1, -1, 0 } }, { { -1, 1, 0 } }, { { -1, 1, 0 } }, { { -1, -1, 0 } }, { { -1, -1, 0 } }
+		};
+		// hexagonal in axial co-ordinates: 6 neighbours of equal weight
+		static constexpr lattice_step hexagonal_steps[] = {
+			{ { 1, 0, 0 } }, { { -1, 0, 0 } }, { { 0, 1, 0 } }, { { 0, -1, 0 } }, { { 1, -1, 0 } }, { { -1, 1, 0 } }
+		};
+		// simple cubic: 6 neighbours of equal weight
+		static constexpr lattice_step cubic_steps[] = {
+			{ { 1, 0, 0 } }, { { -1, 0, 0 } }, { { 0, 1, 0 } }, { { 0, -1, 0 } }, { { 0, 0, 1 } }, { { 0, 0, -1 } }
+		};
+		// original layered triangular: triangular planes as in 2D stacked along z
+		static constexpr lattice_step layered_steps[] = {
+			{ { 1, 0, 0 } }, { { -1, 0, 0 } }, { { 1, 1, 0 } }, { { 1, 1, 0 } }, { { 1, -1, 0 } }, { { 1, -1, 0 } },
+			{ { -1, 1, 0 } }, { { -1, 1, 0 } }, { { -1, -1, 0 } }, { { -1, -1, 0 } }, { { 0, 0, 1 } }, { { 0, 0, -1 } }
+		};
+		// face-centred cubic: 12 neighbours (+-1,+-1,0) and permutations of equal weight
+		static constexpr lattice_step fcc_steps[] = {
+			{ { 1, 1, 0 } }, { { 1, -1, 0 } }, { { -1, 1, 0 } }, { { -1, -1, 0 } },
+			{ { 1, 0, 1 } }, { { 1, 0, -1 } }, { { -1, 0, 1 } }, { { -1, 0, -1 } },
+			{ { 0, 1, 1 } }, { { 0, 1, -1 } }, { { 0, -1, 1 } }, { { 0, -1, -1 } }
+		};
+		// body-centred cubic: 8 neighbours (+-1,+-1,+-1) of equal weight
+		static constexpr lattice_step bcc_steps[] = {
+			{ { 1, 1, 1 } }, { { 1, 1, -1 } }, { { 1, -1, 1 } }, { { 1, -1, -1 } },
+			{ { -1, 1, 1 } }, { { -1, 1, -1 } }, { { -1, -1, 1 } }, { { -1, -1, -1 } }
+		};
+		// hypercubic: 2N neighbours of equal weight
+		static constexpr lattice_step tesseract_steps[] = {
+			{ { 1, 0, 0, 0 } }, { { -1, 0, 0, 0 } }, { { 0, 1, 0, 0 } }, { { 0, -1, 0, 0 } },
+			{ { 0, 0, 1, 0 } }, { { 0, 0, -1, 0 } }, { { 0, 0, 0, 1 } }, { { 0, 0, 0, -1 } }
+		};
+		static constexpr lattice_step penteract_steps[] = {
+			{ { 1, 0, 0, 0, 0 } }, { { -1, 0, 0, 0, 0 } }, { { 0, 1, 0, 0, 0 } }, { { 0, -1, 0, 0, 0 } },
+			{ { 0, 0, 1, 0, 0 } }, { { 0, 0, -1, 0, 0 } }, { { 0, 0, 0, 1, 0 } }, { { 0, 0, 0, -1, 0 } },
+			{ { 0, 0, 0, 0, 1 } }, { { 0, 0, 0, 0, -1 } }
+		};
+		static const lattice_descriptor lattices_2d[] = {
+			{ lattice_type::SQUARE, 2U, "square", square_steps, 4U, 4U, lattice_sites::ALL,
+				{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } } },
+			{ lattice_type::TRIANGLE, 2U, "triangle", triangle_steps, 10U, 6U, lattice_sites::ALL,
+				{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } } },
+			{ lattice_type::HEXAGONAL, 2U, "hexagonal", hexagonal_steps, 6U, 6U, lattice_sites::ALL,
+				{ { 1.0, 0.0, 0.0 }, { 0.5, 0.86602540378443865, 0.0 }, { 0.0, 0.0, 1.0 } } },
+		};
+		static const lattice_descriptor lattices_3d[] = {
+			{ lattice_type::SQUARE, 3U, "square", cubic_steps, 6U, 6U, lattice_sites::ALL,
+				{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } } },
+			{ lattice_type::TRIANGLE, 3U, "triangle", layered_steps, 12U, 8U, lattice_sites::ALL,
+				{ { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } } },
+			{ lattice_type::FCC, 3U, "fcc", fcc_steps, 12U, 12U, lattice_sites::EVEN_SUM,
+				{ { 0.70710678118654752, 0.0, 0.0 }, { 0.0, 0.70710678118654752, 0.0 }, { 0.0, 0.0, 0.70710678118654752 } } },
+			{ lattice_type::BCC, 3U, "bcc", bcc_steps, 8U, 8U, lattice_sites::EQUAL_PARITY,
+				{ { 0.57735026918962576, 0.0, 0.0 }, { 0.0, 0.57735026918962576, 0.0 }, { 0.0, 0.0, 0.57735026918962576 } } },
+		};
+		static const lattice_descriptor hypercubic_4d = { lattice_type::SQUARE, 4U, "hypercubic", tesseract_steps, 8U, 8U,
+			lattice_sites::ALL, { { 1.0 }, { 0.0, 1.0 }, { 0.0, 0.0, 1.0 }, { 0.0, 0.0, 0.0, 1.0 } } };
+		static const lattice_descriptor hypercubic_5d = { lattice_type::SQUARE, 5U, "hypercubic", penteract_steps, 10U, 10U,
+			lattice_sites::ALL, { { 1.0 }, { 0.0, 1.0 }, { 0.0, 0.0, 1.0 }, { 0.0, 0.0, 0.0, 1.0 }, { 0.0, 0.0, 0.0, 0.0, 1.0 } } };
+		if (dimension == 2U) {
+			for (const auto& desc : lattices_2d) if (desc.type == ltt) return desc;
+			throw std::invalid_argument("lattice type is not defined for 2D DLA.");
+		}
+		if (dimension == 3U) {
+			for (const auto& desc : lattices_3d) if (desc.type == ltt) return desc;
+			throw std::invalid_argument("lattice type is not defined for 3D DLA.");
+		}
+		if (dimension == 4U || dimension == 5U) {
+			if (ltt == lattice_type::SQUARE) return (dimension == 4U) ? hypercubic_4d : hypercubic_5d;
+			throw std::invalid_argument("only the hypercubic (square) lattice is defined for DLA above 3D.");
+		}
+		throw std::invalid_argument("dimension of lattice must be from 2 to 5.");
+	}
+	/**
+	 * \brief Maps a uniform random number to the index of a step of a lattice.
+	 *
+	 * \param choice Random number in [0,1].
+	 * \param step_count Number of steps of lattice.
+	 * \return Index in [0, step_count).
+	 */
+	inline std::size_t step_index(double choice, std::size_t step_count) noexcept {
+		const std::size_t index = static_cast<std::size_t>(choice*step_count);
+		return (index < step_count) ? index : step_count - 1U;
+	}
+	namespace detail {
+		template<class Point, std::size_t... I>
+		int coordinate_sum(const Point& p, std::index_sequence<I...>) noexcept {
+			int sum = 0;
+			int expand[] = { 0, (sum += std::get<I>(p))... };
+			(void)expand;
+			return sum;
+		}
+		template<class Point, std::size_t... I>
+		void equalise_parity(Point& p, std::index_sequence<I...>) noexcept {
+			// align the parity of every co-ordinate after the first with that of the first
+			int expand[] = { 0, (std::get<I + 1U>(p) += (std::get<0>(p) ^ std::get<I + 1U>(p)) & 1)... };
+			(void)expand;
+		}
+		template<class Point, std::size_t... I>
+		Point make_point(const std::array<int, sizeof...(I)>& coordinates, std::index_sequence<I...>) {
+			return Point{ coordinates[I]... };
+		}
+		template<class Point, std::size_t... I>
+		std::array<int, sizeof...(I)> coordinates_of(const Point& p, std::index_sequence<I...>) noexcept {
+			return { { std::get<I>(p)... } };
+		}
+	}
+	/**
+	 * \brief Makes the co-ordinates of a lattice site from an array of its co-ordinates.
+	 *
+	 * \tparam N Dimension of lattice.
+	 * \param coordinates Co-ordinates of site.
+	 * \return Co-ordinates of site as `lattice_point<N>::type`.
+	 */
+	template<std::size_t N>
+	typename lattice_point<N>::type make_lattice_point(const std::array<int, N>& coordinates) {
+		return detail::make_point<typename lattice_point<N>::type>(coordinates, std::make_index_sequence<N>());
+	}
+	/**
+	 * \brief Moves a point onto a neighbouring site of a lattice if it is not a site itself.
+	 *
+	 * \param p Point to snap, of any `lattice_point` type.
+	 * \param sites Sites of lattice.
+	 */
+	template<class Point>
+	void snap_to_lattice(Point& p, lattice_sites sites) noexcept {
+		constexpr std::size_t N = std::tuple_size<Point>::value;
+		if (sites == lattice_sites::EVEN_SUM) std::get<0>(p) += detail::coordinate_sum(p, std::make_index_sequence<N>()) & 1;
+		else if (sites == lattice_sites::EQUAL_PARITY) detail::equalise_parity(p, std::make_index_sequence<N - 1U>());
+	}
+	/**
+	 * \brief Gets the co-ordinates of a lattice site as an array.
+	 *
+	 * \param p Co-ordinates of site, of any `lattice_point` type.
+	 * \return Co-ordinates of site as `std::array`.
+	 */
+	template<class Point>
+	std::array<int, std::tuple_size<Point>::value> coordinates_of(const Point& p) noexcept {
+		return detail::coordinates_of(p, std::make_index_sequence<std::tuple_size<Point>::value>());
+	}
+	/**
+	 * \brief Gets the Cartesian position of a lattice site.
+	 *
+	 * \param p Co-ordinates of site, of any `lattice_point` type.
+	 * \param geometry Descriptor of lattice.
+	 * \return Position of site in units of the nearest neighbour distance.
+	 */
+	template<class Point>
+	std::array<double, std::tuple_size<Point>::value> cartesian_position(const Point& p, const lattice_descriptor& geometry) noexcept {
+		constexpr std::size_t N = std::tuple_size<Point>::value;
+		const std::array<int, N> c = coordinates_of(p);
+		std::array<double, N> x = {};
+		for (std::size_t i = 0U; i < N; ++i)
+			for (std::size_t k = 0U; k < N; ++k) x[k] += c[i]*geometry.basis[i][k];
+		return x;
+	}
+	/**
+	 * \brief Gets the distance of a lattice site from an attractor as ordered by `distance_comparator`,
+	 *        squared from a point, and from a line or circle above 2D, linear from a 2D line or a plane.
+	 *
+	 * \param p Co-ordinates of site, of any `lattice_point` type.
+	 * \param att Type of attractor.
+	 * \param att_size Size of attractor.
+	 * \return Distance of site from attractor.
+	 */
+	template<class Point>
+	auto attractor_distance(const Point& p, attractor_type att, std::size_t att_size) {
+		return tuple_distance_t<Point, std::tuple_size<Point>::value>::tuple_distance(p, att, att_size);
+	}
+	/**
+	 * \brief Gets the distance of a lattice site from an attractor as given by `attractor_distance`, measured
+	 *        between Cartesian positions such that it is comparable across lattices.
+	 *
+	 * \param p Co-ordinates of site, of any `lattice_point` type.
+	 * \param att Type of attractor.
+	 * \param att_size Size of attractor.
+	 * \param geometry Descriptor of lattice.
+	 * \return Non-negative distance of site from attractor in units of the nearest neighbour distance.
+	 */
+	template<class Point>
+	double real_space_distance(const Point& p, attractor_type att, std::size_t att_size, const lattice_descriptor& geometry) noexcept {
+		return std::abs(attractor_distance(cartesian_position(p, geometry), att, att_size));
+	}
+	/**
+	 * \brief Gets the distinct sites of an attractor of the lattice engines, each lying in the plane of
+	 *        the first two axes: the origin, a line of `att_size` sites along the first axis, a square of
+	 *        `att_size`^2 sites or the sites nearest a circle of radius `att_size` about the origin,
+	 *        the circle being drawn in Cartesian space.
+	 *
+	 * \tparam N Dimension of lattice.
+	 * \param att Type of attractor.
+	 * \param att_size Size of attractor.
+	 * \param geometry Descriptor of lattice.
+	 * \return Sites of attractor.
+	 */
+	template<std::size_t N>
+	std::vector<std::array<int, N>> attractor_sites(attractor_type att, std::size_t att_size, const lattice_descriptor& geometry) {
+		std::vector<std::array<int, N>> sites;
+		std::array<int, N> site = {};
+		const int half = static_cast<int>(att_size) / 2;
+		switch (att) {
+		case attractor_type::POINT:
+			sites.push_back(site);
+			break;
+		case attractor_type::LINE:
+			for (int i = -half; i < half; ++i) {
+				site[0] = i;
+				sites.push_back(site);
+			}
+			break;
+		case attractor_type::PLANE:
+			for (int i = -half; i < half; ++i) {
+				for (int j = -half; j < half; ++j) {
+					site[0] = i;
+					site[1] = j;
+					sites.push_back(site);
+				}
+			}
+			break;
+		case attractor_type::CIRCLE: {
+			// map each point of the circle back to co-ordinates through the inverse of the basis in the plane
+			const double(&b)[max_lattice_dimension][max_lattice_dimension] = geometry.basis;
+			const double det = b[0][0]*b[1][1] - b[0][1]*b[1][0];
+			for (double theta = 0.0; theta <= 2.0*M_PI; theta += M_PI / 180.0) {
+				const double x = att_size*std::cos(theta);
+				const double y = att_size*std::sin(theta);
+				site[0] = static_cast<int>((x*b[1][1] - y*b[1][0]) / det);
+				site[1] = static_cast<int>((y*b[0][0] - x*b[0][1]) / det);
+				snap_to_lattice(site, geometry.sites);
+				sites.push_back(site);
+			}
+			std::sort(sites.begin(), sites.end());
+			sites.erase(std::unique(sites.begin(), sites.end()), sites.end());
+			break;
+		}
+		}
+		return sites;
+	}
+	/**
+	 * \brief Estimates the fractal dimension of an aggregate via ln(N)/ln(r), r being the radius which
+	 *        minimally bounds the aggregate about its attractor.
+	 *
+	 * \param size Number of particles of aggregate.
+	 * \param max_distance Largest distance of a particle from the attractor as given by `real_space_distance`.
+	 * \param att Type of attractor.
+	 * \param att_size Size of attractor.
+	 * \param dimension Dimension of lattice.
+	 * \return Estimated fractal dimension.
+	 */
+	inline double estimate_fractal_dimension(std::size_t size, double max_distance, attractor_type att,
+		std::size_t att_size, std::size_t dimension) {
+		// distance is squared from a point, and from a line or circle above 2D, linear from a 2D line or a plane
+		double bounding_radius = max_distance;
+		if (dimension == 2U && att == attractor_type::CIRCLE) bounding_radius = std::sqrt(bounding_radius - att_size);
+		else if (att == attractor_type::POINT || (dimension > 2U && (att == attractor_type::LINE
+			|| att == attractor_type::CIRCLE))) bounding_radius = std::sqrt(bounding_radius);
+		return std::log(size) / std::log(bounding_radius);
+	}
+}
@@ -0,0 +1,266 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace utl {
+	/**
+	 * \class memory_resource
+	 *
+	 * \brief Abstract source of memory for the containers of an aggregate, with the interface of
+	 *        `std::pmr::memory_resource` (which is not available to the C++14 toolset of this library).
+	 */
+	class memory_resource {
+	public:
+		static constexpr std::size_t max_align = alignof(std::max_align_t);
+		virtual ~memory_resource() = default;
+		/**
+		 * \brief Allocates `bytes` bytes aligned to `alignment`.
+		 *
+		 * \throw Throws std::bad_alloc if the memory cannot be allocated.
+		 */
+		void* allocate(std::size_t bytes, std::size_t alignment = max_align) { return do_allocate(bytes, alignment); }
+		/**
+		 * \brief Deallocates memory obtained from `allocate` with the same `bytes` and `alignment`.
+		 */
+		void deallocate(void* p, std::size_t bytes, std::size_t alignment = max_align) { do_deallocate(p, bytes, alignment); }
+		/**
+		 * \brief Determines whether memory allocated by `other` may be deallocated by this, and vice versa.
+		 */
+		bool is_equal(const memory_resource& other) const noexcept { return do_is_equal(other); }
+	protected:
+		virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+		virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+		virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+	};
+
+	inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+		return &lhs == &rhs || lhs.is_equal(rhs);
+	}
+	inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+		return !(lhs == rhs);
+	}
+
+	namespace detail {
+		class new_delete_resource_impl : public memory_resource {
+		protected:
+			void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+				// over-aligned allocation requires C++17, no container of an aggregate needs it
+				if (alignment > max_align) throw std::bad_alloc();
+				return ::operator new(bytes);
+			}
+			void do_deallocate(void* p, std::size_t, std::size_t) override { ::operator delete(p); }
+			bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+		};
+	}
+
+	/**
+	 * \brief Gets the resource using the global `operator new` and `operator delete`, the default
+	 *        resource of every aggregate.
+	 */
+	inline memory_resource* new_delete_resource() noexcept {
+		static detail::new_delete_resource_impl instance;
+		return &instance;
+	}
+
+	/**
+	 * \class monotonic_buffer_resource
+	 *
+	 * \brief Arena resource handing out memory from geometrically growing chunks obtained from an
+	 *        upstream resource. Deallocation is a no-op and all memory is returned at once by `release`
+	 *        or destruction, such that the particles of a finished aggregate are freed in time
+	 *        proportional to the number of chunks rather than the number of particles. Not thread-safe.
+	 */
+	class monotonic_buffer_resource : public memory_resource {
+	public:
+		/**
+		 * \brief Creates an empty arena.
+		 *
+		 * \param _initial_size [= 4096] Size in bytes of the first chunk.
+		 * \param _upstream [= new_delete_resource()] Resource from which chunks are allocated.
+		 */
+		explicit monotonic_buffer_resource(std::size_t _initial_size = 4096U, memory_resource* _upstream = new_delete_resource()) noexcept
+			: upstream(_upstream), next_size(std::max<std::size_t>(_initial_size, 64U)) {}
+		monotonic_buffer_resource(const monotonic_buffer_resource&) = delete;
+		monotonic_buffer_resource& operator=(const monotonic_buffer_resource&) = delete;
+		~monotonic_buffer_resource() override { release(); }
+		/**
+		 * \brief Returns every chunk to the upstream resource, invalidating all memory allocated from this.
+		 */
+		void release() noexcept {
+			while (chunks) {
+				chunk_header* next = chunks->next;
+				upstream->deallocate(chunks, chunks->size);
+				chunks = next;
+			}
+			current = nullptr;
+			remaining = 0U;
+		}
+		memory_resource* upstream_resource() const noexcept { return upstream; }
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+			if (alignment > max_align) throw std::bad_alloc();
+			std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(current) % alignment) % alignment;
+			if (!current || padding + bytes > remaining) {
+				new_chunk(bytes);
+				padding = 0U;
+			}
+			void* p = current + padding;
+			current += padding + bytes;
+			remaining -= padding + bytes;
+			return p;
+		}
+		void do_deallocate(void*, std::size_t, std::size_t) override {}
+		bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+	private:
+		// prefixes each chunk, padded such that the usable space is maximally aligned
+		struct alignas(max_align) chunk_header {
+			chunk_header* next;
+			std::size_t size;
+		};
+		memory_resource* upstream;
+		chunk_header* chunks = nullptr;
+		char* current = nullptr;
+		std::size_t remaining = 0U;
+		std::size_t next_size;
+		void new_chunk(std::size_t bytes) {
+			const std::size_t size = std::max(next_size, sizeof(chunk_header) + bytes);
+			auto header = static_cast<chunk_header*>(upstream->allocate(size));
+			header->next = chunks;
+			header->size = size;
+			chunks = header;
+			current = reinterpret_cast<char*>(header + 1);
+			remaining = size - sizeof(chunk_header);
+			next_size = size * 2U;
+		}
+	};
+
+	/**
+	 * \class unsynchronized_pool_resource
+	 *
+	 * \brief Pooling resource recycling deallocated blocks through free lists of size classes, carved
+	 *        from an internal arena, for use as a per-thread pool by a thread generating many aggregates
+	 *        in turn. Blocks larger than `max_block_size` (e.g. the bucket arrays of the hash containers)
+	 *        are allocated individually from the upstream resource. All memory, including outstanding
+	 *        blocks, is returned by `release` or destruction. Not thread-safe.
+	 */
+	class unsynchronized_pool_resource : public memory_resource {
+	public:
+		static constexpr std::size_t max_block_size = 256U;
+		/**
+		 * \brief Creates an empty pool.
+		 *
+		 * \param _upstream [= new_delete_resource()] Resource from which memory is allocated.
+		 */
+		explicit unsynchronized_pool_resource(memory_resource* _upstream = new_delete_resource()) noexcept
+			: arena(16384U, _upstream) {}
+		unsynchronized_pool_resource(const unsynchronized_pool_resource&) = delete;
+		unsynchronized_pool_resource& operator=(const unsynchronized_pool_resource&) = delete;
+		~unsynchronized_pool_resource() override { release(); }
+		/**
+		 * \brief Returns all memory to the upstream resource, invalidating all memory allocated from this.
+		 */
+		void release() noexcept {
+			while (large) {
+				large_header* next = large->next;
+				arena.upstream_resource()->deallocate(large, large->size);
+				large = next;
+			}
+			std::fill(std::begin(free_lists), std::end(free_lists), nullptr);
+			arena.release();
+		}
+		memory_resource* upstream_resource() const noexcept { return arena.upstream_resource(); }
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+			if (alignment > max_align) throw std::bad_alloc();
+			if (bytes > max_block_size) {
+				auto header = static_cast<large_header*>(arena.upstream_resource()->allocate(sizeof(large_header) + bytes));
+				header->prev = nullptr;
+				header->next = large;
+				header->size = sizeof(large_header) + bytes;
+				if (large) large->prev = header;
+				large = header;
+				return header + 1;
+			}
+			free_block*& head = free_lists[size_class(bytes)];
+			if (head) {
+				free_block* block = head;
+				head = block->next;
+				return block;
+			}
+			return arena.allocate(class_size(size_class(bytes)));
+		}
+		void do_deallocate(void* p, std::size_t bytes, std::size_t) override {
+			if (bytes > max_block_size) {
+				auto header = static_cast<large_header*>(p) - 1;
+				if (header->prev) header->prev->next = header->next;
+				else large = header->next;
+				if (header->next) header->next->prev = header->prev;
+				arena.upstream_resource()->deallocate(header, header->size);
+				return;
+			}
+			auto block = static_cast<free_block*>(p);
+			free_block*& head = free_lists[size_class(bytes)];
+			block->next = head;
+			head = block;
+		}
+		bool do_is_equal(const memory_resource& other) const noexcept override { return this == &other; }
+	private:
+		struct free_block {
+			free_block* next;
+		};
+		// prefixes each individually allocated block, padded to keep the block maximally aligned
+		struct alignas(max_align) large_header {
+			large_header* prev;
+			large_header* next;
+			std::size_t size;
+		};
+		static constexpr std::size_t granularity = max_align < sizeof(free_block) ? sizeof(free_block) : max_align;
+		static constexpr std::size_t class_count = (max_block_size + granularity - 1U) / granularity;
+		static std::size_t size_class(std::size_t bytes) noexcept { return bytes ? (bytes - 1U) / granularity : 0U; }
+		static std::size_t class_size(std::size_t cls) noexcept { return (cls + 1U) * granularity; }
+		monotonic_buffer_resource arena;
+		free_block* free_lists[class_count] = {};
+		large_header* large = nullptr;
+	};
+
+	/**
+	 * \class polymorphic_allocator
+	 *
+	 * \brief Allocator drawing from a memory_resource, with the semantics of `std::pmr::polymorphic_allocator`:
+	 *        the resource is not propagated on container assignment or swap, and copy constructed containers
+	 *        allocate from `new_delete_resource()` rather than the resource of the original.
+	 */
+	template<typename Ty>
+	class polymorphic_allocator {
+	public:
+		typedef Ty value_type;
+		polymorphic_allocator() noexcept : res(new_delete_resource()) {}
+		polymorphic_allocator(memory_resource* _res) noexcept : res(_res ? _res : new_delete_resource()) {}
+		template<typename Uy>
+		polymorphic_allocator(const polymorphic_allocator<Uy>& other) noexcept : res(other.resource()) {}
+		Ty* allocate(std::size_t n) {
+			return static_cast<Ty*>(res->allocate(n * sizeof(Ty), alignof(Ty)));
+		}
+		void deallocate(Ty* p, std::size_t n) noexcept {
+			res->deallocate(p, n * sizeof(Ty), alignof(Ty));
+		}
+		polymorphic_allocator select_on_container_copy_construction() const noexcept {
+			return polymorphic_allocator();
+		}
+		memory_resource* resource() const noexcept { return res; }
+	private:
+		memory_resource* res;
+	};
+
+	template<typename Ty, typename Uy>
+	bool operator==(const polymorphic_allocator<Ty>& lhs, const polymorphic_allocator<Uy>& rhs) noexcept {
+		return *lhs.resource() == *rhs.resource();
+	}
+	template<typename Ty, typename Uy>
+	bool operator!=(const polymorphic_allocator<Ty>& lhs, const polymorphic_allocator<Uy>& rhs) noexcept {
+		return !(lhs == rhs);
+	}
+}
@@ -0,0 +1,80 @@
+#include "Stdafx.h"
+#include "observer_dispatcher.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+struct utl::observer_dispatcher::impl {
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::condition_variable idle_cv;
+	std::deque<std::function<void()>> tasks;
+	bool running_task = false;
+	bool stopping = false;
+	std::exception_ptr error;	// first exception thrown by a task, until rethrown
+	std::thread worker;
+	void run() {
+		std::unique_lock<std::mutex> lock(mtx);
+		for (;;) {
+			cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+			if (tasks.empty()) return;	// stopping and fully drained
+			std::function<void()> task = std::move(tasks.front());
+			tasks.pop_front();
+			running_task = true;
+			lock.unlock();
+			// an exception escaping the dispatch thread would terminate the process
+			std::exception_ptr e;
+			try {
+				task();
+			}
+			catch (...) {
+				e = std::current_exception();
+			}
+			lock.lock();
+			if (e && !error) error = e;
+			running_task = false;
+			if (tasks.empty()) idle_cv.notify_all();
+		}
+	}
+};
+
+utl::observer_dispatcher::observer_dispatcher() : pimpl(std::make_unique<impl>()) {
+	pimpl->worker = std::thread(&impl::run, pimpl.get());
+}
+
+utl::observer_dispatcher::~observer_dispatcher() {
+	{
+		std::lock_guard<std::mutex> lock(pimpl->mtx);
+		pimpl->stopping = true;
+	}
+	pimpl->cv.notify_one();
+	pimpl->worker.join();
+}
+
+void utl::observer_dispatcher::post(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(pimpl->mtx);
+		pimpl->tasks.push_back(std::move(task));
+	}
+	pimpl->cv.notify_one();
+}
+
+void utl::observer_dispatcher::drain() {
+	std::unique_lock<std::mutex> lock(pimpl->mtx);
+	pimpl->idle_cv.wait(lock, [this]() { return pimpl->tasks.empty() && !pimpl->running_task; });
+	std::exception_ptr e = std::move(pimpl->error);
+	pimpl->error = nullptr;
+	if (e) std::rethrow_exception(e);
+}
+
+void utl::observer_dispatcher::rethrow_error() {
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock(pimpl->mtx);
+		e = std::move(pimpl->error);
+		pimpl->error = nullptr;
+	}
+	if (e) std::rethrow_exception(e);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <functional>
+#include <memory>
+
+namespace utl {
+	/**
+	 * \class observer_dispatcher
+	 *
+	 * \brief Runs posted tasks in order on a single dedicated dispatch thread, used for delivering
+	 *        attachment notifications away from the generating thread.
+	 *
+	 * The thread machinery is hidden behind a pointer to implementation such that this header can
+	 * be included by code compiled with /clr. Destroying the dispatcher runs all pending tasks
+	 * before joining the dispatch thread.
+	 *
+	 * A task which throws does not stop the dispatch thread, later tasks still being run. The first
+	 * such exception is held until rethrown on the posting side by `drain` or `rethrow_error`, any
+	 * further exceptions thrown meanwhile being discarded.
+	 */
+	class observer_dispatcher {
+	public:
+		/**
+		 * \brief Starts the dispatch thread.
+		 */
+		observer_dispatcher();
+		observer_dispatcher(const observer_dispatcher&) = delete;
+		observer_dispatcher& operator=(const observer_dispatcher&) = delete;
+		/**
+		 * \brief Drains all pending tasks and joins the dispatch thread.
+		 */
+		~observer_dispatcher();
+		/**
+		 * \brief Enqueues a task to be run on the dispatch thread.
+		 *
+		 * \param task Task to run.
+		 */
+		void post(std::function<void()> task);
+		/**
+		 * \brief Blocks until all tasks posted before this call have been run.
+		 *
+		 * \throw Rethrows the first exception thrown by a task since it was last rethrown.
+		 */
+		void drain();
+		/**
+		 * \brief Rethrows the first exception thrown by a task since it was last rethrown, if any,
+		 *        without waiting for pending tasks.
+		 */
+		void rethrow_error();
+	private:
+		struct impl;
+		std::unique_ptr<impl> pimpl;
+	};
+}
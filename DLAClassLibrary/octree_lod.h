@@ -0,0 +1,234 @@
+#pragma once
+#include "attachment_observer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace utl {
+	/**
+	 * \struct view_frustum
+	 *
+	 * \brief View volume and projection scale of a camera, used to select octree nodes to draw.
+	 */
+	struct view_frustum {
+		// planes (a,b,c,d) with inward facing normals, a point is inside when ax+by+cz+d >= 0,
+		// planes with zero normal are ignored
+		std::array<std::array<double, 4>, 6> planes;
+		// position of camera
+		std::array<double, 3> eye;
+		// pixels spanned by a unit length at unit distance (perspective) or at any distance (orthographic)
+		double pixels_per_unit;
+		bool orthographic;
+	};
+	/**
+	 * \struct lod_node
+	 *
+	 * \brief Aggregated contents of an octree cell, to be drawn in place of the particles it contains.
+	 */
+	struct lod_node {
+		std::array<std::int64_t, 3> corner;	// minimum lattice point covered by cell
+		std::int64_t size;					// edge length of cell
+		std::size_t count;					// number of particles within cell
+		std::array<double, 3> centroid;		// mean position of particles within cell
+		double mean_generation;				// mean generation index of particles within cell
+		double occupancy;					// fraction of lattice points of cell occupied
+	};
+	/**
+	 * \class octree_lod
+	 *
+	 * \brief Octree level-of-detail index over the particles of a 3D aggregate, built incrementally as
+	 *        particles attach, for rendering very large aggregates at interactive rates.
+	 *
+	 * Every node aggregates the count, centroid and mean generation index of the particles beneath it.
+	 * The root grows outwards by doubling as the aggregate expands, so the index needs no prior bounds.
+	 * Register with a DLA_3d via `add_observer`, or feed particles directly through `insert`.
+	 */
+	class octree_lod : public attachment_observer<std::tuple<int, int, int>> {
+		struct node {
+			std::uint64_t count = 0U;
+			double generation_sum = 0.0;
+			std::array<double, 3> position_sum = { 0.0, 0.0, 0.0 };
+			std::uint32_t first_child = 0U;	// index of block of 8 children, 0 for none
+		};
+	public:
+		/**
+		 * \brief Creates an empty index.
+		 *
+		 * \param _leaf_size [= 4] Edge length of leaf cells, must be a power of 2.
+		 * \throw Throws std::invalid_argument if _leaf_size is not a power of 2.
+		 */
+		explicit octree_lod(std::int64_t _leaf_size = 4) : leaf_size(_leaf_size) {
+			if (_leaf_size < 1 || (_leaf_size & (_leaf_size - 1)))
+				throw std::invalid_argument("leaf size must be a power of 2.");
+			clear();
+		}
+		/**
+		 * \brief Gets the number of particles indexed.
+		 */
+		std::size_t size() const noexcept { return static_cast<std::size_t>(nodes[0].count); }
+		/**
+		 * \brief Gets the number of nodes allocated, including empty siblings.
+		 */
+		std::size_t node_count() const noexcept { return nodes.size(); }
+		std::int64_t get_leaf_size() const noexcept { return leaf_size; }
+		/**
+		 * \brief Removes all particles from the index.
+		 */
+		void clear() {
+			nodes.assign(1U, node());
+			root_corner = { 0, 0, 0 };
+			root_size = leaf_size;
+		}
+		/**
+		 * \brief Adds a particle to the index.
+		 *
+		 * \param p Lattice position of particle.
+		 * \param generation Generation index of particle.
+		 */
+		void insert(const std::tuple<int, int, int>& p, std::size_t generation) {
+			const std::array<std::int64_t, 3> pos = { std::get<0>(p), std::get<1>(p), std::get<2>(p) };
+			if (!nodes[0].count) {
+				for (std::size_t k = 0U; k < 3U; ++k) root_corner[k] = floor_to(pos[k], leaf_size);
+				root_size = leaf_size;
+			}
+			else {
+				while (!contains(root_corner, root_size, pos)) grow_root(pos);
+			}
+			std::array<std::int64_t, 3> corner = root_corner;
+			std::int64_t size = root_size;
+			std::uint32_t index = 0U;
+			for (;;) {
+				node& n = nodes[index];
+				++n.count;
+				n.generation_sum += static_cast<double>(generation);
+				for (std::size_t k = 0U; k < 3U; ++k) n.position_sum[k] += static_cast<double>(pos[k]);
+				if (size == leaf_size) break;
+				if (!n.first_child) {
+					const std::uint32_t block = static_cast<std::uint32_t>(nodes.size());
+					nodes[index].first_child = block;	// n invalidated by resize below
+					nodes.resize(nodes.size() + 8U);
+				}
+				size /= 2;
+				std::uint32_t octant = 0U;
+				for (std::size_t k = 0U; k < 3U; ++k) {
+					if (pos[k] >= corner[k] + size) {
+						octant |= 1U << k;
+						corner[k] += size;
+					}
+				}
+				index = nodes[index].first_child + octant;
+			}
+		}
+		void on_attach(const particle_batch<std::tuple<int, int, int>>& batch, std::size_t first_index) override {
+			// aggregate cleared since last batch
+			if (first_index < size()) clear();
+			std::size_t generation = first_index;
+			for (const auto& p : batch) insert(p, ++generation);
+		}
+		/**
+		 * \brief Selects the nodes to draw for a view, such that each drawn node spans at most
+		 *        `pixel_error` pixels on screen (or is a leaf) and intersects the view frustum.
+		 *
+		 * \param frustum View volume and projection scale of camera.
+		 * \param pixel_error Maximum projected edge length, in pixels, of a drawn node.
+		 * \param out Destination of selected nodes, cleared before filling.
+		 */
+		void query(const view_frustum& frustum, double pixel_error, std::vector<lod_node>& out) const {
+			out.clear();
+			if (nodes[0].count) select(0U, root_corner, root_size, frustum, pixel_error, false, out);
+		}
+		/**
+		 * \brief Collects all non-empty nodes of edge length `size`, independent of any view.
+		 *
+		 * \param size Edge length of nodes to collect, clamped to [leaf size, root size].
+		 * \param out Destination of nodes, cleared before filling.
+		 */
+		void nodes_of_size(std::int64_t size, std::vector<lod_node>& out) const {
+			view_frustum everything{};
+			everything.pixels_per_unit = 1.0;
+			everything.orthographic = true;
+			query(everything, static_cast<double>(std::max(size, leaf_size)), out);
+		}
+	private:
+		std::int64_t leaf_size;
+		std::vector<node> nodes;	// nodes[0] is root, children allocated in contiguous blocks of 8
+		std::array<std::int64_t, 3> root_corner;
+		std::int64_t root_size;
+
+		static std::int64_t floor_to(std::int64_t x, std::int64_t m) noexcept {
+			return (x >= 0) ? x - x % m : -((-x + m - 1) / m) * m;
+		}
+		static bool contains(const std::array<std::int64_t, 3>& corner, std::int64_t size, const std::array<std::int64_t, 3>& pos) noexcept {
+			for (std::size_t k = 0U; k < 3U; ++k)
+				if (pos[k] < corner[k] || pos[k] >= corner[k] + size) return false;
+			return true;
+		}
+		// doubles the root cell towards pos, the current root becoming one of its children
+		void grow_root(const std::array<std::int64_t, 3>& pos) {
+			std::uint32_t octant = 0U;
+			for (std::size_t k = 0U; k < 3U; ++k) {
+				if (pos[k] < root_corner[k]) {
+					octant |= 1U << k;
+					root_corner[k] -= root_size;
+				}
+			}
+			root_size *= 2;
+			const std::uint32_t block = static_cast<std::uint32_t>(nodes.size());
+			nodes.resize(nodes.size() + 8U);
+			nodes[block + octant] = nodes[0];
+			nodes[0].first_child = block;	// aggregated statistics of root unchanged
+		}
+		void select(std::uint32_t index, const std::array<std::int64_t, 3>& corner, std::int64_t size,
+			const view_frustum& frustum, double pixel_error, bool inside, std::vector<lod_node>& out) const {
+			const node& n = nodes[index];
+			if (!n.count) return;
+			const std::array<double, 3> lo = { static_cast<double>(corner[0]) - 0.5, static_cast<double>(corner[1]) - 0.5, static_cast<double>(corner[2]) - 0.5 };
+			const double extent = static_cast<double>(size);
+			if (!inside) {
+				inside = true;
+				for (const auto& plane : frustum.planes) {
+					if (plane[0] == 0.0 && plane[1] == 0.0 && plane[2] == 0.0) continue;	// unused plane
+					// vertices of cell box furthest along and against the plane normal
+					double positive = plane[3], negative = plane[3];
+					for (std::size_t k = 0U; k < 3U; ++k) {
+						const double near_k = (plane[k] >= 0.0) ? lo[k] + extent : lo[k];
+						const double far_k = (plane[k] >= 0.0) ? lo[k] : lo[k] + extent;
+						positive += plane[k] * near_k;
+						negative += plane[k] * far_k;
+					}
+					if (positive < 0.0) return;	// wholly outside
+					if (negative < 0.0) inside = false;
+				}
+			}
+			double projected = extent * frustum.pixels_per_unit;
+			if (!frustum.orthographic) {
+				double dist2 = 0.0;
+				for (std::size_t k = 0U; k < 3U; ++k) {
+					const double d = std::max({ lo[k] - frustum.eye[k], 0.0, frustum.eye[k] - (lo[k] + extent) });
+					dist2 += d*d;
+				}
+				const double dist = std::sqrt(dist2);
+				projected = (dist > 0.0) ? projected / dist : std::numeric_limits<double>::infinity();
+			}
+			if (size == leaf_size || projected <= pixel_error) {
+				const double count = static_cast<double>(n.count);
+				out.push_back(lod_node{ corner, size, static_cast<std::size_t>(n.count),
+					{ n.position_sum[0] / count, n.position_sum[1] / count, n.position_sum[2] / count },
+					n.generation_sum / count, count / (extent*extent*extent) });
+				return;
+			}
+			const std::int64_t half = size / 2;
+			for (std::uint32_t octant = 0U; octant < 8U; ++octant) {
+				const std::array<std::int64_t, 3> child_corner = { corner[0] + ((octant & 1U) ? half : 0),
+					corner[1] + ((octant & 2U) ? half : 0), corner[2] + ((octant & 4U) ? half : 0) };
+				select(n.first_child + octant, child_corner, half, frustum, pixel_error, inside, out);
+			}
+		}
+	};
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace utl {
+	/**
+	 * \brief Computes the colour of the particle with generation index `generation` of an aggregate of
+	 *        `total` particles, using the same cold to hot temperature gradient as the viewer.
+	 *
+	 * \param generation Generation index of particle (1-based).
+	 * \param total Total number of particles coloured.
+	 * \param rgb Destination of red, green and blue components in [0,1].
+	 */
+	inline void generation_colour(std::size_t generation, std::size_t total, float* rgb) noexcept {
+		const float t = total ? static_cast<float>(generation) / static_cast<float>(total) : 1.0f;
+		rgb[0] = t;
+		rgb[1] = (generation < total / 2U) ? 2.0f*t : 2.0f*(1.0f - t);
+		rgb[2] = 1.0f - t;
+	}
+	namespace detail {
+		template<typename Ty>
+		void particle_position(const std::pair<Ty, Ty>& p, float* xyz) noexcept {
+			xyz[0] = static_cast<float>(p.first);
+			xyz[1] = static_cast<float>(p.second);
+			xyz[2] = 0.0f;
+		}
+		template<typename Ty>
+		void particle_position(const std::tuple<Ty, Ty, Ty>& p, float* xyz) noexcept {
+			xyz[0] = static_cast<float>(std::get<0>(p));
+			xyz[1] = static_cast<float>(std::get<1>(p));
+			xyz[2] = static_cast<float>(std::get<2>(p));
+		}
+	}
+	/**
+	 * \class instanced_mesh_builder
+	 *
+	 * \brief Builds render geometry for a range of the particle buffer of an aggregate from a single
+	 *        shared sphere template, either as per-instance data for instanced rendering or fully
+	 *        expanded into batched vertex/index buffers.
+	 *
+	 * All output is written into caller allocated contiguous arrays, sized via the `*_required`
+	 * methods, such that a renderer can upload any number of particles in a single call. Vertex
+	 * positions, normals and colours are packed as 3 floats per element.
+	 */
+	class instanced_mesh_builder {
+	public:
+		/**
+		 * \brief Tessellates the sphere template, using latitude rings in the same manner as the
+		 *        viewer's SphereGeometry3D.
+		 *
+		 * \param _radius [= 0.5] Radius of each particle sphere.
+		 * \param _seperators [= 3] Number of latitude rings per hemisphere, excluding the equator.
+		 * \throw Throws std::invalid_argument if _radius is non-positive.
+		 */
+		explicit instanced_mesh_builder(float _radius = 0.5f, unsigned _seperators = 3U) : radius(_radius), seperators(_seperators) {
+			if (!(_radius > 0.0f)) throw std::invalid_argument("radius must be positive.");
+			tessellate();
+		}
+		float get_radius() const noexcept { return radius; }
+		unsigned get_seperators() const noexcept { return seperators; }
+		std::size_t template_vertex_count() const noexcept { return template_positions.size() / 3U; }
+		std::size_t template_index_count() const noexcept { return template_indices.size(); }
+		/**
+		 * \brief Gets the vertex positions of the sphere template, centred on the origin.
+		 *
+		 * \return Packed x,y,z positions of template vertices.
+		 */
+		const std::vector<float>& vertex_positions() const noexcept { return template_positions; }
+		/**
+		 * \brief Gets the (unit) vertex normals of the sphere template.
+		 *
+		 * \return Packed x,y,z normals of template vertices.
+		 */
+		const std::vector<float>& vertex_normals() const noexcept { return template_normals; }
+		/**
+		 * \brief Gets the triangle indices of the sphere template.
+		 *
+		 * \return Triangle list indices into template vertices.
+		 */
+		const std::vector<std::uint32_t>& triangle_indices() const noexcept { return template_indices; }
+		/**
+		 * \brief Gets the number of floats required of each of the position, normal and colour
+		 *        arrays passed to `write_batched` for `count` particles.
+		 */
+		std::size_t vertex_floats_required(std::size_t count) const noexcept { return count*template_positions.size(); }
+		/**
+		 * \brief Gets the number of indices required of the index array passed to `write_batched`
+		 *        for `count` particles.
+		 */
+		std::size_t indices_required(std::size_t count) const noexcept { return count*template_indices.size(); }
+		/**
+		 * \brief Writes the per-instance data of particles `[first, last)` for instanced rendering of the
+		 *        sphere template, i.e. 3 floats of translation and optionally 3 floats of colour per particle.
+		 *
+		 * \param first Pointer to first particle of range.
+		 * \param last Pointer to one past last particle of range.
+		 * \param offsets Destination of 3*(last-first) translation floats.
+		 * \param colours Destination of 3*(last-first) colour floats, or nullptr to skip colouring.
+		 * \param first_generation Generation index (1-based) of particle pointed to by first.
+		 * \param total_generations Total number of particles the colour gradient spans.
+		 */
+		template<class Particle>
+		void write_instances(const Particle* first, const Particle* last, float* offsets, float* colours,
+			std::size_t first_generation = 1U, std::size_t total_generations = 0U) const noexcept {
+			const std::size_t count = static_cast<std::size_t>(last - first);
+			if (!total_generations) total_generations = first_generation + count - 1U;
+			for (std::size_t i = 0U; i < count; ++i) {
+				detail::particle_position(first[i], offsets + 3U*i);
+				if (colours) generation_colour(first_generation + i, total_generations, colours + 3U*i);
+			}
+		}
+		/**
+		 * \brief Writes particles `[first, last)` as one batched mesh, with a translated copy of the sphere
+		 *        template per particle.
+		 *
+		 * \param first Pointer to first particle of range.
+		 * \param last Pointer to one past last particle of range.
+		 * \param positions Destination of `vertex_floats_required(last-first)` position floats.
+		 * \param normals Destination of `vertex_floats_required(last-first)` normal floats, or nullptr to skip.
+		 * \param colours Destination of `vertex_floats_required(last-first)` colour floats, or nullptr to skip.
+		 * \param indices Destination of `indices_required(last-first)` triangle indices.
+		 * \param base_vertex [= 0] Offset added to every index, allowing successive ranges to be appended
+		 *        to the same vertex buffer.
+		 * \param first_generation Generation index (1-based) of particle pointed to by first.
+		 * \param total_generations Total number of particles the colour gradient spans.
+		 * \throw Throws std::length_error if the indices written would not fit in 32 bits.
+		 */
+		template<class Particle>
+		void write_batched(const Particle* first, const Particle* last, float* positions, float* normals, float* colours,
+			std::uint32_t* indices, std::uint32_t base_vertex = 0U, std::size_t first_generation = 1U, std::size_t total_generations = 0U) const {
+			const std::size_t count = static_cast<std::size_t>(last - first);
+			const std::size_t nverts = template_vertex_count();
+			if (base_vertex + static_cast<unsigned long long>(count)*nverts > std::numeric_limits<std::uint32_t>::max())
+				throw std::length_error("batched mesh exceeds range of 32-bit indices.");
+			if (!total_generations) total_generations = first_generation + count - 1U;
+			const std::size_t nfloats = template_positions.size();
+			const std::size_t nindices = template_indices.size();
+			for (std::size_t i = 0U; i < count; ++i) {
+				float centre[3];
+				detail::particle_position(first[i], centre);
+				float* pos = positions + i*nfloats;
+				for (std::size_t j = 0U; j < nfloats; j += 3U) {
+					pos[j] = template_positions[j] + centre[0];
+					pos[j + 1U] = template_positions[j + 1U] + centre[1];
+					pos[j + 2U] = template_positions[j + 2U] + centre[2];
+				}
+				if (normals) std::copy(template_normals.begin(), template_normals.end(), normals + i*nfloats);
+				if (colours) {
+					float rgb[3];
+					generation_colour(first_generation + i, total_generations, rgb);
+					float* col = colours + i*nfloats;
+					for (std::size_t j = 0U; j < nfloats; j += 3U) {
+						col[j] = rgb[0];
+						col[j + 1U] = rgb[1];
+						col[j + 2U] = rgb[2];
+					}
+				}
+				const std::uint32_t offset = base_vertex + static_cast<std::uint32_t>(i*nverts);
+				std::uint32_t* idx = indices + i*nindices;
+				for (std::size_t j = 0U; j < nindices; ++j) idx[j] = template_indices[j] + offset;
+			}
+		}
+	private:
+		float radius;
+		unsigned seperators;
+		std::vector<float> template_positions;
+		std::vector<float> template_normals;
+		std::vector<std::uint32_t> template_indices;
+
+		void tessellate() {
+			const double segment_angle = std::acos(-1.0) / 2.0 / (seperators + 1U);
+			const std::uint32_t n_seperators = 4U*seperators + 4U;
+			const std::uint32_t n_rings = 2U*seperators + 1U;
+			auto add_vertex = [this](double x, double y, double z) {
+				template_normals.push_back(static_cast<float>(x));
+				template_normals.push_back(static_cast<float>(y));
+				template_normals.push_back(static_cast<float>(z));
+				template_positions.push_back(static_cast<float>(radius*x));
+				template_positions.push_back(static_cast<float>(radius*y));
+				template_positions.push_back(static_cast<float>(radius*z));
+			};
+			// latitude rings from south to north
+			for (int i = -static_cast<int>(seperators); i <= static_cast<int>(seperators); ++i) {
+				const double r_i = std::cos(segment_angle*i);
+				const double y_i = std::sin(segment_angle*i);
+				for (std::uint32_t j = 0U; j < n_seperators; ++j)
+					add_vertex(r_i*std::cos(segment_angle*j), y_i, -r_i*std::sin(segment_angle*j));
+			}
+			const std::uint32_t north = n_rings*n_seperators;
+			const std::uint32_t south = north + 1U;
+			add_vertex(0.0, 1.0, 0.0);
+			add_vertex(0.0, -1.0, 0.0);
+			for (std::uint32_t i = 0U; i + 1U < n_rings; ++i) {
+				for (std::uint32_t j = 0U; j < n_seperators; ++j) {
+					const std::uint32_t k = (j + 1U) % n_seperators;
+					template_indices.insert(template_indices.end(), {
+						i*n_seperators + j, (i + 1U)*n_seperators + k, (i + 1U)*n_seperators + j,
+						(i + 1U)*n_seperators + k, i*n_seperators + j, i*n_seperators + k });
+				}
+			}
+			// polar caps, all triangles wound anticlockwise when viewed from outside
+			const std::uint32_t top = (n_rings - 1U)*n_seperators;
+			for (std::uint32_t j = 0U; j < n_seperators; ++j)
+				template_indices.insert(template_indices.end(), { top + j, top + (j + 1U) % n_seperators, north });
+			for (std::uint32_t j = 0U; j < n_seperators; ++j)
+				template_indices.insert(template_indices.end(), { (j + 1U) % n_seperators, j, south });
+		}
+	};
+}
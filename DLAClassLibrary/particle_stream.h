@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace utl {
+	/**
+	 * \struct particle_batch
+	 *
+	 * \brief Contiguous read-only view of particles newly attached to an aggregate, valid until
+	 *        the next batch is pulled from the stream which produced it.
+	 */
+	template<class Ty>
+	struct particle_batch {
+		const Ty* first = nullptr;
+		const Ty* last = nullptr;
+		const Ty* begin() const noexcept { return first; }
+		const Ty* end() const noexcept { return last; }
+		std::size_t size() const noexcept { return static_cast<std::size_t>(last - first); }
+		bool empty() const noexcept { return first == last; }
+	};
+	/**
+	 * \class particle_stream
+	 *
+	 * \brief Pull-based lazy stream of particles attached to an aggregate, in generation order.
+	 *
+	 * Each pull grows the underlying aggregate by (up to) `batch_size` further particles on the
+	 * calling thread and yields a view of exactly those particles, such that the random walk only
+	 * runs as fast as the consumer pulls. Iterating the stream with a range-based for loop yields
+	 * successive batches until the aggregate reaches `limit` particles or a generation is aborted.
+	 * Particles already in the aggregate when the stream is created are not yielded. Should the
+	 * aggregate be cleared between pulls, the next pull yields the regrown aggregate from its first
+	 * particle, provided it was not regrown beyond the previous batch in the meantime.
+	 *
+	 * The continuous flag of the aggregate must not be set whilst pulling from the stream.
+	 *
+	 * \tparam DLA Aggregate type providing `grow_by`, `size` and `aggregate_buffer`, i.e. DLA_2d or DLA_3d.
+	 */
+	template<class DLA>
+	class particle_stream {
+	public:
+		typedef typename std::decay_t<decltype(std::declval<DLA&>().aggregate_buffer())>::value_type value_type;
+		typedef particle_batch<value_type> batch_type;
+		/**
+		 * \class iterator
+		 *
+		 * \brief Input iterator over the batches of a particle_stream, pulling the next batch on increment.
+		 */
+		class iterator {
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef batch_type value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const batch_type* pointer;
+			typedef const batch_type& reference;
+			iterator() noexcept = default;
+			explicit iterator(particle_stream* _stream) : stream(_stream) { ++*this; }
+			reference operator*() const noexcept { return current; }
+			pointer operator->() const noexcept { return &current; }
+			iterator& operator++() {
+				current = stream->next();
+				if (current.empty()) stream = nullptr;	// exhausted, compare equal to end()
+				return *this;
+			}
+			bool operator==(const iterator& other) const noexcept { return stream == other.stream; }
+			bool operator!=(const iterator& other) const noexcept { return stream != other.stream; }
+		private:
+			particle_stream* stream = nullptr;
+			batch_type current;
+		};
+		/**
+		 * \brief Creates a stream over the particles subsequently attached to `_dla`.
+		 *
+		 * \param _dla Aggregate to grow, must outlive the stream.
+		 * \param _batch_size [= 1] Maximum number of particles per pulled batch.
+		 * \param _limit [= max] Aggregate size at which the stream ends.
+		 */
+		explicit particle_stream(DLA& _dla, std::size_t _batch_size = 1U, std::size_t _limit = std::numeric_limits<std::size_t>::max())
+			: dla(_dla), batch_size(_batch_size ? _batch_size : 1U), limit(_limit), cursor(_dla.aggregate_buffer().size()) {}
+		/**
+		 * \brief Grows the aggregate by the next batch of particles and returns a view of them.
+		 *
+		 * \return Batch of newly attached particles, empty once the stream is exhausted.
+		 */
+		batch_type next() {
+			const std::size_t current_size = dla.size();
+			// aggregate cleared since the last batch, yield the new aggregate from its first particle
+			if (cursor > dla.aggregate_buffer().size()) cursor = 0U;
+			if (current_size >= limit) return batch_type();
+			dla.grow_by((limit - current_size < batch_size) ? limit - current_size : batch_size);
+			const auto& buffer = dla.aggregate_buffer();
+			batch_type batch;
+			batch.first = buffer.data() + cursor;
+			batch.last = buffer.data() + buffer.size();
+			cursor = buffer.size();
+			return batch;
+		}
+		iterator begin() { return iterator(this); }
+		iterator end() noexcept { return iterator(); }
+	private:
+		DLA& dla;
+		std::size_t batch_size;
+		std::size_t limit;
+		// index into the aggregate buffer of the first particle not yet yielded
+		std::size_t cursor;
+	};
+}
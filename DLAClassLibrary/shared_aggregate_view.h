@@ -0,0 +1,192 @@
+#pragma once
+#include "DLAContainer.h"
+#include "attachment_observer.h"
+#include "shared_memory_region.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace utl {
+	/**
+	 * \struct shared_view_header
+	 *
+	 * \brief Layout of the header at the start of a shared aggregate view region. The header is
+	 *        followed by `capacity*dimension` 32-bit co-ordinates in generation order.
+	 *
+	 * Particles are written before `published_count` is released, such that a reader which
+	 * acquires `published_count` may read that many particles without any further synchronisation,
+	 * as long as the aggregate is not cleared meanwhile. Clearing the aggregate retracts the published
+	 * particles and increments `generation` before the particles of the new aggregate overwrite them,
+	 * so a reader must take `generation` before reading and discard what it read if `generation` has
+	 * changed since (see shared_view_reader::is_current).
+	 */
+	struct shared_view_header {
+		static constexpr std::uint32_t magic_value = 0x444C4156U; // "DLAV"
+		static constexpr std::uint32_t layout_version = 2U;
+		std::uint32_t magic;
+		std::uint32_t version;
+		std::uint32_t dimension;
+		std::uint32_t overflowed;	// non-zero once more particles attached than capacity allows
+		std::uint64_t capacity;
+		std::atomic<std::uint64_t> published_count;
+		std::atomic<std::uint64_t> aggregate_misses;
+		std::atomic<std::uint64_t> aggregate_span;
+		std::atomic<std::uint64_t> generation;	// incremented each time the aggregate is cleared
+	};
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared view requires lock-free 64-bit atomics.");
+
+	namespace detail {
+		template<class Particle, std::size_t... I>
+		void write_coordinates(std::int32_t* dest, const Particle& p, std::index_sequence<I...>) noexcept {
+			const int expand[] = { (dest[I] = static_cast<std::int32_t>(std::get<I>(p)), 0)... };
+			(void)expand;
+		}
+	}
+	/**
+	 * \class shared_view_publisher
+	 *
+	 * \brief Attachment observer publishing the particles of an aggregate, along with its miss and
+	 *        span counters, into a named shared memory region for out-of-process renderers/monitors.
+	 *
+	 * Register with the aggregate via `add_observer` (inline dispatch, batch size trading latency
+	 * against overhead). The region has a fixed particle capacity, once exceeded further particles
+	 * are not published and the `overflowed` flag of the header is raised.
+	 *
+	 * \tparam Particle Co-ordinate type of the aggregate particles.
+	 */
+	template<class Particle>
+	class shared_view_publisher : public attachment_observer<Particle> {
+		static constexpr std::size_t dimension = std::tuple_size<Particle>::value;
+	public:
+		/**
+		 * \brief Creates the named region for up to `capacity` particles of `dla`.
+		 *
+		 * \param dla Aggregate whose counters are published, must outlive the publisher.
+		 * \param name Name of the shared memory region.
+		 * \param capacity Maximum number of particles published.
+		 */
+		shared_view_publisher(const DLAContainer& dla, const std::string& name, std::size_t capacity)
+			: container(dla),
+			region(shared_memory_region::create(name, sizeof(shared_view_header) + capacity*dimension*sizeof(std::int32_t))) {
+			header = new (region.data()) shared_view_header();
+			header->magic = shared_view_header::magic_value;
+			header->version = shared_view_header::layout_version;
+			header->dimension = static_cast<std::uint32_t>(dimension);
+			header->overflowed = 0U;
+			header->capacity = capacity;
+			header->published_count.store(0U, std::memory_order_relaxed);
+			header->aggregate_misses.store(0U, std::memory_order_relaxed);
+			header->aggregate_span.store(0U, std::memory_order_relaxed);
+			header->generation.store(0U, std::memory_order_relaxed);
+			coordinates = reinterpret_cast<std::int32_t*>(header + 1);
+		}
+		void on_attach(const particle_batch<Particle>& batch, std::size_t first_index) override {
+			const std::size_t capacity = static_cast<std::size_t>(header->capacity);
+			if (first_index < published) {
+				// aggregate cleared since last batch: retract the published particles and start a new
+				// generation before any of them is overwritten, then republish from the start
+				published = first_index;
+				header->overflowed = 0U;
+				header->published_count.store(published, std::memory_order_relaxed);
+				header->generation.fetch_add(1U, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+			}
+			std::size_t index = published;
+			for (const auto& p : batch) {
+				if (index >= capacity) {
+					header->overflowed = 1U;
+					break;
+				}
+				detail::write_coordinates(coordinates + index*dimension, p, std::make_index_sequence<dimension>());
+				++index;
+			}
+			published = index;
+			header->aggregate_misses.store(container.aggregate_misses(), std::memory_order_relaxed);
+			header->aggregate_span.store(container.aggregate_spanning_distance(), std::memory_order_relaxed);
+			header->published_count.store(published, std::memory_order_release);
+		}
+	private:
+		const DLAContainer& container;
+		shared_memory_region region;
+		shared_view_header* header;
+		std::int32_t* coordinates;
+		std::size_t published = 0U;
+	};
+	/**
+	 * \class shared_view_reader
+	 *
+	 * \brief Read-only mapping of a shared aggregate view published by a shared_view_publisher,
+	 *        possibly in another process.
+	 *
+	 * The publisher overwrites the particles of a cleared aggregate in place, so a consistent snapshot
+	 * is read as follows: take `generation()`, then `published_count()`, copy that many particles, and
+	 * keep the copy only if `is_current` holds for the generation taken, retrying otherwise.
+	 */
+	class shared_view_reader {
+	public:
+		/**
+		 * \brief Maps the named region read-only.
+		 *
+		 * \param name Name of the shared memory region.
+		 * \throw Throws std::runtime_error if the region is missing or not a shared aggregate view.
+		 */
+		explicit shared_view_reader(const std::string& name)
+			: region(shared_memory_region::open_read_only(name)) {
+			header = static_cast<const shared_view_header*>(region.data());
+			if (region.size() < sizeof(shared_view_header) || header->magic != shared_view_header::magic_value
+				|| header->version != shared_view_header::layout_version)
+				throw std::runtime_error("shared memory region " + name + " is not a shared aggregate view.");
+		}
+		std::size_t dimension() const noexcept { return header->dimension; }
+		std::size_t capacity() const noexcept { return static_cast<std::size_t>(header->capacity); }
+		bool overflowed() const noexcept { return header->overflowed != 0U; }
+		/**
+		 * \brief Gets the number of particles which may currently be read.
+		 *
+		 * \return Number of published particles.
+		 */
+		std::size_t published_count() const noexcept {
+			return static_cast<std::size_t>(header->published_count.load(std::memory_order_acquire));
+		}
+		std::size_t aggregate_misses() const noexcept {
+			return static_cast<std::size_t>(header->aggregate_misses.load(std::memory_order_relaxed));
+		}
+		std::size_t aggregate_span() const noexcept {
+			return static_cast<std::size_t>(header->aggregate_span.load(std::memory_order_relaxed));
+		}
+		/**
+		 * \brief Gets the generation of the published particles, incremented each time the aggregate is
+		 *        cleared and republished from the start.
+		 *
+		 * \return Current generation.
+		 */
+		std::uint64_t generation() const noexcept {
+			return header->generation.load(std::memory_order_acquire);
+		}
+		/**
+		 * \brief Checks, after reading particles, that the aggregate has not been cleared since
+		 *        `generation()` was taken, in which case the particles read may have been overwritten.
+		 *
+		 * \param taken Generation taken before reading.
+		 * \return true if the particles read belong to generation `taken`, false otherwise.
+		 */
+		bool is_current(std::uint64_t taken) const noexcept {
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return header->generation.load(std::memory_order_relaxed) == taken;
+		}
+		/**
+		 * \brief Gets the co-ordinates of the published particles, component `k` of particle `i`
+		 *        at index `i*dimension() + k`.
+		 *
+		 * \return Pointer to the first co-ordinate.
+		 */
+		const std::int32_t* coordinates() const noexcept { return reinterpret_cast<const std::int32_t*>(header + 1); }
+	private:
+		shared_memory_region region;
+		const shared_view_header* header;
+	};
+}
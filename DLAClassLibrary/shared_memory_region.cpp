@@ -0,0 +1,121 @@
+#include "Stdafx.h"
+#include "shared_memory_region.h"
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifndef _WIN32
+	std::string posix_name(const std::string& name) {
+		return (!name.empty() && name[0] == '/') ? name : "/" + name;
+	}
+#endif
+}
+
+utl::shared_memory_region utl::shared_memory_region::create(const std::string& name, std::size_t bytes) {
+	shared_memory_region region;
+	region.bytes = bytes;
+	region.owner = true;
+#ifdef _WIN32
+	region.name = name;
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(static_cast<unsigned long long>(bytes) >> 32), static_cast<DWORD>(bytes & 0xFFFFFFFFULL), name.c_str());
+	if (!mapping) throw std::runtime_error("unable to create shared memory region " + name);
+	region.native_handle = mapping;
+	region.address = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+	if (!region.address) throw std::runtime_error("unable to map shared memory region " + name);
+#else
+	region.name = posix_name(name);
+	const int fd = shm_open(region.name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+	if (fd < 0) throw std::runtime_error("unable to create shared memory region " + region.name);
+	if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+		close(fd);
+		shm_unlink(region.name.c_str());
+		throw std::runtime_error("unable to size shared memory region " + region.name);
+	}
+	void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED) {
+		shm_unlink(region.name.c_str());
+		throw std::runtime_error("unable to map shared memory region " + region.name);
+	}
+	region.address = address;
+#endif
+	return region;
+}
+
+utl::shared_memory_region utl::shared_memory_region::open_read_only(const std::string& name) {
+	shared_memory_region region;
+#ifdef _WIN32
+	region.name = name;
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+	if (!mapping) throw std::runtime_error("unable to open shared memory region " + name);
+	region.native_handle = mapping;
+	region.address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!region.address) throw std::runtime_error("unable to map shared memory region " + name);
+	MEMORY_BASIC_INFORMATION info;
+	VirtualQuery(region.address, &info, sizeof(info));
+	region.bytes = info.RegionSize;
+#else
+	region.name = posix_name(name);
+	const int fd = shm_open(region.name.c_str(), O_RDONLY, 0);
+	if (fd < 0) throw std::runtime_error("unable to open shared memory region " + region.name);
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error("unable to stat shared memory region " + region.name);
+	}
+	region.bytes = static_cast<std::size_t>(st.st_size);
+	void* address = mmap(nullptr, region.bytes, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED) throw std::runtime_error("unable to map shared memory region " + region.name);
+	region.address = address;
+#endif
+	return region;
+}
+
+utl::shared_memory_region::shared_memory_region(shared_memory_region&& other) noexcept
+	: name(std::move(other.name)), address(other.address), bytes(other.bytes), owner(other.owner), native_handle(other.native_handle) {
+	other.address = nullptr;
+	other.native_handle = nullptr;
+	other.owner = false;
+}
+
+utl::shared_memory_region& utl::shared_memory_region::operator=(shared_memory_region&& other) noexcept {
+	if (this != &other) {
+		release();
+		name = std::move(other.name);
+		address = other.address;
+		bytes = other.bytes;
+		owner = other.owner;
+		native_handle = other.native_handle;
+		other.address = nullptr;
+		other.native_handle = nullptr;
+		other.owner = false;
+	}
+	return *this;
+}
+
+utl::shared_memory_region::~shared_memory_region() {
+	release();
+}
+
+void utl::shared_memory_region::release() noexcept {
+#ifdef _WIN32
+	if (address) UnmapViewOfFile(address);
+	if (native_handle) CloseHandle(static_cast<HANDLE>(native_handle));
+#else
+	if (address) munmap(address, bytes);
+	if (owner) shm_unlink(name.c_str());
+#endif
+	address = nullptr;
+	native_handle = nullptr;
+	owner = false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace utl {
+	/**
+	 * \class shared_memory_region
+	 *
+	 * \brief RAII wrapper around a named shared memory mapping, `shm_open`/`mmap` on POSIX
+	 *        systems and a named file mapping on Windows.
+	 *
+	 * The creating process owns the name, which is removed when the owning region is destroyed
+	 * (POSIX), processes opening an existing region only map it read-only.
+	 */
+	class shared_memory_region {
+	public:
+		/**
+		 * \brief Creates (or truncates) a named region of `bytes` bytes mapped read-write.
+		 *
+		 * \param name Name of the region, e.g. "/dla_view" (a leading '/' is added on POSIX if absent).
+		 * \param bytes Size of the region in bytes.
+		 * \throw Throws std::runtime_error if the region cannot be created or mapped.
+		 */
+		static shared_memory_region create(const std::string& name, std::size_t bytes);
+		/**
+		 * \brief Maps an existing named region read-only.
+		 *
+		 * \param name Name of the region.
+		 * \throw Throws std::runtime_error if the region does not exist or cannot be mapped.
+		 */
+		static shared_memory_region open_read_only(const std::string& name);
+		shared_memory_region(const shared_memory_region&) = delete;
+		shared_memory_region& operator=(const shared_memory_region&) = delete;
+		shared_memory_region(shared_memory_region&& other) noexcept;
+		shared_memory_region& operator=(shared_memory_region&& other) noexcept;
+		/**
+		 * \brief Unmaps the region, removing its name if this region created it.
+		 */
+		~shared_memory_region();
+		void* data() const noexcept { return address; }
+		std::size_t size() const noexcept { return bytes; }
+	private:
+		shared_memory_region() = default;
+		void release() noexcept;
+		std::string name;
+		void* address = nullptr;
+		std::size_t bytes = 0U;
+		bool owner = false;
+		void* native_handle = nullptr;	// HANDLE of file mapping on Windows, unused on POSIX
+	};
+}
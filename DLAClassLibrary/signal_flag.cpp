@@ -0,0 +1,32 @@
+#include "Stdafx.h"
+#include "signal_flag.h"
+#include <atomic>
+
+struct utl::signal_flag::impl {
+	std::atomic<bool> raised{ false };
+};
+
+utl::signal_flag::signal_flag() : pimpl(std::make_unique<impl>()) {}
+
+utl::signal_flag::signal_flag(const signal_flag&) : pimpl(std::make_unique<impl>()) {}
+
+utl::signal_flag::signal_flag(signal_flag&& other) noexcept : pimpl(std::move(other.pimpl)) {}
+
+utl::signal_flag::~signal_flag() = default;
+
+void utl::signal_flag::raise() noexcept {
+	set(true);
+}
+
+void utl::signal_flag::lower() noexcept {
+	set(false);
+}
+
+void utl::signal_flag::set(bool raised) noexcept {
+	// signals carry no data for the observing thread, such that relaxed ordering suffices
+	if (pimpl) pimpl->raised.store(raised, std::memory_order_relaxed);
+}
+
+bool utl::signal_flag::is_raised() const noexcept {
+	return pimpl && pimpl->raised.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <memory>
+
+namespace utl {
+	/**
+	 * \class signal_flag
+	 *
+	 * \brief Flag raised or lowered by a controlling thread and observed by a generating thread, such as
+	 *        the abort signal and continuous flag of an aggregate.
+	 *
+	 * The atomic flag is hidden behind a pointer to implementation such that this header can be included
+	 * by code compiled with /clr, under which <atomic> is unavailable. A copy is a new lowered flag, as
+	 * signals belong to the generation of one aggregate, and a moved-from flag is permanently lowered.
+	 */
+	class signal_flag {
+	public:
+		/**
+		 * \brief Initialises a lowered flag.
+		 */
+		signal_flag();
+		signal_flag(const signal_flag&);
+		signal_flag(signal_flag&& other) noexcept;
+		signal_flag& operator=(const signal_flag&) = delete;
+		~signal_flag();
+		/**
+		 * \brief Raises the flag.
+		 */
+		void raise() noexcept;
+		/**
+		 * \brief Lowers the flag.
+		 */
+		void lower() noexcept;
+		/**
+		 * \brief Raises or lowers the flag.
+		 *
+		 * \param raised Flag determining whether to raise rather than lower.
+		 */
+		void set(bool raised) noexcept;
+		/**
+		 * \brief Gets whether the flag is raised.
+		 */
+		bool is_raised() const noexcept;
+	private:
+		struct impl;
+		std::unique_ptr<impl> pimpl;
+	};
+}
@@ -0,0 +1,103 @@
+#include "Stdafx.h"
+#include "sweep_scheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct utl::sweep_scheduler::impl {
+	struct worker_queue {
+		std::mutex mtx;
+		std::deque<job_type> jobs;
+	};
+	std::size_t threads;
+	std::vector<std::pair<double, job_type>> pending;
+	std::vector<std::unique_ptr<worker_queue>> queues;
+	std::atomic<bool> failed{ false };
+	std::atomic<std::size_t> steals{ 0U };
+	std::mutex error_mtx;
+	std::exception_ptr error;
+
+	bool pop_own(std::size_t id, job_type& job) {
+		worker_queue& q = *queues[id];
+		std::lock_guard<std::mutex> lock(q.mtx);
+		if (q.jobs.empty()) return false;
+		job = std::move(q.jobs.front());
+		q.jobs.pop_front();
+		return true;
+	}
+	bool steal(std::size_t id, job_type& job) {
+		// jobs are never added once running, so retry only while some deque is non-empty
+		for (;;) {
+			std::size_t victim = id;
+			std::size_t most = 0U;
+			for (std::size_t i = 0U; i < queues.size(); ++i) {
+				if (i == id) continue;
+				std::lock_guard<std::mutex> lock(queues[i]->mtx);
+				if (queues[i]->jobs.size() > most) {
+					most = queues[i]->jobs.size();
+					victim = i;
+				}
+			}
+			if (victim == id) return false;
+			std::lock_guard<std::mutex> lock(queues[victim]->mtx);
+			if (queues[victim]->jobs.empty()) continue;	// emptied by its owner or another thief meanwhile
+			job = std::move(queues[victim]->jobs.front());
+			queues[victim]->jobs.pop_front();
+			steals.fetch_add(1U, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	void work(std::size_t id) {
+		job_type job;
+		while (!failed.load(std::memory_order_relaxed) && (pop_own(id, job) || steal(id, job))) {
+			try {
+				job();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(error_mtx);
+				if (!error) error = std::current_exception();
+				failed.store(true, std::memory_order_relaxed);
+			}
+		}
+	}
+};
+
+utl::sweep_scheduler::sweep_scheduler(std::size_t _threads) : pimpl(std::make_unique<impl>()) {
+	pimpl->threads = _threads ? _threads : std::max(1U, std::thread::hardware_concurrency());
+}
+
+utl::sweep_scheduler::~sweep_scheduler() = default;
+
+std::size_t utl::sweep_scheduler::thread_count() const noexcept {
+	return pimpl->threads;
+}
+
+void utl::sweep_scheduler::submit(double cost, job_type job) {
+	pimpl->pending.emplace_back(cost, std::move(job));
+}
+
+std::size_t utl::sweep_scheduler::run() {
+	auto& pending = pimpl->pending;
+	// largest first, stable such that equal cost jobs keep their submission order
+	std::stable_sort(pending.begin(), pending.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+	const std::size_t nthreads = std::max<std::size_t>(1U, std::min(pimpl->threads, pending.size()));
+	pimpl->queues.clear();
+	for (std::size_t i = 0U; i < nthreads; ++i) pimpl->queues.push_back(std::make_unique<impl::worker_queue>());
+	for (std::size_t i = 0U; i < pending.size(); ++i) pimpl->queues[i % nthreads]->jobs.push_back(std::move(pending[i].second));
+	pending.clear();
+	pimpl->failed.store(false);
+	pimpl->steals.store(0U);
+	pimpl->error = nullptr;
+	std::vector<std::thread> workers;
+	for (std::size_t i = 1U; i < nthreads; ++i) workers.emplace_back(&impl::work, pimpl.get(), i);
+	pimpl->work(0U);	// calling thread acts as first worker
+	for (auto& w : workers) w.join();
+	pimpl->queues.clear();
+	if (pimpl->error) std::rethrow_exception(pimpl->error);
+	return pimpl->steals.load();
+}
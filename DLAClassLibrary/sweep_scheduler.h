@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace utl {
+	/**
+	 * \class sweep_scheduler
+	 *
+	 * \brief Runs a batch of independent jobs, such as the runs of a parameter sweep, on a pool of
+	 *        worker threads with work stealing.
+	 *
+	 * Jobs are ordered by decreasing estimated cost and dealt round-robin into one deque per worker.
+	 * A worker takes jobs from the front of its own deque and, once that is empty, steals from the
+	 * front of the fullest other deque, such that the largest remaining jobs always start first and
+	 * small jobs fill the tail rather than one large straggler. Jobs must be safe to run concurrently.
+	 *
+	 * The thread machinery is hidden behind a pointer to implementation, as for observer_dispatcher.
+	 */
+	class sweep_scheduler {
+	public:
+		typedef std::function<void()> job_type;
+		/**
+		 * \brief Creates a scheduler with no jobs.
+		 *
+		 * \param _threads [= 0] Number of worker threads, zero for the hardware concurrency.
+		 */
+		explicit sweep_scheduler(std::size_t _threads = 0U);
+		sweep_scheduler(const sweep_scheduler&) = delete;
+		sweep_scheduler& operator=(const sweep_scheduler&) = delete;
+		~sweep_scheduler();
+		/**
+		 * \brief Gets the number of worker threads used by `run`.
+		 */
+		std::size_t thread_count() const noexcept;
+		/**
+		 * \brief Adds a job to be run by the next call to `run`.
+		 *
+		 * \param cost Estimated relative cost of job, used only for ordering.
+		 * \param job Job to run.
+		 */
+		void submit(double cost, job_type job);
+		/**
+		 * \brief Runs all submitted jobs, blocking until they have finished.
+		 *
+		 * If a job throws, no further jobs are started and the first exception is rethrown once
+		 * the running jobs have finished.
+		 *
+		 * \return Number of jobs stolen from another worker's deque.
+		 */
+		std::size_t run();
+	private:
+		struct impl;
+		std::unique_ptr<impl> pimpl;
+	};
+}
@@ -1,9 +1,16 @@
 #pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <istream>
 #include <ostream>
 #include <random>
 #include <type_traits>
 #include <tuple>
 #include <utility>
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)) && !defined(_M_CEE)
+#include <xmmintrin.h>
+#endif
 
 /**
  * \enum lattice_type
@@ -15,6 +22,9 @@
 enum class lattice_type {
 	SQUARE, // square for 2D, cubic for 3D
 	TRIANGLE, // triangular for 2D, hexagonal for 3D
+	HEXAGONAL, // hexagonal with six equally weighted neighbours, 2D only
+	FCC, // face-centred cubic, 3D only
+	BCC, // body-centred cubic, 3D only
 };
 
 /** 
@@ -88,6 +98,11 @@ namespace utl {
 			return std::abs(tuple_distance_t<decltype(lhs), 2>::tuple_distance(lhs, att, att_size))
 				< std::abs(tuple_distance_t<decltype(rhs), 2>::tuple_distance(rhs, att, att_size));
 		}
+		template<class Ty, std::size_t N>
+		bool operator()(const std::array<Ty, N>& lhs, const std::array<Ty, N>& rhs) const {
+			return std::abs(tuple_distance_t<decltype(lhs), N>::tuple_distance(lhs, att, att_size))
+				< std::abs(tuple_distance_t<decltype(rhs), N>::tuple_distance(rhs, att, att_size));
+		}
 	};
 	// TUPLE_HASH
 	/**
@@ -125,6 +140,13 @@ namespace utl {
 		std::size_t operator()(const std::pair<Ty1, Ty2>& p) const {
 			return tuple_hash_compute<std::pair<Ty1, Ty2>, 2>::hash_compute(p);
 		}
+		// mixes rather than sums co-ordinates, as sums collide along whole hyperplanes in higher dimensions
+		template<class Ty, std::size_t N>
+		std::size_t operator()(const std::array<Ty, N>& a) const {
+			std::size_t h = 0U;
+			for (const auto& x : a) h ^= std::hash<Ty>()(x) + 0x9E3779B9U + (h << 6) + (h >> 2);
+			return h;
+		}
 	};
 	// std::pair INSERTION OPERATOR
 	/**
@@ -172,6 +194,73 @@ namespace utl {
 		tuple_write_t<std::tuple<Args...>, sizeof...(Args)>::tuple_write(os, t);
 		return os;
 	}
+	// std::array INSERTION OPERATOR
+	/**
+	 * \brief Writes a `std::array` to an output stream `os` as tab separated values.
+	 *
+	 * \param os Instance of output stream to write to.
+	 * \param a `std::array` instance to write to `os`.
+	 * \return `os`.
+	 */
+	template<class Ty, std::size_t N>
+	std::ostream& operator<<(std::ostream& os, const std::array<Ty, N>& a) {
+		for (std::size_t i = 0U; i < N; ++i) os << (i ? "\t" : "") << a[i];
+		return os;
+	}
+	/**
+	 * \brief Writes the particles of an aggregate held in order of generation to an output stream `os`,
+	 *        one per line, each preceded by its generation (counted from one) unless written in
+	 *        generation order.
+	 *
+	 * \param os Instance of output stream to write to.
+	 * \param particles Particles of aggregate in order of generation.
+	 * \param sort_by_gen_order Whether to write in generation order without generation numbers.
+	 * \return `os`.
+	 */
+	template<class Container>
+	std::ostream& write_generations(std::ostream& os, const Container& particles, bool sort_by_gen_order) {
+		std::size_t generation = 0U;
+		for (const auto& p : particles) {
+			if (!sort_by_gen_order) os << ++generation << '\t';
+			os << p << '\n';
+		}
+		return os;
+	}
+	// GRID_TRAVERSAL
+	/**
+	 * \brief Hints the processor to fetch the cache line of an address ahead of its use, does nothing
+	 *        where no such hint is available (including code compiled with /clr).
+	 *
+	 * \param address Address to fetch.
+	 */
+	inline void prefetch(const void* address) noexcept {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)) && !defined(_M_CEE)
+		_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(address);
+#else
+		(void)address;
+#endif
+	}
+	/**
+	 * \brief Calls `f(node, j)` for every node of a grid of `nodes` nodes along each of `N` axes, in
+	 *        order of increasing index, `j` being the array indices of the node with the first axis
+	 *        varying fastest.
+	 *
+	 * \tparam N Number of axes of grid.
+	 * \param nodes Number of nodes along each axis.
+	 * \param f Function of node index and array indices.
+	 */
+	template<std::size_t N, class Function>
+	void for_each_node(std::size_t nodes, Function f) {
+		std::size_t count = 1U;
+		for (std::size_t i = 0U; i < N; ++i) count *= nodes;
+		std::array<std::size_t, N> j = {};
+		for (std::size_t node = 0U; node < count; ++node) {
+			f(node, j);
+			for (std::size_t i = 0U; i < N && ++j[i] == nodes; ++i) j[i] = 0U;
+		}
+	}
 #ifndef RANDOM_NUMBER_GENERATOR_H
 #define RANDOM_NUMBER_GENERATOR_H
 	/**
@@ -269,7 +358,7 @@ namespace utl {
 		 */
 		random_number_generator& operator=(random_number_generator&& other) {
 			if (this != &other)
-				swap(*this, std::move(other));
+				swap(other);
 			return *this;
 		}
 		// GENERATING OPERATOR()
@@ -330,6 +419,115 @@ namespace utl {
 		distribution_type dist;
 	};
 #endif // !RANDOM_NUMBER_GENERATOR_H
+#ifndef PHILOX_ENGINE_H
+#define PHILOX_ENGINE_H
+	/**
+	 * \class philox4x32
+	 *
+	 * \brief Counter-based pseudo-random bit generator implementing Philox4x32-10 (J. K. Salmon et al.,
+	 *        "Parallel random numbers: as easy as 1, 2, 3", SC11).
+	 *
+	 * Every block of four 32-bit outputs is a keyed bijection of a 128-bit counter, the key being the
+	 * 64-bit seed and the counter consisting of the 64-bit block index and the 64-bit stream number.
+	 * Any position (seed, stream, offset) is thus reachable in constant time and the streams of a seed
+	 * are statistically independent, such that parallel, ensemble and checkpointed runs draw
+	 * reproducible, non-overlapping sequences from a state of 40 bytes (against the 2.5 KB of
+	 * `std::mt19937`). Meets the requirements of `RandomNumberEngine`, save that `seed` takes a
+	 * stream rather than a `SeedSequence`.
+	 */
+	class philox4x32 {
+	public:
+		typedef std::uint32_t result_type;
+		static constexpr result_type min() { return 0U; }
+		static constexpr result_type max() { return 0xFFFFFFFFU; }
+		/**
+		 * \brief Constructs the generator at the start of stream `_stream` of seed `_seed`.
+		 *
+		 * \param _seed [= 0] Seed, the key of the generator.
+		 * \param _stream [= 0] Stream number.
+		 */
+		explicit philox4x32(std::uint64_t _seed = 0U, std::uint64_t _stream = 0U) noexcept { seed(_seed, _stream); }
+		/**
+		 * \brief Moves the generator to the start of stream `_stream` of seed `_seed`.
+		 */
+		void seed(std::uint64_t _seed = 0U, std::uint64_t _stream = 0U) noexcept {
+			key = _seed;
+			strm = _stream;
+			position = 0U;
+		}
+		/**
+		 * \brief Generates the next 32-bit value of the stream.
+		 */
+		result_type operator()() noexcept {
+			if (!(position & 3U)) output = block(position >> 2);
+			return output[position++ & 3U];
+		}
+		/**
+		 * \brief Advances the generator by `z` values in constant time.
+		 */
+		void discard(std::uint64_t z) noexcept {
+			position += z;
+			if (position & 3U) output = block(position >> 2);
+		}
+		std::uint64_t get_seed() const noexcept { return key; }
+		std::uint64_t stream() const noexcept { return strm; }
+		/**
+		 * \brief Gets the number of values generated since the start of the stream.
+		 */
+		std::uint64_t offset() const noexcept { return position; }
+		friend bool operator==(const philox4x32& lhs, const philox4x32& rhs) noexcept {
+			return lhs.key == rhs.key && lhs.strm == rhs.strm && lhs.position == rhs.position;
+		}
+		friend bool operator!=(const philox4x32& lhs, const philox4x32& rhs) noexcept { return !(lhs == rhs); }
+		// textual state as seed, stream and offset
+		template<class CharT, class Traits>
+		friend std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os, const philox4x32& eng) {
+			return os << eng.key << os.widen(' ') << eng.strm << os.widen(' ') << eng.position;
+		}
+		template<class CharT, class Traits>
+		friend std::basic_istream<CharT, Traits>& operator>>(std::basic_istream<CharT, Traits>& is, philox4x32& eng) {
+			std::uint64_t k = 0U, s = 0U, p = 0U;
+			if (is >> k >> s >> p) {
+				eng.seed(k, s);
+				eng.discard(p);
+			}
+			return is;
+		}
+	private:
+		std::uint64_t key;
+		std::uint64_t strm;
+		std::uint64_t position;
+		std::array<std::uint32_t, 4> output{};	// block of values at position, valid whilst position % 4 != 0
+		std::array<std::uint32_t, 4> block(std::uint64_t index) const noexcept {
+			std::uint32_t ctr[4] = { static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32),
+				static_cast<std::uint32_t>(strm), static_cast<std::uint32_t>(strm >> 32) };
+			std::uint32_t k0 = static_cast<std::uint32_t>(key);
+			std::uint32_t k1 = static_cast<std::uint32_t>(key >> 32);
+			for (int round = 0; round < 10; ++round) {
+				const std::uint64_t p0 = 0xD2511F53ULL * ctr[0];
+				const std::uint64_t p1 = 0xCD9E8D57ULL * ctr[2];
+				ctr[0] = static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ k0;
+				ctr[1] = static_cast<std::uint32_t>(p1);
+				ctr[2] = static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ k1;
+				ctr[3] = static_cast<std::uint32_t>(p0);
+				k0 += 0x9E3779B9U;	// Weyl sequence key schedule
+				k1 += 0xBB67AE85U;
+			}
+			return { { ctr[0], ctr[1], ctr[2], ctr[3] } };
+		}
+	};
+	/**
+	 * \brief Draws a seed from the non-deterministic `std::random_device`, for runs which are not
+	 *        explicitly seeded.
+	 *
+	 * \return 64-bit seed.
+	 */
+	inline std::uint64_t random_seed() {
+		std::random_device rd;
+		const std::uint64_t high = rd();
+		return (high << 32) | rd();
+	}
+#endif // !PHILOX_ENGINE_H
 #ifndef UNIFORM_RANDOM_PROBABILITY_GENERATOR_H
 #define UNIFORM_RANDOM_PROBABILITY_GENERATOR_H
 	/**
@@ -0,0 +1,104 @@
+#include "Stdafx.h"
+#include "worker_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct utl::worker_pool::impl {
+	// one call of run, whose shares are claimed by the calling thread and idle workers
+	struct loop {
+		const share_type* share;
+		std::size_t shares;
+		std::atomic<std::size_t> next{ 0U };
+		std::atomic<std::size_t> completed{ 0U };
+		bool finished = false;	// guarded by mtx
+		std::exception_ptr error;	// guarded by mtx
+		loop(const share_type* _share, std::size_t _shares) : share(_share), shares(_shares) {}
+	};
+	std::mutex mtx;
+	std::condition_variable work_cv;
+	std::condition_variable finished_cv;
+	std::deque<std::shared_ptr<loop>> loops;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	// claims and runs shares of l until none remain
+	void take_part(loop& l) {
+		std::size_t s;
+		while ((s = l.next.fetch_add(1U, std::memory_order_relaxed)) < l.shares) {
+			try {
+				(*l.share)(s);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(mtx);
+				if (!l.error) l.error = std::current_exception();
+			}
+			if (l.completed.fetch_add(1U, std::memory_order_acq_rel) + 1U == l.shares) {
+				std::lock_guard<std::mutex> lock(mtx);
+				l.finished = true;
+				finished_cv.notify_all();
+			}
+		}
+	}
+	void work() {
+		std::unique_lock<std::mutex> lock(mtx);
+		for (;;) {
+			work_cv.wait(lock, [this]() { return stopping || !loops.empty(); });
+			if (stopping) return;
+			std::shared_ptr<loop> l = loops.front();
+			lock.unlock();
+			take_part(*l);
+			lock.lock();
+			// every share is claimed, so no other worker need visit this loop
+			if (!loops.empty() && loops.front() == l) loops.pop_front();
+		}
+	}
+};
+
+utl::worker_pool& utl::worker_pool::shared() {
+	// never destroyed, as joining threads whilst a library is unloaded may deadlock
+	static worker_pool* pool = new worker_pool(std::max(1U, std::thread::hardware_concurrency()) - 1U);
+	return *pool;
+}
+
+utl::worker_pool::worker_pool(std::size_t _workers) : pimpl(std::make_unique<impl>()) {
+	pimpl->workers.reserve(_workers);
+	for (std::size_t i = 0U; i < _workers; ++i) pimpl->workers.emplace_back(&impl::work, pimpl.get());
+}
+
+utl::worker_pool::~worker_pool() {
+	{
+		std::lock_guard<std::mutex> lock(pimpl->mtx);
+		pimpl->stopping = true;
+	}
+	pimpl->work_cv.notify_all();
+	for (auto& w : pimpl->workers) w.join();
+}
+
+std::size_t utl::worker_pool::worker_count() const noexcept {
+	return pimpl->workers.size();
+}
+
+void utl::worker_pool::run(std::size_t shares, const share_type& share) {
+	if (!shares) return;
+	auto l = std::make_shared<impl::loop>(&share, shares);
+	if (shares > 1U && !pimpl->workers.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(pimpl->mtx);
+			pimpl->loops.push_back(l);
+		}
+		if (shares - 1U >= pimpl->workers.size()) pimpl->work_cv.notify_all();
+		else for (std::size_t i = 1U; i < shares; ++i) pimpl->work_cv.notify_one();
+	}
+	pimpl->take_part(*l);
+	std::unique_lock<std::mutex> lock(pimpl->mtx);
+	pimpl->finished_cv.wait(lock, [&l]() { return l->finished; });
+	auto it = std::find(pimpl->loops.begin(), pimpl->loops.end(), l);
+	if (it != pimpl->loops.end()) pimpl->loops.erase(it);
+	if (l->error) std::rethrow_exception(l->error);
+}
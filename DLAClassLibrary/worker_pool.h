@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace utl {
+	/**
+	 * \class worker_pool
+	 *
+	 * \brief Persistent pool of worker threads sharing the fine-grained parallel loops of the engines,
+	 *        such as the relaxation sweeps of DBM and the slab phases of DLA_finite_density and
+	 *        DLA_decomposed, such that no thread is created per sweep.
+	 *
+	 * A loop is split into a fixed number of shares which the calling thread and any idle workers
+	 * claim in turn, so the work done by each share (and hence any result which depends on it) is
+	 * independent of how many workers are available and of other loops run concurrently. Shares must
+	 * be safe to run concurrently and must not wait upon one another.
+	 *
+	 * The thread machinery is hidden behind a pointer to implementation, as for observer_dispatcher.
+	 */
+	class worker_pool {
+	public:
+		typedef std::function<void(std::size_t)> share_type;
+		/**
+		 * \brief Gets the pool shared by all engines, started upon first use with one worker fewer
+		 *        than the hardware concurrency as the calling thread takes part in every loop.
+		 */
+		static worker_pool& shared();
+		/**
+		 * \brief Starts the worker threads.
+		 *
+		 * \param _workers Number of worker threads, excluding the calling thread of each loop.
+		 */
+		explicit worker_pool(std::size_t _workers);
+		worker_pool(const worker_pool&) = delete;
+		worker_pool& operator=(const worker_pool&) = delete;
+		/**
+		 * \brief Joins the worker threads, which must not be running a loop.
+		 */
+		~worker_pool();
+		/**
+		 * \brief Gets the number of worker threads, excluding the calling thread of each loop.
+		 */
+		std::size_t worker_count() const noexcept;
+		/**
+		 * \brief Calls `share(s)` for every s of [0, shares), blocking until all have returned.
+		 *
+		 * If a share throws, the first exception is rethrown once all shares have finished.
+		 *
+		 * \param shares Number of shares.
+		 * \param share Function to call for each share.
+		 */
+		void run(std::size_t shares, const share_type& share);
+	private:
+		struct impl;
+		std::unique_ptr<impl> pimpl;
+	};
+
+	/**
+	 * \brief Calls `f(k)` for every k of [0, count), split into up to `threads` strided shares run on
+	 *        the shared worker pool.
+	 *
+	 * \param count Number of items.
+	 * \param threads Maximum number of shares, each being run on one thread.
+	 * \param f Function of item index.
+	 */
+	template<class Function>
+	void parallel_for(std::size_t count, std::size_t threads, Function f) {
+		const std::size_t shares = (threads < count) ? threads : count;
+		if (shares <= 1U) {
+			for (std::size_t k = 0U; k < count; ++k) f(k);
+			return;
+		}
+		worker_pool::shared().run(shares, [&f, shares, count](std::size_t s) {
+			for (std::size_t k = s; k < count; k += shares) f(k);
+		});
+	}
+
+	/**
+	 * \brief Calls `f(chunk, first, last)` for `chunks` contiguous ranges [first, last) splitting
+	 *        [0, count) evenly, run on the shared worker pool.
+	 *
+	 * \param count Number of items.
+	 * \param chunks Number of ranges, each being run on one thread.
+	 * \param f Function of chunk index and range of items.
+	 */
+	template<class Function>
+	void parallel_for_chunks(std::size_t count, std::size_t chunks, Function f) {
+		if (chunks <= 1U) {
+			f(std::size_t(0U), std::size_t(0U), count);
+			return;
+		}
+		worker_pool::shared().run(chunks, [&f, chunks, count](std::size_t c) {
+			f(c, count*c / chunks, count*(c + 1U) / chunks);
+		});
+	}
+}
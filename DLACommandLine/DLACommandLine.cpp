@@ -0,0 +1,372 @@
+// DLACommandLine.cpp : headless native driver for generating aggregates in batch, either a single
+// run or a full parameter grid scheduled across threads, writing per-run summaries with timing and
+// memory statistics.
+
+#include "Stdafx.h"
+#include "DLA_2d.h"
+#include "DLA_3d.h"
+#include "DLA_off_lattice.h"
+#include "sweep_scheduler.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+	/**
+	 * \struct run_config
+	 *
+	 * \brief Parameters of a single aggregate generation within a sweep.
+	 */
+	struct run_config {
+		unsigned dimension;
+		lattice_type lattice;
+		bool off_lattice;
+		attractor_type attractor;
+		std::size_t attractor_size;
+		std::size_t n;
+		double coeff_stick;
+		std::pair<bool, bool> spawn;
+		std::uint64_t seed;
+		std::uint64_t stream;
+		std::size_t replica;
+	};
+	/**
+	 * \struct run_result
+	 *
+	 * \brief Summary statistics of a completed generation.
+	 */
+	struct run_result {
+		std::size_t size;
+		std::size_t misses;
+		std::size_t span;
+		double fractal_dimension;
+		double seconds;
+		std::size_t process_peak_memory_kb;	// of the whole process so far, not of this run alone
+	};
+
+	const char* usage =
+		"usage: DLACommandLine [options]\n"
+		"options taking a value accept a comma separated list, runs are generated for every combination:\n"
+		"  --dim 2|3|4|5                     dimension of lattice, above 3 square lattice and point attractor only [2]\n"
+		"  --lattice square|triangle|hexagonal|fcc|bcc|off\n"
+		"                                    type of lattice, hexagonal 2D only, fcc and bcc 3D only,\n"
+		"                                    off for continuous space in 2D and 3D [square]\n"
+		"  --attractor point|line|plane|circle\n"
+		"                                    type of attractor [point]\n"
+		"  --attractor-size N                size of attractor [1]\n"
+		"  --size N                          number of particles to generate [1000]\n"
+		"  --coeff-stick X                   coefficient of stickiness in (0,1] [1.0]\n"
+		"  --spawn above|below|both          spawn source of random walkers [both]\n"
+		"  --seed S                          single seed of all runs, each run drawing an independent stream [random]\n"
+		"  --replicas R                      number of replicas of each combination [1]\n"
+		"  --format txt|none                 aggregate output format [none]\n"
+		"  --output PREFIX                   prefix of aggregate output files [aggregate]\n"
+		"  --growth-series PREFIX            record log-spaced growth samples to PREFIX_<run>.tsv [off]\n"
+		"  --summary PATH                    summary output file [stdout]\n"
+		"  --cache DIR                       serve repeated seeded runs from an aggregate cache in DIR [off]\n"
+		"  --cache-size MB                   maximum size of aggregate cache [1024]\n"
+		"  --threads T                       number of runs generated concurrently, 0 for all cores [1]\n"
+		"  --resume                          skip runs already in the summary file, appending the rest\n"
+		"                                    (requires --summary, reusing the seed recorded in it unless --seed is given)\n"
+		"process_peak_memory_kb is the peak of the whole process so far, not of the run, so is shared by concurrent runs.\n";
+
+	const char* summary_header = "run\tdim\tlattice\tattractor\tattractor_size\tn\tcoeff_stick\tspawn\tseed\tstream\treplica"
+		"\tsize\tmisses\tspan\tfractal_dimension\tseconds\tprocess_peak_memory_kb";
+	// number of leading summary columns describing the run configuration, and column of the seed
+	const std::size_t config_columns = 11U;
+	const std::size_t seed_column = 8U;
+
+	std::vector<std::string> split(const std::string& s, char delim) {
+		std::vector<std::string> tokens;
+		std::istringstream iss(s);
+		std::string token;
+		while (std::getline(iss, token, delim)) if (!token.empty()) tokens.push_back(token);
+		return tokens;
+	}
+
+	lattice_type parse_lattice(const std::string& s) {
+		if (s == "square") return lattice_type::SQUARE;
+		if (s == "triangle") return lattice_type::TRIANGLE;
+		if (s == "hexagonal") return lattice_type::HEXAGONAL;
+		if (s == "fcc") return lattice_type::FCC;
+		if (s == "bcc") return lattice_type::BCC;
+		throw std::invalid_argument("unknown lattice type: " + s);
+	}
+
+	attractor_type parse_attractor(const std::string& s) {
+		if (s == "point") return attractor_type::POINT;
+		if (s == "line") return attractor_type::LINE;
+		if (s == "plane") return attractor_type::PLANE;
+		if (s == "circle") return attractor_type::CIRCLE;
+		throw std::invalid_argument("unknown attractor type: " + s);
+	}
+
+	std::pair<bool, bool> parse_spawn(const std::string& s) {
+		if (s == "above") return { true, false };
+		if (s == "below") return { false, true };
+		if (s == "both") return { true, true };
+		throw std::invalid_argument("unknown spawn source: " + s);
+	}
+
+	const char* lattice_name(lattice_type ltt) {
+		switch (ltt) {
+		case lattice_type::SQUARE: return "square";
+		case lattice_type::TRIANGLE: return "triangle";
+		case lattice_type::HEXAGONAL: return "hexagonal";
+		case lattice_type::FCC: return "fcc";
+		case lattice_type::BCC: return "bcc";
+		}
+		return "unknown";
+	}
+
+	const char* attractor_name(attractor_type att) {
+		switch (att) {
+		case attractor_type::POINT: return "point";
+		case attractor_type::LINE: return "line";
+		case attractor_type::PLANE: return "plane";
+		case attractor_type::CIRCLE: return "circle";
+		}
+		return "unknown";
+	}
+
+	const char* spawn_name(const std::pair<bool, bool>& spawn) {
+		return (spawn.first && spawn.second) ? "both" : (spawn.first ? "above" : "below");
+	}
+
+	// peak resident memory of the process so far, in kilobytes
+	std::size_t peak_memory_kb() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS pmc;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0U;
+		return static_cast<std::size_t>(pmc.PeakWorkingSetSize / 1024U);
+#else
+		rusage usage_stats;
+		if (getrusage(RUSAGE_SELF, &usage_stats)) return 0U;
+		return static_cast<std::size_t>(usage_stats.ru_maxrss);
+#endif
+	}
+
+	// expands the parsed options into the full grid of runs
+	std::vector<run_config> expand_grid(const std::map<std::string, std::vector<std::string>>& opts) {
+		auto values = [&opts](const std::string& key, const std::string& def) {
+			auto it = opts.find(key);
+			return (it == opts.end()) ? std::vector<std::string>{ def } : it->second;
+		};
+		const std::size_t replicas = std::stoul(values("replicas", "1").front());
+		const bool seeded = opts.count("seed") != 0U;
+		// every run shares one seed, a list of seeds would silently run the first only
+		if (seeded && opts.at("seed").size() != 1U) throw std::invalid_argument("--seed takes a single value.");
+		const std::uint64_t seed = seeded ? std::stoull(opts.at("seed").front()) : utl::random_seed();
+		std::uint64_t stream = 0U;
+		std::vector<run_config> grid;
+		for (const auto& dim : values("dim", "2"))
+			for (const auto& ltt : values("lattice", "square"))
+				for (const auto& att : values("attractor", "point"))
+					for (const auto& att_size : values("attractor-size", "1"))
+						for (const auto& n : values("size", "1000"))
+							for (const auto& coeff : values("coeff-stick", "1.0"))
+								for (const auto& spawn : values("spawn", "both"))
+									for (std::size_t r = 0U; r < replicas; ++r) {
+										const bool off_lattice = ltt == "off";
+										run_config config{ static_cast<unsigned>(std::stoul(dim)), parse_lattice(off_lattice ? "square" : ltt),
+											off_lattice, parse_attractor(att), std::stoul(att_size), std::stoul(n), std::stod(coeff), parse_spawn(spawn),
+											seed, stream++, r };
+										if (config.dimension < 2U || config.dimension > utl::max_lattice_dimension)
+											throw std::invalid_argument("dimension must be from 2 to 5.");
+										if (config.dimension == 2U && config.attractor == attractor_type::PLANE)
+											throw std::invalid_argument("Cannot set attractor type of 2D DLA to PLANE.");
+										if (config.dimension > 3U && config.attractor != attractor_type::POINT)
+											throw std::invalid_argument("attractor type of DLA above 3D must be POINT.");
+										if (off_lattice && config.dimension > 3U)
+											throw std::invalid_argument("dimension of off-lattice DLA must be 2 or 3.");
+										utl::describe_lattice(config.lattice, config.dimension);	// throws if undefined in dimension
+										grid.push_back(config);
+									}
+		return grid;
+	}
+
+	// estimated relative cost of a run, walk length scales as N*R^2 with R ~ N^(1/d_f)
+	double estimated_cost(const run_config& config) {
+		static const double fractal_dimensions[] = { 1.71, 2.5, 3.4, 4.3 };
+		const double fractal_dimension = fractal_dimensions[config.dimension - 2U];
+		return std::pow(static_cast<double>(config.n), 1.0 + 2.0/fractal_dimension) / config.coeff_stick;
+	}
+
+	// configuration columns of a summary row, excluding the run index, with coeff_stick written at full
+	// precision such that resuming never matches a run of a nearby coefficient
+	std::string config_row(const run_config& config) {
+		std::ostringstream oss;
+		oss << config.dimension << '\t' << (config.off_lattice ? "off" : lattice_name(config.lattice)) << '\t' << attractor_name(config.attractor) << '\t'
+			<< config.attractor_size << '\t' << config.n << '\t' << std::setprecision(std::numeric_limits<double>::max_digits10)
+			<< config.coeff_stick << '\t' << spawn_name(config.spawn) << '\t'
+			<< config.seed << '\t' << config.stream << '\t' << config.replica;
+		return oss.str();
+	}
+
+	// reads the complete rows of an existing summary file, checking each against the sweep grid
+	std::vector<std::string> finished_rows(const std::string& path, const std::vector<run_config>& grid, std::set<std::size_t>& finished) {
+		std::vector<std::string> rows;
+		std::ifstream ifs(path);
+		if (!ifs) return rows;
+		std::string line;
+		if (!std::getline(ifs, line)) return rows;
+		if (line != summary_header) throw std::invalid_argument("summary file " + path + " is not a sweep summary.");
+		const std::size_t columns = split(summary_header, '\t').size();
+		while (std::getline(ifs, line)) {
+			if (ifs.eof()) break;	// final line without newline, interrupted mid-write
+			const std::vector<std::string> fields = split(line, '\t');
+			if (fields.size() != columns) continue;
+			const std::size_t index = std::stoul(fields[0]);
+			if (index >= grid.size()) throw std::invalid_argument("summary file " + path + " does not match sweep.");
+			std::string config;
+			for (std::size_t c = 1U; c < config_columns; ++c) config += (c > 1U ? "\t" : "") + fields[c];
+			if (config != config_row(grid[index])) throw std::invalid_argument("summary file " + path + " does not match sweep.");
+			if (finished.insert(index).second) rows.push_back(line);
+		}
+		return rows;
+	}
+
+	// reads the seed recorded in the first complete row of an existing summary file, if any
+	bool recorded_seed(const std::string& path, std::uint64_t& seed) {
+		std::ifstream ifs(path);
+		std::string line;
+		if (!ifs || !std::getline(ifs, line) || line != summary_header) return false;
+		const std::size_t columns = split(summary_header, '\t').size();
+		while (std::getline(ifs, line)) {
+			if (ifs.eof()) break;	// final line without newline, interrupted mid-write
+			const std::vector<std::string> fields = split(line, '\t');
+			if (fields.size() != columns) continue;
+			seed = std::stoull(fields[seed_column]);
+			return true;
+		}
+		return false;
+	}
+
+	run_result run(const run_config& config, std::size_t index, const std::string& format, const std::string& prefix,
+		const std::string& growth_prefix, const std::shared_ptr<utl::aggregate_cache>& cache) {
+		std::unique_ptr<DLAContainer> dla;
+		switch (config.dimension) {
+		case 2U:
+			if (config.off_lattice) dla = std::make_unique<DLA_off_lattice_2d>(config.attractor, config.attractor_size, config.coeff_stick);
+			else dla = std::make_unique<DLA_2d>(config.lattice, config.attractor, config.attractor_size, config.coeff_stick);
+			break;
+		case 3U:
+			if (config.off_lattice) dla = std::make_unique<DLA_off_lattice_3d>(config.attractor, config.attractor_size, config.coeff_stick);
+			else dla = std::make_unique<DLA_3d>(config.lattice, config.attractor, config.attractor_size, config.coeff_stick);
+			break;
+		case 4U:
+			dla = std::make_unique<DLA<4U>>(config.lattice, config.attractor, config.attractor_size, config.coeff_stick);
+			break;
+		default:
+			dla = std::make_unique<DLA<5U>>(config.lattice, config.attractor, config.attractor_size, config.coeff_stick);
+			break;
+		}
+		dla->set_aggregate_cache(cache);
+		dla->seed_generator(config.seed, config.stream);
+		dla->set_random_walk_particle_spawn_source(config.spawn);
+		if (!growth_prefix.empty()) dla->set_growth_recording(true);
+		const auto start = std::chrono::steady_clock::now();
+		dla->generate(config.n);
+		const auto finish = std::chrono::steady_clock::now();
+		run_result result{ dla->size(), dla->aggregate_misses(), dla->aggregate_spanning_distance(),
+			dla->estimate_fractal_dimension(), std::chrono::duration<double>(finish - start).count(), peak_memory_kb() };
+		if (format == "txt") {
+			std::ofstream ofs(prefix + "_" + std::to_string(index) + ".txt");
+			if (!ofs) throw std::runtime_error("unable to open aggregate output file.");
+			dla->write(ofs, true);
+		}
+		if (!growth_prefix.empty()) {
+			std::ofstream ofs(growth_prefix + "_" + std::to_string(index) + ".tsv");
+			if (!ofs) throw std::runtime_error("unable to open growth series output file.");
+			dla->write_growth_series(ofs);
+		}
+		return result;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	try {
+		std::map<std::string, std::vector<std::string>> opts;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (arg == "--help" || arg == "-h") {
+				std::cout << usage;
+				return 0;
+			}
+			if (arg == "--resume") {
+				opts["resume"];
+				continue;
+			}
+			if (arg.compare(0, 2, "--") || i + 1 >= argc) throw std::invalid_argument("invalid argument: " + arg);
+			opts[arg.substr(2)] = split(argv[++i], ',');
+		}
+		const std::string format = opts.count("format") ? opts["format"].front() : "none";
+		if (format != "txt" && format != "none") throw std::invalid_argument("unknown output format: " + format);
+		const std::string prefix = opts.count("output") ? opts["output"].front() : "aggregate";
+		const std::string growth_prefix = opts.count("growth-series") ? opts["growth-series"].front() : "";
+		const bool resume = opts.count("resume") != 0U;
+		if (resume && !opts.count("summary")) throw std::invalid_argument("--resume requires --summary.");
+		// a sweep seeded at random is resumed with the seed recorded in its summary
+		std::uint64_t seed;
+		if (resume && !opts.count("seed") && recorded_seed(opts["summary"].front(), seed)) opts["seed"] = { std::to_string(seed) };
+		const std::vector<run_config> grid = expand_grid(opts);
+		std::shared_ptr<utl::aggregate_cache> cache;
+		if (opts.count("cache")) {
+			const std::uint64_t cache_mb = opts.count("cache-size") ? std::stoull(opts["cache-size"].front()) : 1024U;
+			cache = std::make_shared<utl::aggregate_cache>(opts["cache"].front(), cache_mb << 20);
+		}
+		const std::size_t threads = opts.count("threads") ? std::stoul(opts["threads"].front()) : 1U;
+		std::set<std::size_t> finished;
+		std::vector<std::string> rows;
+		if (resume) rows = finished_rows(opts["summary"].front(), grid, finished);
+		std::ofstream summary_file;
+		if (opts.count("summary")) {
+			// rewritten from its complete rows when resuming, dropping any row interrupted mid-write
+			summary_file.open(opts["summary"].front());
+			if (!summary_file) throw std::runtime_error("unable to open summary file.");
+		}
+		std::ostream& summary = summary_file.is_open() ? summary_file : std::cout;
+		summary << summary_header << '\n';
+		for (const auto& row : rows) summary << row << '\n';
+		summary.flush();
+		std::mutex summary_mtx;
+		utl::sweep_scheduler scheduler(threads);
+		for (std::size_t i = 0U; i < grid.size(); ++i) {
+			if (finished.count(i)) continue;
+			scheduler.submit(estimated_cost(grid[i]), [&, i]() {
+				const run_config& config = grid[i];
+				const run_result result = run(config, i, format, prefix, growth_prefix, cache);
+				std::lock_guard<std::mutex> lock(summary_mtx);
+				summary << i << '\t' << config_row(config) << '\t'
+					<< result.size << '\t' << result.misses << '\t' << result.span << '\t' << result.fractal_dimension << '\t'
+					<< result.seconds << '\t' << result.process_peak_memory_kb << std::endl;
+			});
+		}
+		scheduler.run();
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "error: " << ex.what() << '\n' << usage;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
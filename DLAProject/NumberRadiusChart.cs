@@ -138,6 +138,15 @@ namespace DLAProject {
                 case ManagedLatticeType.Triangle:
                     title += "T";
                     break;
+                case ManagedLatticeType.Hexagonal:
+                    title += "H";
+                    break;
+                case ManagedLatticeType.Fcc:
+                    title += "F";
+                    break;
+                case ManagedLatticeType.Bcc:
+                    title += "B";
+                    break;
             }
             // reduce opacity of each previously plotted series
             foreach (LineSeries s in SeriesCollection) {